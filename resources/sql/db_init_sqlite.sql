@@ -6,7 +6,7 @@ CREATE TABLE IF NOT EXISTS Information (
   inf_value       TEXT        NOT NULL
 );
 -- !
-INSERT INTO Information VALUES (1, 'schema_version', '11');
+INSERT INTO Information VALUES (1, 'schema_version', '15');
 -- !
 CREATE TABLE IF NOT EXISTS Accounts (
   id              INTEGER     PRIMARY KEY,
@@ -117,6 +117,50 @@ CREATE TABLE IF NOT EXISTS Messages (
   account_id      INTEGER     NOT NULL,
   custom_id       TEXT,
   custom_hash     TEXT,
+  images          TEXT,
+  preview         TEXT,
+  word_count      INTEGER,
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
-);
\ No newline at end of file
+);
+-- !
+CREATE TABLE IF NOT EXISTS EnclosurePolicies (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  feed            TEXT        NOT NULL,
+  mime_types      TEXT,
+  max_size        INTEGER     NOT NULL DEFAULT 0 CHECK (max_size >= 0),
+  keep_last       INTEGER     NOT NULL DEFAULT 0 CHECK (keep_last >= 0),
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE TABLE IF NOT EXISTS EnclosureFiles (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  feed            TEXT        NOT NULL,
+  url             TEXT        NOT NULL,
+  file_name       TEXT        NOT NULL,
+  state           INTEGER(1)  NOT NULL DEFAULT 0 CHECK (state >= 0 AND state <= 3),
+  date_created    INTEGER     NOT NULL,
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE TABLE IF NOT EXISTS MessageStatesOutbox (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  custom_id       TEXT        NOT NULL,
+  field           INTEGER(1)  NOT NULL CHECK (field >= 0 AND field <= 1),
+  value           INTEGER(1)  NOT NULL CHECK (value >= 0 AND value <= 1),
+  feed            TEXT,
+  custom_hash     TEXT,
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE INDEX IF NOT EXISTS MessageStatesOutboxIndex ON MessageStatesOutbox (account_id, custom_id);
+-- !
+CREATE INDEX IF NOT EXISTS MessagesListIndex ON Messages (account_id, is_deleted, is_pdeleted, date_created);
+-- !
+CREATE INDEX IF NOT EXISTS MessagesFeedIndex ON Messages (account_id, feed, is_deleted, is_pdeleted, date_created);
\ No newline at end of file
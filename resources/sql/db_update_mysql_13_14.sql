@@ -0,0 +1,5 @@
+CREATE INDEX MessagesListIndex ON Messages (account_id, is_deleted, is_pdeleted, date_created);
+-- !
+CREATE INDEX MessagesFeedIndex ON Messages (account_id, feed(100), is_deleted, is_pdeleted, date_created);
+-- !
+UPDATE Information SET inf_value = '14' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,10 @@
+ALTER TABLE Messages
+ADD COLUMN images  TEXT;
+-- !
+ALTER TABLE Messages
+ADD COLUMN preview  TEXT;
+-- !
+ALTER TABLE Messages
+ADD COLUMN word_count  INTEGER;
+-- !
+UPDATE Information SET inf_value = '15' WHERE inf_key = 'schema_version';
\ No newline at end of file
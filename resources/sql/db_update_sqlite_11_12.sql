@@ -0,0 +1,24 @@
+CREATE TABLE IF NOT EXISTS EnclosurePolicies (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  feed            TEXT        NOT NULL,
+  mime_types      TEXT,
+  max_size        INTEGER     NOT NULL DEFAULT 0 CHECK (max_size >= 0),
+  keep_last       INTEGER     NOT NULL DEFAULT 0 CHECK (keep_last >= 0),
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE TABLE IF NOT EXISTS EnclosureFiles (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  feed            TEXT        NOT NULL,
+  url             TEXT        NOT NULL,
+  file_name       TEXT        NOT NULL,
+  state           INTEGER(1)  NOT NULL DEFAULT 0 CHECK (state >= 0 AND state <= 3),
+  date_created    INTEGER     NOT NULL,
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+UPDATE Information SET inf_value = '12' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,15 @@
+CREATE TABLE IF NOT EXISTS MessageStatesOutbox (
+  id              INTEGER     PRIMARY KEY,
+  account_id      INTEGER     NOT NULL,
+  custom_id       TEXT        NOT NULL,
+  field           INTEGER(1)  NOT NULL CHECK (field >= 0 AND field <= 1),
+  value           INTEGER(1)  NOT NULL CHECK (value >= 0 AND value <= 1),
+  feed            TEXT,
+  custom_hash     TEXT,
+  
+  FOREIGN KEY (account_id) REFERENCES Accounts (id)
+);
+-- !
+CREATE INDEX IF NOT EXISTS MessageStatesOutboxIndex ON MessageStatesOutbox (account_id, custom_id);
+-- !
+UPDATE Information SET inf_value = '13' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -201,7 +201,11 @@ RESOURCES += resources/sql.qrc \
 HEADERS +=  src/core/feeddownloader.h \
             src/core/feedsmodel.h \
             src/core/feedsproxymodel.h \
+            src/core/feedstextindex.h \
             src/core/message.h \
+            src/core/messagecontentprocessor.h \
+            src/core/messagecountsservice.h \
+            src/core/messagesloader.h \
             src/core/messagesmodel.h \
             src/core/messagesmodelcache.h \
             src/core/messagesmodelsqllayer.h \
@@ -278,6 +282,9 @@ HEADERS +=  src/core/feeddownloader.h \
             src/network-web/basenetworkaccessmanager.h \
             src/network-web/downloader.h \
             src/network-web/downloadmanager.h \
+            src/network-web/enclosureprefetcher.h \
+            src/network-web/imageprefetcher.h \
+            src/network-web/networkdiskcache.h \
             src/network-web/networkfactory.h \
             src/network-web/oauth2service.h \
             src/network-web/silentnetworkaccessmanager.h \
@@ -341,7 +348,11 @@ HEADERS +=  src/core/feeddownloader.h \
 SOURCES +=  src/core/feeddownloader.cpp \
             src/core/feedsmodel.cpp \
             src/core/feedsproxymodel.cpp \
+            src/core/feedstextindex.cpp \
             src/core/message.cpp \
+            src/core/messagecontentprocessor.cpp \
+            src/core/messagecountsservice.cpp \
+            src/core/messagesloader.cpp \
             src/core/messagesmodel.cpp \
             src/core/messagesmodelcache.cpp \
             src/core/messagesmodelsqllayer.cpp \
@@ -417,6 +428,9 @@ SOURCES +=  src/core/feeddownloader.cpp \
             src/network-web/basenetworkaccessmanager.cpp \
             src/network-web/downloader.cpp \
             src/network-web/downloadmanager.cpp \
+            src/network-web/enclosureprefetcher.cpp \
+            src/network-web/imageprefetcher.cpp \
+            src/network-web/networkdiskcache.cpp \
             src/network-web/networkfactory.cpp \
             src/network-web/oauth2service.cpp \
             src/network-web/silentnetworkaccessmanager.cpp \
@@ -533,8 +547,8 @@ equals(USE_WEBENGINE, true) {
                 src/network-web/adblock/adblockmanager.h \
                 src/network-web/adblock/adblockmatcher.h \
                 src/network-web/adblock/adblockrule.h \
-                src/network-web/adblock/adblocksearchtree.h \
                 src/network-web/adblock/adblocksubscription.h \
+                src/network-web/adblock/adblocktokenindex.h \
                 src/network-web/adblock/adblocktreewidget.h \
                 src/network-web/adblock/adblockurlinterceptor.h \
                 src/network-web/urlinterceptor.h \
@@ -548,8 +562,8 @@ equals(USE_WEBENGINE, true) {
                 src/network-web/adblock/adblockmanager.cpp \
                 src/network-web/adblock/adblockmatcher.cpp \
                 src/network-web/adblock/adblockrule.cpp \
-                src/network-web/adblock/adblocksearchtree.cpp \
                 src/network-web/adblock/adblocksubscription.cpp \
+                src/network-web/adblock/adblocktokenindex.cpp \
                 src/network-web/adblock/adblocktreewidget.cpp \
                 src/network-web/adblock/adblockurlinterceptor.cpp \
                 src/network-web/networkurlinterceptor.cpp \
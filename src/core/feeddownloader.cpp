@@ -3,6 +3,8 @@
 #include "core/feeddownloader.h"
 
 #include "definitions/definitions.h"
+#include "network-web/imageprefetcher.h"
+#include "network-web/silentnetworkaccessmanager.h"
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/feed.h"
 
@@ -17,9 +19,13 @@
 FeedDownloader::FeedDownloader(QObject* parent)
   : QObject(parent), m_feeds(QList<Feed*>()), m_mutex(new QMutex()), m_threadPool(new QThreadPool(this)),
   m_results(FeedDownloadResults()), m_feedsUpdated(0),
-  m_feedsUpdating(0), m_feedsOriginalCount(0) {
+  m_feedsUpdating(0), m_feedsOriginalCount(0), m_connectionsOpened(0), m_connectionsReused(0) {
   qRegisterMetaType<FeedDownloadResults>("FeedDownloadResults");
   m_threadPool->setMaxThreadCount(2);
+
+  // Keep worker threads (and their network managers with open
+  // connections) alive between updates.
+  m_threadPool->setExpiryTimeout(-1);
 }
 
 FeedDownloader::~FeedDownloader() {
@@ -39,7 +45,7 @@ void FeedDownloader::updateAvailableFeeds() {
 
     if (cache != nullptr) {
       qDebug("Saving cache for feed with DB ID %d and title '%s'.", feed->id(), qPrintable(feed->title()));
-      cache->saveAllCachedData(false);
+      cache->saveAllCachedData(true);
     }
   }
 
@@ -73,6 +79,8 @@ void FeedDownloader::updateFeeds(const QList<Feed*>& feeds) {
     m_feedsOriginalCount = m_feeds.size();
     m_results.clear();
     m_feedsUpdated = m_feedsUpdating = 0;
+    m_connectionsOpened = SilentNetworkAccessManager::openedConnections();
+    m_connectionsReused = SilentNetworkAccessManager::reusedConnections();
 
     // Job starts now.
     emit updateStarted();
@@ -109,6 +117,27 @@ void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool
 
   if (updated_messages > 0) {
     m_results.appendUpdatedFeed(QPair<QString, int>(feed->title(), updated_messages));
+
+    QList<QUrl> image_urls;
+    QList<Message> messages_with_enclosures;
+
+    foreach (const Message& message, messages) {
+      if (!message.m_isRead) {
+        image_urls.append(ImagePrefetcher::imageUrls(message));
+      }
+
+      if (!message.m_enclosures.isEmpty()) {
+        messages_with_enclosures.append(message);
+      }
+    }
+
+    if (!image_urls.isEmpty()) {
+      emit imagesFound(image_urls);
+    }
+
+    if (!messages_with_enclosures.isEmpty()) {
+      emit enclosuresFound(feed, messages_with_enclosures);
+    }
   }
 
   qDebug("Made progress in feed updates, total feeds count %d/%d (id of feed is %d).", m_feedsUpdated, m_feedsOriginalCount, feed->id());
@@ -121,6 +150,9 @@ void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool
 
 void FeedDownloader::finalizeUpdate() {
   qDebug().nospace() << "Finished feed updates in thread: \'" << QThread::currentThreadId() << "\'.";
+  qDebug("Feed updates opened %d new secure connections and reused %d.",
+         SilentNetworkAccessManager::openedConnections() - m_connectionsOpened,
+         SilentNetworkAccessManager::reusedConnections() - m_connectionsReused);
   m_results.sort();
 
   // Update of feeds has finished.
@@ -6,6 +6,7 @@
 #include <QObject>
 
 #include <QPair>
+#include <QUrl>
 
 #include "core/message.h"
 
@@ -75,6 +76,12 @@ class FeedDownloader : public QObject {
     // which were in the initial queue.
     void updateProgress(const Feed* feed, int current, int total);
 
+    // Emitted with images referenced by unread messages of updated feed.
+    void imagesFound(const QList<QUrl>& urls);
+
+    // Emitted with updated messages of the feed which have enclosures.
+    void enclosuresFound(Feed* feed, const QList<Message>& messages);
+
   private:
     void updateAvailableFeeds();
     void finalizeUpdate();
@@ -86,6 +93,10 @@ class FeedDownloader : public QObject {
     int m_feedsUpdated;
     int m_feedsUpdating;
     int m_feedsOriginalCount;
+
+    // Network connection counters at the start of the update.
+    int m_connectionsOpened;
+    int m_connectionsReused;
 };
 
 #endif // FEEDDOWNLOADER_H
@@ -2,6 +2,7 @@
 
 #include "core/feedsmodel.h"
 
+#include "core/messagecountsservice.h"
 #include "definitions/definitions.h"
 #include "gui/dialogs/formmain.h"
 #include "miscellaneous/databasefactory.h"
@@ -25,7 +26,8 @@
 
 #include <algorithm>
 
-FeedsModel::FeedsModel(QObject* parent) : QAbstractItemModel(parent), m_itemHeight(-1) {
+FeedsModel::FeedsModel(QObject* parent) : QAbstractItemModel(parent), m_itemHeight(-1),
+  m_messageCounts(new MessageCountsService(this)), m_changedItemsTimer(new QTimer(this)) {
   setObjectName(QSL("FeedsModel"));
 
   // Create root item.
@@ -46,6 +48,10 @@ FeedsModel::FeedsModel(QObject* parent) : QAbstractItemModel(parent), m_itemHeig
 
   setupFonts();
   updateItemHeight();
+
+  m_changedItemsTimer->setSingleShot(true);
+  m_changedItemsTimer->setInterval(RELOAD_MODEL_COALESCE_INTERVAL);
+  connect(m_changedItemsTimer, &QTimer::timeout, this, &FeedsModel::flushChangedItems);
 }
 
 FeedsModel::~FeedsModel() {
@@ -232,7 +238,7 @@ int FeedsModel::countOfUnreadMessages() const {
 }
 
 void FeedsModel::reloadCountsOfWholeModel() {
-  m_rootItem->updateCounts(true);
+  m_messageCounts->updateAllCounts();
   reloadWholeLayout();
   notifyWithCounts();
 }
@@ -246,6 +252,7 @@ void FeedsModel::removeItem(const QModelIndex& index) {
     beginRemoveRows(parent_index, index.row(), index.row());
     parent_item->removeChild(deleting_item);
     endRemoveRows();
+    m_textIndex.removeSubTree(deleting_item);
     deleting_item->deleteLater();
     notifyWithCounts();
   }
@@ -260,6 +267,7 @@ void FeedsModel::removeItem(RootItem* deleting_item) {
     beginRemoveRows(parent_index, index.row(), index.row());
     parent_item->removeChild(deleting_item);
     endRemoveRows();
+    m_textIndex.removeSubTree(deleting_item);
     deleting_item->deleteLater();
     notifyWithCounts();
   }
@@ -269,23 +277,33 @@ void FeedsModel::reassignNodeToNewParent(RootItem* original_node, RootItem* new_
   RootItem* original_parent = original_node->parent();
 
   if (original_parent != new_parent) {
-    if (original_parent != nullptr) {
-      int original_index_of_item = original_parent->childItems().indexOf(original_node);
-
-      if (original_index_of_item >= 0) {
-        // Remove the original item from the model...
-        beginRemoveRows(indexForItem(original_parent), original_index_of_item, original_index_of_item);
-        original_parent->removeChild(original_node);
-        endRemoveRows();
-      }
+    const int original_index_of_item = original_parent != nullptr ? original_parent->childItems().indexOf(original_node) : -1;
+    const int new_index_of_item = new_parent->childCount();
+
+    // Item is moved in one step if possible, so views keep
+    // its selection and expand states.
+    if (original_index_of_item >= 0 &&
+        beginMoveRows(indexForItem(original_parent), original_index_of_item, original_index_of_item,
+                      indexForItem(new_parent), new_index_of_item)) {
+      original_parent->removeChild(original_node);
+      new_parent->appendChild(original_node);
+      endMoveRows();
+      m_textIndex.addSubTree(original_node);
+      return;
     }
 
-    int new_index_of_item = new_parent->childCount();
+    if (original_index_of_item >= 0) {
+      // Remove the original item from the model...
+      beginRemoveRows(indexForItem(original_parent), original_index_of_item, original_index_of_item);
+      original_parent->removeChild(original_node);
+      endRemoveRows();
+    }
 
     // ... and insert it under the new parent.
-    beginInsertRows(indexForItem(new_parent), new_index_of_item, new_index_of_item);
+    beginInsertRows(indexForItem(new_parent), new_parent->childCount(), new_parent->childCount());
     new_parent->appendChild(original_node);
     endInsertRows();
+    m_textIndex.addSubTree(original_node);
   }
 }
 
@@ -402,28 +420,28 @@ QModelIndex FeedsModel::indexForItem(const RootItem* item) const {
   while (!chain.isEmpty()) {
     const RootItem* parent_item = chain.pop();
 
-    target_index = index(parent_item->parent()->childItems().indexOf(const_cast<RootItem* const>(parent_item)),
-                         0,
-                         target_index);
+    target_index = index(parent_item->row(), 0, target_index);
   }
 
   return target_index;
 }
 
 bool FeedsModel::hasAnyFeedNewMessages() const {
-  foreach (const Feed* feed, m_rootItem->getSubTreeFeeds()) {
-    if (feed->status() == Feed::NewMessages) {
-      return true;
-    }
-  }
-
-  return false;
+  return m_rootItem->hasNewMessages();
 }
 
 RootItem* FeedsModel::rootItem() const {
   return m_rootItem;
 }
 
+MessageCountsService* FeedsModel::messageCounts() const {
+  return m_messageCounts;
+}
+
+const FeedsTextIndex& FeedsModel::textIndex() const {
+  return m_textIndex;
+}
+
 void FeedsModel::reloadChangedLayout(QModelIndexList list) {
   while (!list.isEmpty()) {
     QModelIndex indx = list.takeFirst();
@@ -448,16 +466,70 @@ void FeedsModel::notifyWithCounts() {
 }
 
 void FeedsModel::onItemDataChanged(const QList<RootItem*>& items) {
-  if (items.size() > RELOAD_MODEL_BORDER_NUM) {
-    qDebug("There is request to reload feed model for more than %d items, reloading model fully.", RELOAD_MODEL_BORDER_NUM);
-    reloadWholeLayout();
+  foreach (RootItem* item, items) {
+    if (!m_changedItemsSet.contains(item)) {
+      m_changedItemsSet.insert(item);
+      m_changedItems.append(item);
+    }
   }
-  else {
-    qDebug("There is request to reload feed model, reloading the %d items individually.", items.size());
 
-    foreach (RootItem* item, items) {
-      reloadChangedItem(item);
+  if (!m_changedItemsTimer->isActive()) {
+    m_changedItemsTimer->start();
+  }
+}
+
+void FeedsModel::flushChangedItems() {
+  // Rows which need repaint, grouped by their parents. Parents of changed
+  // items are repainted too, because they display summed counts.
+  QHash<RootItem*, QPair<int, int>> changed_rows;
+  QSet<RootItem*> processed_items;
+
+  foreach (const QPointer<RootItem>& changed_item, m_changedItems) {
+    RootItem* item = changed_item.data();
+
+    if (item == nullptr) {
+      continue;
     }
+
+    // Skip items which were removed from the model meanwhile.
+    RootItem* top_item = item;
+
+    while (top_item->parent() != nullptr && top_item != m_rootItem) {
+      top_item = top_item->parent();
+    }
+
+    if (top_item != m_rootItem) {
+      continue;
+    }
+
+    // Title or URL of item could change.
+    m_textIndex.addItem(item);
+
+    for (; item != m_rootItem && !processed_items.contains(item); item = item->parent()) {
+      const int row = item->row();
+
+      processed_items.insert(item);
+
+      if (changed_rows.contains(item->parent())) {
+        QPair<int, int>& range = changed_rows[item->parent()];
+
+        range.first = qMin(range.first, row);
+        range.second = qMax(range.second, row);
+      }
+      else {
+        changed_rows.insert(item->parent(), qMakePair(row, row));
+      }
+    }
+  }
+
+  qDebug("Reloading %d changed items of feed model in %d groups of rows.", m_changedItems.size(), changed_rows.size());
+  m_changedItems.clear();
+  m_changedItemsSet.clear();
+
+  for (auto i = changed_rows.constBegin(); i != changed_rows.constEnd(); i++) {
+    const QModelIndex parent_index = indexForItem(i.key());
+
+    emit dataChanged(index(i.value().first, 0, parent_index), index(i.value().second, FDS_MODEL_COUNTS_INDEX, parent_index));
   }
 
   notifyWithCounts();
@@ -498,6 +570,7 @@ bool FeedsModel::addServiceAccount(ServiceRoot* root, bool freshly_activated) {
   connect(root, &ServiceRoot::itemExpandRequested, this, &FeedsModel::itemExpandRequested);
   connect(root, &ServiceRoot::itemExpandStateSaveRequested, this, &FeedsModel::itemExpandStateSaveRequested);
   root->start(freshly_activated);
+  m_textIndex.addSubTree(root);
 
   return true;
 }
@@ -5,13 +5,19 @@
 
 #include <QAbstractItemModel>
 
+#include "core/feedstextindex.h"
 #include "services/abstract/rootitem.h"
 
+#include <QPointer>
+#include <QSet>
+
 class Category;
 class Feed;
+class MessageCountsService;
 class ServiceRoot;
 class ServiceEntryPoint;
 class StandardServiceRoot;
+class QTimer;
 
 class FeedsModel : public QAbstractItemModel {
   Q_OBJECT
@@ -75,9 +81,7 @@ class FeedsModel : public QAbstractItemModel {
     RootItem* itemForIndex(const QModelIndex& index) const;
 
     // Returns source QModelIndex on which lies given item.
-    // NOTE: This goes through all available indexes and
-    // checks their bound items manually, there is no
-    // other way to to this.
+    // NOTE: This walks from the item up to the root.
     QModelIndex indexForItem(const RootItem* item) const;
 
     // Determines if any feed has any new messages.
@@ -86,6 +90,12 @@ class FeedsModel : public QAbstractItemModel {
     // Access to root item.
     RootItem* rootItem() const;
 
+    // Service which updates counts of messages of whole accounts.
+    MessageCountsService* messageCounts() const;
+
+    // Index of titles and URLs of items, used for searching and filtering.
+    const FeedsTextIndex& textIndex() const;
+
   public slots:
     void loadActivatedServiceAccounts();
 
@@ -132,7 +142,11 @@ class FeedsModel : public QAbstractItemModel {
     void notifyWithCounts();
 
   private slots:
+
+    // Changed items are collected and views are notified
+    // about all of them at once after short delay.
     void onItemDataChanged(const QList<RootItem*>& items);
+    void flushChangedItems();
 
   signals:
     void messageCountsChanged(int unread_messages, bool any_feed_has_unread_messages);
@@ -164,6 +178,12 @@ class FeedsModel : public QAbstractItemModel {
     QIcon m_countsIcon;
     QFont m_normalFont;
     QFont m_boldFont;
+
+    MessageCountsService* m_messageCounts;
+    FeedsTextIndex m_textIndex;
+    QTimer* m_changedItemsTimer;
+    QList<QPointer<RootItem>> m_changedItems;
+    QSet<RootItem*> m_changedItemsSet;
 };
 
 inline QVariant FeedsModel::data(const QModelIndex& index, int role) const {
@@ -11,7 +11,7 @@
 
 FeedsProxyModel::FeedsProxyModel(FeedsModel* source_model, QObject* parent)
   : QSortFilterProxyModel(parent), m_sourceModel(source_model), m_selectedItem(nullptr),
-  m_showUnreadOnly(false), m_hiddenIndices(QList<QPair<int, QModelIndex>>()) {
+  m_showUnreadOnly(false), m_hiddenIndices(QList<QPair<int, QModelIndex>>()), m_filterRevision(-1) {
   setObjectName(QSL("FeedsProxyModel"));
   setSortRole(Qt::EditRole);
   setSortCaseSensitivity(Qt::CaseInsensitive);
@@ -27,17 +27,29 @@ FeedsProxyModel::~FeedsProxyModel() {
 }
 
 QModelIndexList FeedsProxyModel::match(const QModelIndex& start, int role, const QVariant& value, int hits, Qt::MatchFlags flags) const {
+  Q_UNUSED(role)
+
+  // Matching items are looked up in the index just once, rows are
+  // then only checked against them.
+  const QSet<RootItem*> matching_items = m_sourceModel->textIndex().find(value.toString(), flags & 0x0F, false);
+
+  return matchItems(start, hits, flags, matching_items);
+}
+
+QModelIndexList FeedsProxyModel::matchItems(const QModelIndex& start, int hits, Qt::MatchFlags flags,
+                                            const QSet<RootItem*>& matching_items) const {
   QModelIndexList result;
-  const uint match_type = flags & 0x0F;
-  const Qt::CaseSensitivity cs = Qt::CaseInsensitive;
   const bool recurse = flags & Qt::MatchRecursive;
   const bool wrap = flags & Qt::MatchWrap;
   const bool all_hits = (hits == -1);
-  QString entered_text;
   const QModelIndex p = parent(start);
   int from = start.row();
   int to = rowCount(p);
 
+  if (matching_items.isEmpty()) {
+    return result;
+  }
+
   for (int i = 0; (wrap && i < 2) || (!wrap && i < 1); ++i) {
     for (int r = from; (r < to) && (all_hits || result.count() < hits); ++r) {
       QModelIndex idx = index(r, start.column(), p);
@@ -46,74 +58,12 @@ QModelIndexList FeedsProxyModel::match(const QModelIndex& start, int role, const
         continue;
       }
 
-      QModelIndex mapped_idx = mapToSource(idx);
-      QVariant item_value = m_sourceModel->itemForIndex(mapped_idx)->title();
-
-      // QVariant based matching.
-      if (match_type == Qt::MatchExactly) {
-        if (value == item_value) {
-          result.append(idx);
-        }
-      }
-
-      // QString based matching.
-      else {
-        if (entered_text.isEmpty()) {
-          entered_text = value.toString();
-        }
-
-        QString item_text = item_value.toString();
-
-        switch (match_type) {
-          case Qt::MatchRegExp:
-            if (QRegExp(entered_text, cs).exactMatch(item_text)) {
-              result.append(idx);
-            }
-
-            break;
-
-          case Qt::MatchWildcard:
-            if (QRegExp(entered_text, cs, QRegExp::Wildcard).exactMatch(item_text)) {
-              result.append(idx);
-            }
-
-            break;
-
-          case Qt::MatchStartsWith:
-            if (item_text.startsWith(entered_text, cs)) {
-              result.append(idx);
-            }
-
-            break;
-
-          case Qt::MatchEndsWith:
-            if (item_text.endsWith(entered_text, cs)) {
-              result.append(idx);
-            }
-
-            break;
-
-          case Qt::MatchFixedString:
-            if (item_text.compare(entered_text, cs) == 0) {
-              result.append(idx);
-            }
-
-            break;
-
-          case Qt::MatchContains:
-          default:
-            if (item_text.contains(entered_text, cs)) {
-              result.append(idx);
-            }
-
-            break;
-        }
+      if (matching_items.contains(m_sourceModel->itemForIndex(mapToSource(idx)))) {
+        result.append(idx);
       }
 
       if (recurse && hasChildren(idx)) {
-        result +=
-          match(index(0, idx.column(), idx), role, (entered_text.isEmpty() ? value : entered_text), (all_hits ? -1 : hits - result.count()),
-                flags);
+        result += matchItems(index(0, idx.column(), idx), (all_hits ? -1 : hits - result.count()), flags, matching_items);
       }
     }
 
@@ -196,10 +146,6 @@ bool FeedsProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source
 }
 
 bool FeedsProxyModel::filterAcceptsRowInternal(int source_row, const QModelIndex& source_parent) const {
-  if (!m_showUnreadOnly) {
-    return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
-  }
-
   const QModelIndex idx = m_sourceModel->index(source_row, 0, source_parent);
 
   if (!idx.isValid()) {
@@ -208,7 +154,13 @@ bool FeedsProxyModel::filterAcceptsRowInternal(int source_row, const QModelIndex
 
   const RootItem* item = m_sourceModel->itemForIndex(idx);
 
-  if (item->kind() == RootItemKind::Bin || item->kind() == RootItemKind::ServiceRoot) {
+  if (!filterAcceptsItemText(item)) {
+    return false;
+  }
+  else if (!m_showUnreadOnly) {
+    return true;
+  }
+  else if (item->kind() == RootItemKind::Bin || item->kind() == RootItemKind::ServiceRoot) {
     // Recycle bin is always displayed.
     return true;
   }
@@ -223,6 +175,39 @@ bool FeedsProxyModel::filterAcceptsRowInternal(int source_row, const QModelIndex
   }
 }
 
+bool FeedsProxyModel::filterAcceptsItemText(const RootItem* item) const {
+  const QRegExp regexp = filterRegExp();
+
+  if (regexp.isEmpty()) {
+    return true;
+  }
+
+  const FeedsTextIndex& text_index = m_sourceModel->textIndex();
+  const QString filter_key = QString::number(regexp.patternSyntax()) + QL1C('-') +
+                             QString::number(regexp.caseSensitivity()) + QL1C('-') + regexp.pattern();
+
+  if (filter_key != m_filterKey || text_index.revision() != m_filterRevision) {
+    // Parents of matching items must be displayed so that items are reachable,
+    // children of matching categories are displayed too.
+    m_filterItems.clear();
+
+    foreach (RootItem* matching_item, text_index.find(regexp, true)) {
+      foreach (const RootItem* child, matching_item->getSubTree()) {
+        m_filterItems.insert(child);
+      }
+
+      for (const RootItem* parent = matching_item->parent(); parent != nullptr; parent = parent->parent()) {
+        m_filterItems.insert(parent);
+      }
+    }
+
+    m_filterKey = filter_key;
+    m_filterRevision = text_index.revision();
+  }
+
+  return m_filterItems.contains(item);
+}
+
 const RootItem* FeedsProxyModel::selectedItem() const {
   return m_selectedItem;
 }
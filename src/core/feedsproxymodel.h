@@ -5,6 +5,8 @@
 
 #include <QSortFilterProxyModel>
 
+#include <QSet>
+
 class FeedsModel;
 class RootItem;
 
@@ -46,6 +48,9 @@ class FeedsProxyModel : public QSortFilterProxyModel {
     bool lessThan(const QModelIndex& left, const QModelIndex& right) const;
     bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const;
     bool filterAcceptsRowInternal(int source_row, const QModelIndex& source_parent) const;
+    bool filterAcceptsItemText(const RootItem* item) const;
+    QModelIndexList matchItems(const QModelIndex& start, int hits, Qt::MatchFlags flags,
+                               const QSet<RootItem*>& matching_items) const;
 
     // Source model pointer.
     FeedsModel* m_sourceModel;
@@ -53,6 +58,12 @@ class FeedsProxyModel : public QSortFilterProxyModel {
     bool m_showUnreadOnly;
 
     QList<QPair<int, QModelIndex>> m_hiddenIndices;
+
+    // Items accepted by text filter with their parents and children. They are
+    // obtained from text index once for each filter and revision of index.
+    mutable QSet<const RootItem*> m_filterItems;
+    mutable QString m_filterKey;
+    mutable int m_filterRevision;
 };
 
 #endif // FEEDSPROXYMODEL_H
@@ -0,0 +1,215 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/feedstextindex.h"
+
+#include "services/abstract/feed.h"
+#include "services/abstract/rootitem.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+FeedsTextIndex::FeedsTextIndex() : m_revision(0) {}
+
+void FeedsTextIndex::addItem(RootItem* item) {
+  if (item->kind() != RootItemKind::Feed && item->kind() != RootItemKind::Category &&
+      item->kind() != RootItemKind::ServiceRoot) {
+    return;
+  }
+
+  const QString title = item->title();
+  const QString url = item->kind() == RootItemKind::Feed ? item->toFeed()->url() : QString();
+  auto existing = m_entries.constFind(item);
+
+  if (existing != m_entries.constEnd() && existing.value().m_item == item &&
+      existing.value().m_title == title && existing.value().m_url == url) {
+    // Nothing changed.
+    return;
+  }
+
+  removeItem(item);
+
+  Entry entry;
+
+  entry.m_item = item;
+  entry.m_title = title;
+  entry.m_url = url;
+  m_entries.insert(item, entry);
+
+  foreach (const QString& trigram, trigrams(title.toCaseFolded()) + trigrams(url.toCaseFolded())) {
+    m_trigrams[trigram].insert(item);
+  }
+
+  m_revision++;
+}
+
+void FeedsTextIndex::addSubTree(RootItem* root) {
+  foreach (RootItem* item, root->getSubTree()) {
+    addItem(item);
+  }
+}
+
+void FeedsTextIndex::removeSubTree(RootItem* root) {
+  foreach (RootItem* item, root->getSubTree()) {
+    removeItem(item);
+  }
+}
+
+QSet<RootItem*> FeedsTextIndex::find(const QString& text, int match_type, bool search_urls) const {
+  QSet<RootItem*> items;
+
+  if (match_type == Qt::MatchRegExp || match_type == Qt::MatchWildcard) {
+    // Expression is compiled once for all items.
+    const QRegExp regexp(text, Qt::CaseInsensitive, match_type == Qt::MatchWildcard ? QRegExp::Wildcard : QRegExp::RegExp);
+
+    foreach (const Entry& entry, m_entries) {
+      if (!entry.m_item.isNull() &&
+          (regexp.exactMatch(entry.m_title) || (search_urls && !entry.m_url.isEmpty() && regexp.exactMatch(entry.m_url)))) {
+        items.insert(entry.m_item.data());
+      }
+    }
+
+    return items;
+  }
+
+  const QString folded_text = text.toCaseFolded();
+
+  // All other types of matching need the text to be contained somewhere.
+  foreach (const Entry* entry, candidates(folded_text)) {
+    bool matches = false;
+
+    foreach (const QString& item_text, QStringList() << entry->m_title << (search_urls ? entry->m_url : QString())) {
+      switch (match_type) {
+        case Qt::MatchExactly:
+          matches |= item_text == text;
+          break;
+
+        case Qt::MatchStartsWith:
+          matches |= item_text.startsWith(text, Qt::CaseInsensitive);
+          break;
+
+        case Qt::MatchEndsWith:
+          matches |= item_text.endsWith(text, Qt::CaseInsensitive);
+          break;
+
+        case Qt::MatchFixedString:
+          matches |= item_text.compare(text, Qt::CaseInsensitive) == 0;
+          break;
+
+        case Qt::MatchContains:
+        default:
+          matches |= item_text.contains(text, Qt::CaseInsensitive);
+          break;
+      }
+    }
+
+    if (matches) {
+      items.insert(entry->m_item.data());
+    }
+  }
+
+  return items;
+}
+
+QSet<RootItem*> FeedsTextIndex::find(const QRegExp& regexp, bool search_urls) const {
+  if (regexp.patternSyntax() == QRegExp::FixedString && regexp.caseSensitivity() == Qt::CaseInsensitive) {
+    return find(regexp.pattern(), Qt::MatchContains, search_urls);
+  }
+
+  QSet<RootItem*> items;
+
+  foreach (const Entry& entry, m_entries) {
+    if (!entry.m_item.isNull() &&
+        (regexp.indexIn(entry.m_title) >= 0 || (search_urls && !entry.m_url.isEmpty() && regexp.indexIn(entry.m_url) >= 0))) {
+      items.insert(entry.m_item.data());
+    }
+  }
+
+  return items;
+}
+
+int FeedsTextIndex::revision() const {
+  return m_revision;
+}
+
+void FeedsTextIndex::removeItem(RootItem* item) {
+  auto existing = m_entries.find(item);
+
+  if (existing == m_entries.end()) {
+    return;
+  }
+
+  foreach (const QString& trigram, trigrams(existing.value().m_title.toCaseFolded()) +
+           trigrams(existing.value().m_url.toCaseFolded())) {
+    auto items = m_trigrams.find(trigram);
+
+    if (items != m_trigrams.end()) {
+      items.value().remove(item);
+
+      if (items.value().isEmpty()) {
+        m_trigrams.erase(items);
+      }
+    }
+  }
+
+  m_entries.erase(existing);
+  m_revision++;
+}
+
+QSet<QString> FeedsTextIndex::trigrams(const QString& text) const {
+  QSet<QString> result;
+
+  for (int i = 0; i + 3 <= text.size(); i++) {
+    result.insert(text.mid(i, 3));
+  }
+
+  return result;
+}
+
+QList<const FeedsTextIndex::Entry*> FeedsTextIndex::candidates(const QString& folded_text) const {
+  QList<const Entry*> result;
+
+  if (folded_text.size() < 3) {
+    // Text is too short for trigrams, all items are checked.
+    for (auto i = m_entries.constBegin(); i != m_entries.constEnd(); i++) {
+      if (!i.value().m_item.isNull()) {
+        result.append(&i.value());
+      }
+    }
+
+    return result;
+  }
+
+  // Start with the smallest set of items, so that intersection is cheap.
+  QList<const QSet<RootItem*>*> sets;
+
+  foreach (const QString& trigram, trigrams(folded_text)) {
+    auto items = m_trigrams.constFind(trigram);
+
+    if (items == m_trigrams.constEnd()) {
+      return result;
+    }
+
+    sets.append(&items.value());
+  }
+
+  std::sort(sets.begin(), sets.end(), [](const QSet<RootItem*>* lhs, const QSet<RootItem*>* rhs) {
+    return lhs->size() < rhs->size();
+  });
+
+  foreach (RootItem* item, *sets.first()) {
+    bool in_all_sets = true;
+
+    for (int i = 1; i < sets.size() && in_all_sets; i++) {
+      in_all_sets = sets.at(i)->contains(item);
+    }
+
+    auto entry = m_entries.constFind(item);
+
+    if (in_all_sets && entry != m_entries.constEnd() && !entry.value().m_item.isNull()) {
+      result.append(&entry.value());
+    }
+  }
+
+  return result;
+}
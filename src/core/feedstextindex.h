@@ -0,0 +1,55 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef FEEDSTEXTINDEX_H
+#define FEEDSTEXTINDEX_H
+
+#include <QHash>
+#include <QPointer>
+#include <QRegExp>
+#include <QSet>
+#include <QString>
+
+class RootItem;
+
+// Trigram index of titles and URLs of items of feeds model. Items whose
+// text contains given string are found by intersecting sets of items
+// containing its trigrams instead of comparing all items.
+class FeedsTextIndex {
+  public:
+    explicit FeedsTextIndex();
+
+    // Adds item or refreshes its indexed text after change.
+    void addItem(RootItem* item);
+    void addSubTree(RootItem* root);
+    void removeSubTree(RootItem* root);
+
+    // Returns items matching given text, "match_type" is one of Qt::MatchFlag
+    // values used by QAbstractItemModel::match(). Titles are always searched.
+    QSet<RootItem*> find(const QString& text, int match_type, bool search_urls) const;
+
+    // Returns items which contain match of given expression, like filters of
+    // QSortFilterProxyModel do.
+    QSet<RootItem*> find(const QRegExp& regexp, bool search_urls) const;
+
+    // Number increased with each change of indexed data.
+    int revision() const;
+
+  private:
+    struct Entry {
+      QPointer<RootItem> m_item;
+      QString m_title;
+      QString m_url;
+    };
+
+    void removeItem(RootItem* item);
+    QSet<QString> trigrams(const QString& text) const;
+
+    // Returns items which possibly contain given case-folded text.
+    QList<const Entry*> candidates(const QString& folded_text) const;
+
+    QHash<RootItem*, Entry> m_entries;
+    QHash<QString, QSet<RootItem*>> m_trigrams;
+    int m_revision;
+};
+
+#endif // FEEDSTEXTINDEX_H
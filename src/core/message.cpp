@@ -2,6 +2,7 @@
 
 #include "core/message.h"
 
+#include "core/messagecontentprocessor.h"
 #include "miscellaneous/textfactory.h"
 
 #include <QVariant>
@@ -50,12 +51,13 @@ QString Enclosures::encodeEnclosuresToString(const QList<Enclosure>& enclosures)
 Message::Message() {
   m_title = m_url = m_author = m_contents = m_feedId = m_customId = m_customHash = "";
   m_enclosures = QList<Enclosure>();
-  m_accountId = m_id = 0;
+  m_imageUrls = QStringList();
+  m_accountId = m_id = m_wordCount = 0;
   m_isRead = m_isImportant = false;
 }
 
 Message Message::fromSqlRecord(const QSqlRecord& record, bool* result) {
-  if (record.count() != MSG_DB_HAS_ENCLOSURES + 1) {
+  if (record.count() != MSG_DB_WORD_COUNT_INDEX + 1) {
     if (result != nullptr) {
       *result = false;
     }
@@ -79,6 +81,17 @@ Message Message::fromSqlRecord(const QSqlRecord& record, bool* result) {
   message.m_customId = record.value(MSG_DB_CUSTOM_ID_INDEX).toString();
   message.m_customHash = record.value(MSG_DB_CUSTOM_HASH_INDEX).toString();
 
+  if (record.isNull(MSG_DB_WORD_COUNT_INDEX)) {
+    // Message was stored by older version and its contents were not
+    // processed by background pass yet, see FeedReader.
+    MessageContentProcessor::processMessage(message);
+  }
+  else {
+    message.m_imageUrls = record.value(MSG_DB_IMAGES_INDEX).toString().split(MSG_IMAGES_SEPARATOR, QString::SkipEmptyParts);
+    message.m_preview = record.value(MSG_DB_PREVIEW_INDEX).toString();
+    message.m_wordCount = record.value(MSG_DB_WORD_COUNT_INDEX).toInt();
+  }
+
   if (result != nullptr) {
     *result = true;
   }
@@ -49,6 +49,11 @@ class Message {
 
     QList<Enclosure> m_enclosures;
 
+    // Data derived from contents when message is stored, see MessageContentProcessor.
+    QStringList m_imageUrls;
+    QString m_preview;
+    int m_wordCount;
+
     // Is true if "created" date was obtained directly
     // from the feed, otherwise is false
     bool m_createdFromFeed;
@@ -71,4 +76,6 @@ QDataStream& operator>>(QDataStream& in, Message& myObj);
 uint qHash(Message key, uint seed);
 uint qHash(const Message& key);
 
+Q_DECLARE_METATYPE(Message)
+
 #endif // MESSAGE_H
@@ -0,0 +1,392 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/messagecontentprocessor.h"
+
+#include "core/message.h"
+#include "definitions/definitions.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+// Collects plain-text preview and counts words of text parts of contents.
+struct PlainText {
+  PlainText() : m_words(0), m_inWord(false) {}
+
+  void append(QChar character) {
+    if (character.isSpace()) {
+      m_inWord = false;
+      return;
+    }
+
+    if (!m_inWord) {
+      m_inWord = true;
+      m_words++;
+
+      if (!m_preview.isEmpty() && m_preview.size() < MSG_PREVIEW_LENGTH) {
+        m_preview.append(QL1C(' '));
+      }
+    }
+
+    if (m_preview.size() < MSG_PREVIEW_LENGTH) {
+      m_preview.append(character);
+    }
+  }
+
+  void breakWord() {
+    m_inWord = false;
+  }
+
+  QString m_preview;
+  int m_words;
+  bool m_inWord;
+};
+
+static inline bool isTagNameCharacter(QChar character) {
+  return character.isLetterOrNumber() || character == QL1C('-') || character == QL1C(':') || character == QL1C('_');
+}
+
+static inline int skipWhiteSpace(const QString& input, int position) {
+  while (position < input.size() && input.at(position).isSpace()) {
+    position++;
+  }
+
+  return position;
+}
+
+// QStringRef::mid() is not available in Qt 5.7.
+static inline QStringRef subReference(const QStringRef& input, int position, int length) {
+  return QStringRef(input.string(), input.position() + position, length);
+}
+
+static inline bool isDigitOf(QChar character, bool hexadecimal) {
+  const QChar lower = character.toLower();
+
+  return character.isDigit() || (hexadecimal && lower >= QL1C('a') && lower <= QL1C('f'));
+}
+
+// Decodes character reference starting at given position and stores its length.
+// Returns zero if there is no valid reference. Like browsers do, numeric
+// references are accepted even without terminating semicolon.
+static uint decodeEntity(const QStringRef& input, int position, int* length) {
+  static const QHash<QString, uint> named_entities {
+    { QSL("amp"), 38 }, { QSL("lt"), 60 }, { QSL("gt"), 62 }, { QSL("quot"), 34 }, { QSL("apos"), 39 },
+    { QSL("nbsp"), 160 }, { QSL("ndash"), 8211 }, { QSL("mdash"), 8212 }, { QSL("lsquo"), 8216 },
+    { QSL("rsquo"), 8217 }, { QSL("ldquo"), 8220 }, { QSL("rdquo"), 8221 }, { QSL("hellip"), 8230 },
+    { QSL("colon"), 58 }, { QSL("Tab"), 9 }, { QSL("NewLine"), 10 }
+  };
+  uint code = 0;
+
+  *length = 1;
+
+  if (position + 1 < input.size() && input.at(position + 1) == QL1C('#')) {
+    const bool hexadecimal = position + 2 < input.size() && input.at(position + 2).toLower() == QL1C('x');
+    const int digits_start = position + (hexadecimal ? 3 : 2);
+    int end = digits_start;
+    bool ok;
+
+    while (end < input.size() && isDigitOf(input.at(end), hexadecimal)) {
+      end++;
+    }
+
+    if (end == digits_start || end - digits_start > 8) {
+      return 0;
+    }
+
+    code = subReference(input, digits_start, end - digits_start).toUInt(&ok, hexadecimal ? 16 : 10);
+
+    if (!ok || code > 0x10FFFF) {
+      return 0;
+    }
+
+    *length = end - position + (end < input.size() && input.at(end) == QL1C(';') ? 1 : 0);
+  }
+  else {
+    const int end = input.indexOf(QL1C(';'), position + 1);
+
+    if (end > position + 1 && end - position <= 10) {
+      code = named_entities.value(subReference(input, position + 1, end - position - 1).toString());
+      *length = end - position + 1;
+    }
+  }
+
+  return code;
+}
+
+// Appends character reference starting at given position to text, returns its length.
+static int appendEntity(const QString& input, int position, PlainText& text) {
+  int length;
+  const uint code = decodeEntity(input.midRef(0), position, &length);
+
+  if (code == 0) {
+    text.append(QL1C('&'));
+    return 1;
+  }
+
+  foreach (const QChar& character, QString::fromUcs4(&code, 1)) {
+    text.append(character);
+  }
+
+  return length;
+}
+
+// Checks if attribute value is URL which runs script when opened. Browsers ignore
+// whitespace and control characters in URLs, so they are dropped and character
+// references are decoded before the scheme is checked.
+static bool isScriptedUrl(const QStringRef& value) {
+  static const QStringList scripted_schemes { QSL("javascript:"), QSL("vbscript:"), QSL("data:text/html") };
+  QString scheme;
+
+  for (int i = 0; i < value.size() && scheme.size() < 16;) {
+    uint code = value.at(i).unicode();
+    int length = 1;
+
+    if (code == '&') {
+      code = decodeEntity(value, i, &length);
+
+      if (code == 0) {
+        code = '&';
+      }
+    }
+
+    i += length;
+
+    if (code > ' ' && (code < 0x7F || code > 0x9F)) {
+      scheme += QString::fromUcs4(&code, 1).toLower();
+    }
+  }
+
+  foreach (const QString& scripted_scheme, scripted_schemes) {
+    if (scheme.startsWith(scripted_scheme)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+MessageContentProcessor::MessageContentProcessor() {}
+
+void MessageContentProcessor::processMessages(QList<Message>& messages) {
+  QElapsedTimer processing_timer;
+  qint64 contents_size = 0;
+
+  processing_timer.start();
+
+  for (int i = 0; i < messages.size(); i++) {
+    contents_size += messages.at(i).m_contents.size();
+    processMessage(messages[i]);
+  }
+
+  const qint64 elapsed = processing_timer.nsecsElapsed() / 1000;
+  const double kilobytes = contents_size / 1024.0;
+
+  qDebug("Processing of %d messages with %.1f KB of HTML took %lld us, %.1f us per KB.",
+         messages.size(), kilobytes, elapsed, kilobytes > 0.0 ? elapsed / kilobytes : 0.0);
+}
+
+void MessageContentProcessor::processMessage(Message& message) {
+  // Elements which are removed together with their contents, they run
+  // scripts or embed other documents.
+  static const QSet<QString> removed_elements {
+    QSL("script"), QSL("style"), QSL("iframe"), QSL("object"), QSL("applet"), QSL("frameset")
+  };
+
+  // Tags which are removed, they can change behavior of whole page or
+  // embed other documents. Contents of forms are kept.
+  static const QSet<QString> removed_tags {
+    QSL("base"), QSL("link"), QSL("meta"), QSL("embed"), QSL("frame"), QSL("form")
+  };
+
+  // Tags which separate words of text.
+  static const QSet<QString> breaking_tags {
+    QSL("br"), QSL("p"), QSL("div"), QSL("li"), QSL("ul"), QSL("ol"), QSL("dd"), QSL("dt"),
+    QSL("tr"), QSL("td"), QSL("th"), QSL("table"), QSL("hr"), QSL("img"), QSL("pre"), QSL("blockquote"),
+    QSL("h1"), QSL("h2"), QSL("h3"), QSL("h4"), QSL("h5"), QSL("h6"), QSL("figure"), QSL("figcaption"),
+    QSL("section"), QSL("article"), QSL("header"), QSL("footer")
+  };
+
+  const QString& input = message.m_contents;
+  const int length = input.size();
+  QString sanitized;
+  PlainText text;
+  QStringList image_urls;
+  bool changed = false;
+  int copied = 0;
+  int i = 0;
+
+  // Leaves given part of input out of sanitized contents.
+  auto remove = [&](int from, int to) {
+    sanitized.append(input.midRef(copied, from - copied));
+    copied = to;
+    changed = true;
+  };
+
+  while (i < length) {
+    const QChar character = input.at(i);
+
+    if (character == QL1C('&')) {
+      i += appendEntity(input, i, text);
+      continue;
+    }
+    else if (character != QL1C('<')) {
+      text.append(character);
+      i++;
+      continue;
+    }
+
+    if (input.midRef(i, 4) == QL1S("<!--")) {
+      const int comment_end = input.indexOf(QL1S("-->"), i + 4);
+      const int next = comment_end < 0 ? length : comment_end + 3;
+
+      remove(i, next);
+      i = next;
+      continue;
+    }
+
+    const bool closing = i + 1 < length && input.at(i + 1) == QL1C('/');
+    const int name_start = i + (closing ? 2 : 1);
+    int position = name_start;
+
+    while (position < length && isTagNameCharacter(input.at(position))) {
+      position++;
+    }
+
+    if (position == name_start) {
+      if (position < length && (input.at(position) == QL1C('!') || input.at(position) == QL1C('?'))) {
+        // Declaration or processing instruction is kept as it is.
+        const int declaration_end = input.indexOf(QL1C('>'), position);
+
+        i = declaration_end < 0 ? length : declaration_end + 1;
+      }
+      else {
+        text.append(character);
+        i++;
+      }
+
+      continue;
+    }
+
+    const QString name = input.mid(name_start, position - name_start).toLower();
+    const bool is_image = !closing && name == QL1S("img");
+    const bool is_removed_element = !closing && removed_elements.contains(name);
+    const bool is_removed_tag = is_removed_element || removed_tags.contains(name);
+    bool self_closing = false;
+
+    // Go through attributes and remove event handlers and scripted URLs.
+    while (position < length) {
+      position = skipWhiteSpace(input, position);
+
+      if (position >= length) {
+        break;
+      }
+      else if (input.at(position) == QL1C('>')) {
+        position++;
+        break;
+      }
+      else if (input.at(position) == QL1C('/')) {
+        self_closing = true;
+        position++;
+        continue;
+      }
+
+      const int attribute_start = position;
+
+      self_closing = false;
+
+      while (position < length && !input.at(position).isSpace() && input.at(position) != QL1C('=') &&
+             input.at(position) != QL1C('>') && input.at(position) != QL1C('/')) {
+        position++;
+      }
+
+      if (position == attribute_start) {
+        // Stray "=" without attribute name.
+        position++;
+        continue;
+      }
+
+      const QStringRef attribute_name = input.midRef(attribute_start, position - attribute_start);
+      QStringRef value;
+
+      position = skipWhiteSpace(input, position);
+
+      if (position < length && input.at(position) == QL1C('=')) {
+        position = skipWhiteSpace(input, position + 1);
+
+        if (position < length && (input.at(position) == QL1C('"') || input.at(position) == QL1C('\''))) {
+          const int value_end = input.indexOf(input.at(position), position + 1);
+
+          if (value_end < 0) {
+            value = input.midRef(position + 1);
+            position = length;
+          }
+          else {
+            value = input.midRef(position + 1, value_end - position - 1);
+            position = value_end + 1;
+          }
+        }
+        else {
+          const int value_start = position;
+
+          while (position < length && !input.at(position).isSpace() && input.at(position) != QL1C('>')) {
+            position++;
+          }
+
+          value = input.midRef(value_start, position - value_start);
+        }
+      }
+
+      if (is_removed_tag) {
+        // Whole tag is removed anyway.
+        continue;
+      }
+      else if (attribute_name.startsWith(QL1S("on"), Qt::CaseInsensitive) ||
+               attribute_name.compare(QL1S("srcdoc"), Qt::CaseInsensitive) == 0 ||
+               isScriptedUrl(value)) {
+        remove(attribute_start, position);
+      }
+      else if (is_image && attribute_name.compare(QL1S("src"), Qt::CaseInsensitive) == 0 && !value.trimmed().isEmpty()) {
+        image_urls.append(value.trimmed().toString().replace(QL1S("&amp;"), QL1S("&")));
+      }
+    }
+
+    if (is_removed_element) {
+      int next = length;
+
+      if (!self_closing) {
+        const int element_end = input.indexOf(QL1S("</") + name, position, Qt::CaseInsensitive);
+
+        if (element_end >= 0) {
+          const int tag_end = input.indexOf(QL1C('>'), element_end);
+
+          next = tag_end < 0 ? length : tag_end + 1;
+        }
+      }
+      else {
+        next = position;
+      }
+
+      remove(i, next);
+      position = next;
+    }
+    else if (is_removed_tag) {
+      remove(i, position);
+    }
+
+    if (breaking_tags.contains(name)) {
+      text.breakWord();
+    }
+
+    i = position;
+  }
+
+  if (changed) {
+    sanitized.append(input.midRef(copied));
+    message.m_contents = sanitized;
+  }
+
+  message.m_imageUrls = image_urls;
+  message.m_preview = text.m_preview;
+  message.m_wordCount = text.m_words;
+}
@@ -0,0 +1,31 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef MESSAGECONTENTPROCESSOR_H
+#define MESSAGECONTENTPROCESSOR_H
+
+#include <QList>
+
+class Message;
+
+// Prepares HTML contents of incoming messages before they are stored.
+// Scripts, styles, embedded documents, comments, event handlers and scripted
+// URLs are removed and URLs of images, plain-text preview and word count
+// are extracted, so that message views do not need to scan contents again.
+// NOTE: Processing runs in threads which update feeds.
+class MessageContentProcessor {
+  private:
+
+    // Constructors and destructors.
+    MessageContentProcessor();
+
+  public:
+
+    // Processes contents of all messages and reports throughput.
+    static void processMessages(QList<Message>& messages);
+
+    // Sanitizes contents of message and fills its derived data,
+    // everything is done in single linear scan of the contents.
+    static void processMessage(Message& message);
+};
+
+#endif // MESSAGECONTENTPROCESSOR_H
@@ -0,0 +1,92 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/messagecountsservice.h"
+
+#include "core/feedsmodel.h"
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/databasequeries.h"
+#include "services/abstract/serviceroot.h"
+
+#include <QMutexLocker>
+#include <QTimer>
+
+MessageCountsService::MessageCountsService(FeedsModel* feeds_model)
+  : QObject(feeds_model), m_feedsModel(feeds_model), m_requestsTimer(new QTimer(this)), m_requestsScheduled(false) {
+  m_requestsTimer->setSingleShot(true);
+  m_requestsTimer->setInterval(COUNTS_UPDATE_COALESCE_INTERVAL);
+  connect(m_requestsTimer, &QTimer::timeout, this, &MessageCountsService::processRequests);
+}
+
+MessageCountsService::~MessageCountsService() {
+  qDebug("Destroying MessageCountsService instance.");
+}
+
+void MessageCountsService::updateAllCounts() {
+  m_requestsMutex.lock();
+  m_requestedAccounts.clear();
+  m_requestsMutex.unlock();
+
+  updateCounts(QSet<int>());
+}
+
+void MessageCountsService::requestCountsUpdate(int account_id) {
+  QMutexLocker locker(&m_requestsMutex);
+
+  m_requestedAccounts.insert(account_id);
+
+  if (!m_requestsScheduled) {
+    // Timer can be started only from main thread.
+    m_requestsScheduled = true;
+    QMetaObject::invokeMethod(this, "startRequestsTimer", Qt::QueuedConnection);
+  }
+}
+
+void MessageCountsService::startRequestsTimer() {
+  m_requestsTimer->start();
+}
+
+void MessageCountsService::processRequests() {
+  m_requestsMutex.lock();
+
+  const QSet<int> account_ids = m_requestedAccounts;
+
+  m_requestedAccounts.clear();
+  m_requestsScheduled = false;
+  m_requestsMutex.unlock();
+
+  if (!account_ids.isEmpty()) {
+    updateCounts(account_ids);
+  }
+}
+
+void MessageCountsService::updateCounts(const QSet<int>& account_ids) {
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  QHash<int, AccountMessageCounts> counts;
+  bool ok;
+
+  if (account_ids.size() == 1) {
+    const int account_id = *account_ids.constBegin();
+
+    counts.insert(account_id, DatabaseQueries::getMessageCountsForAccount(database, account_id, &ok));
+  }
+  else {
+    counts = DatabaseQueries::getMessageCountsForAllAccounts(database, &ok);
+  }
+
+  if (!ok) {
+    return;
+  }
+
+  foreach (ServiceRoot* root, m_feedsModel->serviceRoots()) {
+    if (!account_ids.isEmpty() && !account_ids.contains(root->accountId())) {
+      continue;
+    }
+
+    const QList<RootItem*> changed_items = root->applyMessageCounts(counts.value(root->accountId()), true);
+
+    if (!changed_items.isEmpty()) {
+      root->itemChanged(changed_items);
+    }
+  }
+}
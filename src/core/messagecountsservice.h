@@ -0,0 +1,49 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef MESSAGECOUNTSSERVICE_H
+#define MESSAGECOUNTSSERVICE_H
+
+#include <QObject>
+
+#include <QMutex>
+#include <QSet>
+
+class FeedsModel;
+class QTimer;
+
+// Obtains counts of messages of whole accounts with single grouped query
+// and distributes them to items of feeds model. Requests coming from
+// more callers at once are coalesced into one query.
+class MessageCountsService : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit MessageCountsService(FeedsModel* feeds_model);
+    virtual ~MessageCountsService();
+
+    // Updates counts of all accounts right now, pending requests are served too.
+    void updateAllCounts();
+
+  public slots:
+
+    // Schedules update of counts of given account.
+    // NOTE: This can be called from any thread.
+    void requestCountsUpdate(int account_id);
+
+  private slots:
+    void startRequestsTimer();
+    void processRequests();
+
+  private:
+
+    // Empty set means all accounts.
+    void updateCounts(const QSet<int>& account_ids);
+
+    FeedsModel* m_feedsModel;
+    QTimer* m_requestsTimer;
+    QMutex m_requestsMutex;
+    QSet<int> m_requestedAccounts;
+    bool m_requestsScheduled;
+};
+
+#endif // MESSAGECOUNTSSERVICE_H
@@ -0,0 +1,61 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/messagesloader.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/databasefactory.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+MessagesLoader::MessagesLoader(QObject* parent) : QObject(parent), m_generation(0) {
+  qRegisterMetaType<QList<QSqlRecord>>("QList<QSqlRecord>");
+}
+
+MessagesLoader::~MessagesLoader() {}
+
+void MessagesLoader::startLoading(int generation, const QString& statement) {
+  m_generation.store(generation);
+  QMetaObject::invokeMethod(this, "loadMessages", Qt::QueuedConnection,
+                            Q_ARG(int, generation), Q_ARG(QString, statement));
+}
+
+void MessagesLoader::cancel() {
+  m_generation.store(-1);
+}
+
+void MessagesLoader::loadMessages(int generation, const QString& statement) {
+  if (generation != m_generation.load()) {
+    // Newer load was scheduled meanwhile.
+    return;
+  }
+
+  QSqlDatabase database = qApp->database()->readOnlyConnection(metaObject()->className());
+  QSqlQuery query(database);
+  QList<QSqlRecord> records;
+
+  query.setForwardOnly(true);
+
+  if (!query.exec(statement)) {
+    qCritical("Error when loading messages: '%s'.", qPrintable(query.lastError().text()));
+    emit messagesLoaded(generation, records, true);
+    return;
+  }
+
+  while (query.next()) {
+    if (generation != m_generation.load()) {
+      qDebug("Loading of messages was cancelled.");
+      return;
+    }
+
+    records.append(query.record());
+
+    if (records.size() >= MSG_LOAD_BATCH_SIZE) {
+      emit messagesLoaded(generation, records, false);
+      records.clear();
+    }
+  }
+
+  emit messagesLoaded(generation, records, true);
+}
@@ -0,0 +1,42 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef MESSAGESLOADER_H
+#define MESSAGESLOADER_H
+
+#include <QObject>
+
+#include <QAtomicInt>
+#include <QList>
+#include <QSqlRecord>
+
+// Executes queries of message list in its own thread with its own
+// database connection and delivers resulting rows in batches, so that
+// even sorting of large lists does not block GUI.
+class MessagesLoader : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit MessagesLoader(QObject* parent = nullptr);
+    virtual ~MessagesLoader();
+
+    // Schedules new load, older running load is cancelled.
+    // NOTE: This is thread-safe.
+    void startLoading(int generation, const QString& statement);
+
+    // Cancels running load.
+    // NOTE: This is thread-safe.
+    void cancel();
+
+  signals:
+
+    // Batch of rows of given load was read, last batch is "finished".
+    void messagesLoaded(int generation, const QList<QSqlRecord>& records, bool finished);
+
+  private slots:
+    void loadMessages(int generation, const QString& statement);
+
+  private:
+    QAtomicInt m_generation;
+};
+
+#endif // MESSAGESLOADER_H
@@ -2,6 +2,7 @@
 
 #include "core/messagesmodel.h"
 
+#include "core/messagesloader.h"
 #include "core/messagesmodelcache.h"
 #include "definitions/definitions.h"
 #include "miscellaneous/application.h"
@@ -9,15 +10,23 @@
 #include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/textfactory.h"
+#include "services/abstract/feed.h"
 #include "services/abstract/recyclebin.h"
 #include "services/abstract/serviceroot.h"
 
-#include <QSqlError>
+#include <QElapsedTimer>
 #include <QSqlField>
+#include <QThread>
 
 MessagesModel::MessagesModel(QObject* parent)
-  : QSqlQueryModel(parent), MessagesModelSqlLayer(),
-  m_cache(new MessagesModelCache(this)), m_messageHighlighter(NoHighlighting), m_customDateFormat(QString()), m_itemHeight(-1) {
+  : QAbstractTableModel(parent), MessagesModelSqlLayer(),
+  m_cache(new MessagesModelCache(this)), m_messageHighlighter(NoHighlighting), m_customDateFormat(QString()),
+  m_selectedItem(nullptr), m_loaderThread(new QThread()), m_loader(new MessagesLoader()),
+  m_loadGeneration(0), m_isLoading(false), m_itemHeight(-1) {
+  m_loader->moveToThread(m_loaderThread);
+  connect(m_loader, &MessagesLoader::messagesLoaded, this, &MessagesModel::appendMessages);
+  m_loaderThread->start();
+
   setupFonts();
   setupIcons();
   setupHeaderData();
@@ -28,6 +37,12 @@ MessagesModel::MessagesModel(QObject* parent)
 
 MessagesModel::~MessagesModel() {
   qDebug("Destroying MessagesModel instance.");
+
+  m_loader->cancel();
+  m_loaderThread->quit();
+  m_loaderThread->wait();
+  delete m_loader;
+  delete m_loaderThread;
 }
 
 void MessagesModel::setupIcons() {
@@ -49,21 +64,74 @@ void MessagesModel::updateItemHeight() {
 }
 
 void MessagesModel::repopulate() {
+  const int generation = ++m_loadGeneration;
+
+  beginResetModel();
+  m_records.clear();
   m_cache->clear();
-  setQuery(selectStatement(), m_db);
+  invalidateDisplayData();
+  endResetModel();
+
+  m_loadTimer.start();
+
+  if (!m_isLoading) {
+    m_isLoading = true;
+    emit loadingStateChanged(true);
+  }
+
+  m_loader->startLoading(generation, selectStatement());
+}
+
+bool MessagesModel::isLoading() const {
+  return m_isLoading;
+}
+
+int MessagesModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_records.size();
+}
 
-  if (lastError().isValid()) {
-    qCritical() << "Error when setting new msg view query:" << lastError().text();
+int MessagesModel::columnCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_headerData.size();
+}
+
+void MessagesModel::appendMessages(int generation, const QList<QSqlRecord>& records, bool finished) {
+  if (generation != m_loadGeneration) {
+    // Rows of superseded load.
+    return;
+  }
+
+  if (!records.isEmpty()) {
+    if (m_records.isEmpty()) {
+      qDebug("First %d messages loaded in %lld ms.", records.size(), m_loadTimer.elapsed());
+    }
+
+    beginInsertRows(QModelIndex(), m_records.size(), m_records.size() + records.size() - 1);
+    m_records.append(records);
+    endInsertRows();
   }
 
-  while (canFetchMore()) {
-    fetchMore();
+  if (finished) {
+    finishLoading();
   }
 }
 
+void MessagesModel::finishLoading() {
+  qDebug("All %d messages loaded in %lld ms.", rowCount(), m_loadTimer.elapsed());
+
+  if (m_isLoading) {
+    m_isLoading = false;
+    emit loadingStateChanged(false);
+  }
+}
+
+QSqlRecord MessagesModel::record(int row) const {
+  return row >= 0 && row < m_records.size() ? m_records.at(row) : QSqlRecord();
+}
+
 bool MessagesModel::setData(const QModelIndex& index, const QVariant& value, int role) {
   Q_UNUSED(role)
   m_cache->setData(index, value, record(index.row()));
+  m_displayCache.remove(index.row());
   return true;
 }
 
@@ -80,24 +148,49 @@ void MessagesModel::setupFonts() {
 void MessagesModel::loadMessages(RootItem* item) {
   m_selectedItem = item;
 
+  reloadFeedTitles();
+
   if (item == nullptr) {
     setFilter(QSL(DEFAULT_SQL_MESSAGES_FILTER));
   }
-  else {
-    if (!item->getParentServiceRoot()->loadMessagesForItem(item, this)) {
-      setFilter(QSL("true != true"));
-      qWarning("Loading of messages from item '%s' failed.", qPrintable(item->title()));
-      qApp->showGuiMessage(tr("Loading of messages from item '%1' failed.").arg(item->title()),
-                           tr("Loading of messages failed, maybe messages could not be downloaded."),
-                           QSystemTrayIcon::Critical,
-                           qApp->mainFormWidget(),
-                           true);
-    }
+  else if (!item->getParentServiceRoot()->loadMessagesForItem(item, this)) {
+    setFilter(QSL("true != true"));
+    qWarning("Loading of messages from item '%s' failed.", qPrintable(item->title()));
+    qApp->showGuiMessage(tr("Loading of messages from item '%1' failed.").arg(item->title()),
+                         tr("Loading of messages failed, maybe messages could not be downloaded."),
+                         QSystemTrayIcon::Critical,
+                         qApp->mainFormWidget(),
+                         true);
   }
 
   repopulate();
 }
 
+bool MessagesModel::reloadFeedTitles() {
+  QHash<QString, QString> feed_titles;
+
+  if (m_selectedItem != nullptr) {
+    foreach (const Feed* feed, m_selectedItem->getParentServiceRoot()->feeds()) {
+      feed_titles.insert(feed->customId(), feed->title());
+    }
+  }
+
+  if (feed_titles == m_feedTitles) {
+    return false;
+  }
+
+  setFeedTitles(feed_titles);
+
+  // Displayed titles are refreshed right away, order of rows only on demand.
+  invalidateDisplayData();
+
+  if (rowCount() > 0) {
+    emit dataChanged(index(0, MSG_DB_FEED_TITLE_INDEX), index(rowCount() - 1, MSG_DB_FEED_TITLE_INDEX));
+  }
+
+  return isSortedBy(MSG_DB_FEED_TITLE_INDEX);
+}
+
 bool MessagesModel::setMessageImportantById(int id, RootItem::Importance important) {
   for (int i = 0; i < rowCount(); i++) {
     int found_id = data(i, MSG_DB_ID_INDEX, Qt::EditRole).toInt();
@@ -141,6 +234,86 @@ void MessagesModel::updateDateFormat() {
   else {
     m_customDateFormat = QString();
   }
+
+  invalidateDisplayData();
+}
+
+const MessageDisplayData& MessagesModel::displayData(int row) const {
+  QHash<int, MessageDisplayData>::const_iterator cached = m_displayCache.constFind(row);
+
+  if (cached != m_displayCache.constEnd()) {
+    return cached.value();
+  }
+
+  // Rows are usually requested in order they are painted, so
+  // prepare the whole batch of following rows at once.
+  const int last_row = qMax(row + 1, qMin(row + MSG_DISPLAY_CACHE_BATCH, rowCount()));
+  QElapsedTimer timer;
+  int prepared_rows = 0;
+
+  timer.start();
+
+  for (int i = row; i < last_row; i++) {
+    if (!m_displayCache.contains(i)) {
+      m_displayCache.insert(i, prepareDisplayData(i));
+      prepared_rows++;
+    }
+  }
+
+  const qint64 elapsed = timer.nsecsElapsed() / 1000;
+
+  qDebug("Display data of %d message rows prepared in %lld us (%lld us per row).",
+         prepared_rows, elapsed, prepared_rows > 0 ? elapsed / prepared_rows : 0);
+
+  return m_displayCache[row];
+}
+
+MessageDisplayData MessagesModel::prepareDisplayData(int row) const {
+  // Obtain all values of the row at once.
+  const QSqlRecord rec = m_cache->containsData(row) ? m_cache->record(row) : record(row);
+  const QDateTime dt = TextFactory::parseDateTime(rec.value(MSG_DB_DCREATED_INDEX).value<qint64>()).toLocalTime();
+  const bool is_bin = qobject_cast<RecycleBin*>(loadedItem()) != nullptr;
+  const bool is_deleted = rec.value(is_bin ? MSG_DB_PDELETED_INDEX : MSG_DB_DELETED_INDEX).toBool();
+  MessageDisplayData display_data;
+
+  display_data.m_createdOn = m_customDateFormat.isEmpty() ?
+                             dt.toString(Qt::DefaultLocaleShortDate) :
+                             dt.toString(m_customDateFormat);
+
+  // Do not display full contents here, plain-text preview is prepared when message is stored.
+  if (rec.isNull(MSG_DB_PREVIEW_INDEX)) {
+    display_data.m_contentsPreview = rec.value(MSG_DB_CONTENTS_INDEX).toString().mid(0, 64).simplified() + QL1S("...");
+  }
+  else {
+    display_data.m_contentsPreview = rec.value(MSG_DB_PREVIEW_INDEX).toString();
+  }
+
+  display_data.m_author = rec.value(MSG_DB_AUTHOR_INDEX).toString();
+
+  if (display_data.m_author.isEmpty()) {
+    display_data.m_author = QSL("-");
+  }
+
+  // Title of feed is not part of the query.
+  display_data.m_feedTitle = m_feedTitles.value(rec.value(MSG_DB_FEED_CUSTOM_ID_INDEX).toString(),
+                                                rec.value(MSG_DB_FEED_CUSTOM_ID_INDEX).toString());
+
+  display_data.m_isRead = rec.value(MSG_DB_READ_INDEX).toInt() == 1;
+  display_data.m_isImportant = rec.value(MSG_DB_IMPORTANT_INDEX).toInt() == 1;
+  display_data.m_hasEnclosures = rec.value(MSG_DB_HAS_ENCLOSURES).toBool();
+
+  if (display_data.m_isRead) {
+    display_data.m_font = is_deleted ? &m_normalStrikedFont : &m_normalFont;
+  }
+  else {
+    display_data.m_font = is_deleted ? &m_boldStrikedFont : &m_boldFont;
+  }
+
+  return display_data;
+}
+
+void MessagesModel::invalidateDisplayData() {
+  m_displayCache.clear();
 }
 
 void MessagesModel::reloadWholeLayout() {
@@ -187,7 +360,13 @@ void MessagesModel::setupHeaderData() {
 
     /*: Tooltip for custom ID of feed of message.*/ tr("Feed ID") <<
 
-    /*: Tooltip for indication of presence of enclosures.*/ tr("Has enclosures");
+    /*: Tooltip for indication of presence of enclosures.*/ tr("Has enclosures") <<
+
+    /*: Tooltip for images of message.*/ tr("Images") <<
+
+    /*: Tooltip for plain-text preview of message.*/ tr("Preview") <<
+
+    /*: Tooltip for number of words of message.*/ tr("Words");
 
   m_tooltipData <<
     tr("Id of the message.") << tr("Is message read?") <<
@@ -198,7 +377,8 @@ void MessagesModel::setupHeaderData() {
     tr("Contents of the message.") << tr("Is message permanently deleted from recycle bin?") <<
     tr("List of attachments.") << tr("Account ID of the message.") << tr("Custom ID of the message") <<
     tr("Custom hash of the message.") << tr("Custom ID of feed of the message.") <<
-    tr("Indication of enclosures presence within the message.");
+    tr("Indication of enclosures presence within the message.") << tr("Images referenced by the message.") <<
+    tr("Plain-text preview of the message.") << tr("Number of words of the message.");
 }
 
 Qt::ItemFlags MessagesModel::flags(const QModelIndex& index) const {
@@ -218,28 +398,19 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
       int index_column = idx.column();
 
       if (index_column == MSG_DB_DCREATED_INDEX) {
-        QDateTime dt = TextFactory::parseDateTime(QSqlQueryModel::data(idx, role).value<qint64>()).toLocalTime();
-
-        if (m_customDateFormat.isEmpty()) {
-          return dt.toString(Qt::DefaultLocaleShortDate);
-        }
-        else {
-          return dt.toString(m_customDateFormat);
-        }
+        return displayData(idx.row()).m_createdOn;
       }
       else if (index_column == MSG_DB_CONTENTS_INDEX) {
-        // Do not display full contents here.
-        QString contents = data(idx, Qt::EditRole).toString().mid(0, 64).simplified() + QL1S("...");
-
-        return contents;
+        return displayData(idx.row()).m_contentsPreview;
       }
       else if (index_column == MSG_DB_AUTHOR_INDEX) {
-        const QString author_name = QSqlQueryModel::data(idx, role).toString();
-
-        return author_name.isEmpty() ? QSL("-") : author_name;
+        return displayData(idx.row()).m_author;
+      }
+      else if (index_column == MSG_DB_FEED_TITLE_INDEX) {
+        return displayData(idx.row()).m_feedTitle;
       }
       else if (index_column != MSG_DB_IMPORTANT_INDEX && index_column != MSG_DB_READ_INDEX && index_column != MSG_DB_HAS_ENCLOSURES) {
-        return QSqlQueryModel::data(idx, role);
+        return record(idx.row()).value(idx.column());
       }
       else {
         return QVariant();
@@ -247,50 +418,18 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
     }
 
     case Qt::EditRole:
-      return m_cache->containsData(idx.row()) ? m_cache->data(idx) : QSqlQueryModel::data(idx, role);
+      return m_cache->containsData(idx.row()) ? m_cache->data(idx) : record(idx.row()).value(idx.column());
 
-    case Qt::FontRole: {
-      QModelIndex idx_read = index(idx.row(), MSG_DB_READ_INDEX);
-      QVariant data_read = data(idx_read, Qt::EditRole);
-      const bool is_bin = qobject_cast<RecycleBin*>(loadedItem()) != nullptr;
-      bool is_deleted;
-
-      if (is_bin) {
-        QModelIndex idx_del = index(idx.row(), MSG_DB_PDELETED_INDEX);
-
-        is_deleted = data(idx_del, Qt::EditRole).toBool();
-      }
-      else {
-        QModelIndex idx_del = index(idx.row(), MSG_DB_DELETED_INDEX);
-
-        is_deleted = data(idx_del, Qt::EditRole).toBool();
-      }
-
-      const bool striked = is_deleted;
-
-      if (data_read.toBool()) {
-        return striked ? m_normalStrikedFont : m_normalFont;
-      }
-      else {
-        return striked ? m_boldStrikedFont : m_boldFont;
-      }
-    }
+    case Qt::FontRole:
+      return *displayData(idx.row()).m_font;
 
     case Qt::ForegroundRole:
       switch (m_messageHighlighter) {
-        case HighlightImportant: {
-          QModelIndex idx_important = index(idx.row(), MSG_DB_IMPORTANT_INDEX);
-          QVariant dta = m_cache->containsData(idx_important.row()) ? m_cache->data(idx_important) : QSqlQueryModel::data(idx_important);
+        case HighlightImportant:
+          return displayData(idx.row()).m_isImportant ? QColor(Qt::blue) : QVariant();
 
-          return dta.toInt() == 1 ? QColor(Qt::blue) : QVariant();
-        }
-
-        case HighlightUnread: {
-          QModelIndex idx_read = index(idx.row(), MSG_DB_READ_INDEX);
-          QVariant dta = m_cache->containsData(idx_read.row()) ? m_cache->data(idx_read) : QSqlQueryModel::data(idx_read);
-
-          return dta.toInt() == 0 ? QColor(Qt::blue) : QVariant();
-        }
+        case HighlightUnread:
+          return !displayData(idx.row()).m_isRead ? QColor(Qt::blue) : QVariant();
 
         case NoHighlighting:
         default:
@@ -301,22 +440,13 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
       const int index_column = idx.column();
 
       if (index_column == MSG_DB_READ_INDEX) {
-        QModelIndex idx_read = index(idx.row(), MSG_DB_READ_INDEX);
-        QVariant dta = m_cache->containsData(idx_read.row()) ? m_cache->data(idx_read) : QSqlQueryModel::data(idx_read);
-
-        return dta.toInt() == 1 ? m_readIcon : m_unreadIcon;
+        return displayData(idx.row()).m_isRead ? m_readIcon : m_unreadIcon;
       }
       else if (index_column == MSG_DB_IMPORTANT_INDEX) {
-        QModelIndex idx_important = index(idx.row(), MSG_DB_IMPORTANT_INDEX);
-        QVariant dta = m_cache->containsData(idx_important.row()) ? m_cache->data(idx_important) : QSqlQueryModel::data(idx_important);
-
-        return dta.toInt() == 1 ? m_favoriteIcon : QVariant();
+        return displayData(idx.row()).m_isImportant ? m_favoriteIcon : QVariant();
       }
       else if (index_column == MSG_DB_HAS_ENCLOSURES) {
-        QModelIndex idx_important = index(idx.row(), MSG_DB_HAS_ENCLOSURES);
-        QVariant dta = QSqlQueryModel::data(idx_important);
-
-        return dta.toBool() ? m_enclosuresIcon : QVariant();
+        return displayData(idx.row()).m_hasEnclosures ? m_enclosuresIcon : QVariant();
       }
       else {
         return QVariant();
@@ -4,18 +4,34 @@
 #define MESSAGESMODEL_H
 
 #include "core/messagesmodelsqllayer.h"
-#include <QSqlQueryModel>
+#include <QAbstractTableModel>
 
 #include "core/message.h"
 #include "definitions/definitions.h"
 #include "services/abstract/rootitem.h"
 
+#include <QElapsedTimer>
 #include <QFont>
 #include <QIcon>
+#include <QSqlRecord>
 
+class MessagesLoader;
 class MessagesModelCache;
+class QThread;
+
+// Pre-formatted data of single message row as displayed in the list.
+struct MessageDisplayData {
+  QString m_createdOn;
+  QString m_contentsPreview;
+  QString m_author;
+  QString m_feedTitle;
+  const QFont* m_font = nullptr;
+  bool m_isRead = false;
+  bool m_isImportant = false;
+  bool m_hasEnclosures = false;
+};
 
-class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
+class MessagesModel : public QAbstractTableModel, public MessagesModelSqlLayer {
   Q_OBJECT
 
   public:
@@ -32,11 +48,17 @@ class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
     explicit MessagesModel(QObject* parent = 0);
     virtual ~MessagesModel();
 
-    // Fetches ALL available data to the model.
-    // NOTE: This activates the SQL query and populates the model with new data.
+    // Clears the model and starts loading of messages with the SQL query.
+    // NOTE: Query runs in worker thread and rows are appended in batches
+    // as they are read. Newer call cancels previous loading.
     void repopulate();
 
+    // True if model is still fetching rows of last query.
+    bool isLoading() const;
+
     // Model implementation.
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
     bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
     QVariant data(int row, int column, int role = Qt::DisplayRole) const;
@@ -69,6 +91,10 @@ class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
     // Loads messages of given feeds.
     void loadMessages(RootItem* item);
 
+    // Reloads titles of feeds of loaded item. Returns true if titles
+    // changed and messages need to be re-sorted because of that.
+    bool reloadFeedTitles();
+
   public slots:
 
     // NOTE: These methods DO NOT actually change data in the DB, just in the model.
@@ -76,17 +102,42 @@ class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
     bool setMessageImportantById(int id, RootItem::Importance important);
     bool setMessageReadById(int id, RootItem::ReadStatus read);
 
+  signals:
+    void loadingStateChanged(bool loading);
+
   private:
+    void appendMessages(int generation, const QList<QSqlRecord>& records, bool finished);
+    void finishLoading();
+
+    // Returns record of given row, empty record for invalid row.
+    QSqlRecord record(int row) const;
+
     void updateItemHeight();
     void setupHeaderData();
     void setupFonts();
     void setupIcons();
 
+    // Returns display data for given row, data are prepared
+    // in batches if they are not cached yet.
+    const MessageDisplayData& displayData(int row) const;
+    MessageDisplayData prepareDisplayData(int row) const;
+    void invalidateDisplayData();
+
     MessagesModelCache* m_cache;
+    mutable QHash<int, MessageDisplayData> m_displayCache;
     MessageHighlighter m_messageHighlighter;
     QString m_customDateFormat;
     RootItem* m_selectedItem;
 
+    QList<QSqlRecord> m_records;
+    QThread* m_loaderThread;
+    MessagesLoader* m_loader;
+
+    // Increased with each load, so that batches of superseded loads are dropped.
+    int m_loadGeneration;
+    bool m_isLoading;
+    QElapsedTimer m_loadTimer;
+
     QList<QString> m_headerData;
     QList<QString> m_tooltipData;
 
@@ -5,6 +5,8 @@
 #include "definitions/definitions.h"
 #include "miscellaneous/application.h"
 
+#include <algorithm>
+
 MessagesModelSqlLayer::MessagesModelSqlLayer()
   : m_filter(QSL(DEFAULT_SQL_MESSAGES_FILTER)), m_fieldNames(QMap<int, QString>()),
   m_sortColumns(QList<int>()), m_sortOrders(QList<Qt::SortOrder>()) {
@@ -15,7 +17,7 @@ MessagesModelSqlLayer::MessagesModelSqlLayer()
   m_fieldNames[MSG_DB_READ_INDEX] = "Messages.is_read";
   m_fieldNames[MSG_DB_DELETED_INDEX] = "Messages.is_deleted";
   m_fieldNames[MSG_DB_IMPORTANT_INDEX] = "Messages.is_important";
-  m_fieldNames[MSG_DB_FEED_TITLE_INDEX] = "Feeds.title";
+  m_fieldNames[MSG_DB_FEED_TITLE_INDEX] = "Messages.feed AS feed_title";
   m_fieldNames[MSG_DB_TITLE_INDEX] = "Messages.title";
   m_fieldNames[MSG_DB_URL_INDEX] = "Messages.url";
   m_fieldNames[MSG_DB_AUTHOR_INDEX] = "Messages.author";
@@ -28,13 +30,16 @@ MessagesModelSqlLayer::MessagesModelSqlLayer()
   m_fieldNames[MSG_DB_CUSTOM_HASH_INDEX] = "Messages.custom_hash";
   m_fieldNames[MSG_DB_FEED_CUSTOM_ID_INDEX] = "Messages.feed";
   m_fieldNames[MSG_DB_HAS_ENCLOSURES] = "CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures";
+  m_fieldNames[MSG_DB_IMAGES_INDEX] = "Messages.images";
+  m_fieldNames[MSG_DB_PREVIEW_INDEX] = "Messages.preview";
+  m_fieldNames[MSG_DB_WORD_COUNT_INDEX] = "Messages.word_count";
 
   // Used is <x>: SELECT ... FROM ... ORDER BY <x1> DESC, <x2> ASC;
   m_orderByNames[MSG_DB_ID_INDEX] = "Messages.id";
   m_orderByNames[MSG_DB_READ_INDEX] = "Messages.is_read";
   m_orderByNames[MSG_DB_DELETED_INDEX] = "Messages.is_deleted";
   m_orderByNames[MSG_DB_IMPORTANT_INDEX] = "Messages.is_important";
-  m_orderByNames[MSG_DB_FEED_TITLE_INDEX] = "Feeds.title";
+  m_orderByNames[MSG_DB_FEED_TITLE_INDEX] = "feed_title";
   m_orderByNames[MSG_DB_TITLE_INDEX] = "Messages.title";
   m_orderByNames[MSG_DB_URL_INDEX] = "Messages.url";
   m_orderByNames[MSG_DB_AUTHOR_INDEX] = "Messages.author";
@@ -47,6 +52,9 @@ MessagesModelSqlLayer::MessagesModelSqlLayer()
   m_orderByNames[MSG_DB_CUSTOM_HASH_INDEX] = "Messages.custom_hash";
   m_orderByNames[MSG_DB_FEED_CUSTOM_ID_INDEX] = "Messages.feed";
   m_orderByNames[MSG_DB_HAS_ENCLOSURES] = "has_enclosures";
+  m_orderByNames[MSG_DB_IMAGES_INDEX] = "Messages.images";
+  m_orderByNames[MSG_DB_PREVIEW_INDEX] = "Messages.preview";
+  m_orderByNames[MSG_DB_WORD_COUNT_INDEX] = "Messages.word_count";
 }
 
 void MessagesModelSqlLayer::addSortState(int column, Qt::SortOrder order) {
@@ -82,14 +90,41 @@ void MessagesModelSqlLayer::setFilter(const QString& filter) {
   m_filter = filter;
 }
 
+void MessagesModelSqlLayer::setFeedTitles(const QHash<QString, QString>& feed_titles) {
+  m_feedTitles = feed_titles;
+}
+
+bool MessagesModelSqlLayer::isSortedBy(int column) const {
+  return m_sortColumns.contains(column);
+}
+
 QString MessagesModelSqlLayer::formatFields() const {
   return m_fieldNames.values().join(QSL(", "));
 }
 
+QString MessagesModelSqlLayer::feedTitleOrderExpression() const {
+  if (m_feedTitles.isEmpty()) {
+    return QSL("Messages.feed");
+  }
+
+  QStringList feed_ids = m_feedTitles.keys();
+  QString expression = QSL("CASE Messages.feed");
+
+  std::sort(feed_ids.begin(), feed_ids.end(), [this](const QString& lhs, const QString& rhs) {
+    return QString::localeAwareCompare(m_feedTitles.value(lhs), m_feedTitles.value(rhs)) < 0;
+  });
+
+  // Feeds are ranked by their titles.
+  for (int i = 0; i < feed_ids.size(); i++) {
+    expression += QString(" WHEN '%1' THEN %2").arg(QString(feed_ids.at(i)).replace(QL1C('\''), QSL("''")),
+                                                    QString::number(i));
+  }
+
+  return expression + QString(" ELSE %1 END").arg(feed_ids.size());
+}
+
 QString MessagesModelSqlLayer::selectStatement() const {
-  return QL1S("SELECT ") + formatFields() +
-         QSL(" FROM Messages LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id WHERE ") +
-         m_filter + orderByClause() + QL1C(';');
+  return QL1S("SELECT ") + formatFields() + QSL(" FROM Messages WHERE ") + m_filter + orderByClause() + QL1C(';');
 }
 
 QString MessagesModelSqlLayer::orderByClause() const {
@@ -100,11 +135,17 @@ QString MessagesModelSqlLayer::orderByClause() const {
     QStringList sorts;
 
     for (int i = 0; i < m_sortColumns.size(); i++) {
-      QString field_name(m_orderByNames[m_sortColumns[i]]);
+      QString field_name(m_sortColumns[i] == MSG_DB_FEED_TITLE_INDEX ? feedTitleOrderExpression() : m_orderByNames[m_sortColumns[i]]);
 
       sorts.append(field_name + (m_sortOrders[i] == Qt::AscendingOrder ? QSL(" ASC") : QSL(" DESC")));
     }
 
+    // Order is made total with ID of message, so that it matches
+    // indexes which end with (implicit) primary key.
+    if (!m_sortColumns.contains(MSG_DB_ID_INDEX)) {
+      sorts.append(m_orderByNames[MSG_DB_ID_INDEX] + (m_sortOrders.first() == Qt::AscendingOrder ? QSL(" ASC") : QSL(" DESC")));
+    }
+
     return QL1S(" ORDER BY ") + sorts.join(QSL(", "));
   }
 }
@@ -5,6 +5,7 @@
 
 #include <QSqlDatabase>
 
+#include <QHash>
 #include <QList>
 #include <QMap>
 
@@ -18,11 +19,22 @@ class MessagesModelSqlLayer {
     // Sets SQL WHERE clause, without "WHERE" keyword.
     void setFilter(const QString& filter);
 
+    // Sets titles of feeds keyed by their custom IDs. Titles are not
+    // joined from database, so that messages can be listed via indexes.
+    void setFeedTitles(const QHash<QString, QString>& feed_titles);
+
+    // Returns true if messages are sorted by given column.
+    bool isSortedBy(int column) const;
+
   protected:
     QString orderByClause() const;
     QString selectStatement() const;
     QString formatFields() const;
+    QString feedTitleOrderExpression() const;
+
+    QHash<QString, QString> m_feedTitles;
 
+    // Connection used for changing messages.
     QSqlDatabase m_db;
 
   private:
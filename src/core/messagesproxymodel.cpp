@@ -20,12 +20,12 @@ MessagesProxyModel::~MessagesProxyModel() {
   qDebug("Destroying MessagesProxyModel instance.");
 }
 
-QModelIndex MessagesProxyModel::getNextPreviousUnreadItemIndex(int default_row) {
+QModelIndex MessagesProxyModel::getNextPreviousUnreadItemIndex(int default_row, bool search_previous) {
   const bool started_from_zero = default_row == 0;
   QModelIndex next_index = getNextUnreadItemIndex(default_row, rowCount() - 1);
 
   // There is no next message, check previous.
-  if (!next_index.isValid() && !started_from_zero) {
+  if (!next_index.isValid() && !started_from_zero && search_previous) {
     next_index = getNextUnreadItemIndex(0, default_row - 1);
   }
 
@@ -16,7 +16,8 @@ class MessagesProxyModel : public QSortFilterProxyModel {
     explicit MessagesProxyModel(MessagesModel* source_model, QObject* parent = 0);
     virtual ~MessagesProxyModel();
 
-    QModelIndex getNextPreviousUnreadItemIndex(int default_row);
+    // Finds next unread message, previous messages are searched too if there is no next one.
+    QModelIndex getNextPreviousUnreadItemIndex(int default_row, bool search_previous = true);
 
     // Maps list of indexes.
     QModelIndexList mapListToSource(const QModelIndexList& indexes) const;
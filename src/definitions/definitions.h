@@ -22,11 +22,32 @@
 #define IS_IN_ARRAY(offset, array)            ((offset >= 0) && (offset < array.count()))
 #define ADBLOCK_CUSTOMLIST_NAME               "customlist.txt"
 #define ADBLOCK_LISTS_SUBDIRECTORY            "adblock"
+#define NETWORK_CACHE_SUBDIRECTORY            "network-cache"
+#define WEB_CACHE_SUBDIRECTORY                "web-cache"
+#define NETWORK_CACHE_MAX_SIZE                104857600
+#define NETWORK_CACHE_MAX_REFRESHED           4096
+#define IMAGE_PREFETCH_PARALLEL               2
+#define IMAGE_PREFETCH_MAX_QUEUE              500
+#define IMAGE_PREFETCH_MAX_PER_MESSAGE        10
+#define ENCLOSURE_PREFETCH_RESUME_DELAY       20000
+#define ENCLOSURE_PREFETCH_SUBDIRECTORY       "enclosures"
+#define CACHED_STATES_CHECK_INTERVAL          60000
+#define CACHED_STATES_RETRY_DELAY             60
+#define CACHED_STATES_MAX_RETRY_DELAY         3600
 #define ADBLOCK_EASYLIST_URL                  "https://easylist-downloads.adblockplus.org/easylist.txt"
+#define ADBLOCK_MATCHER_RETIRE_INTERVAL       250
+#define ADBLOCK_LATENCY_BUCKETS               8
+#define ADBLOCK_LATENCY_REPORT_INTERVAL       1000
+#define ADBLOCK_CACHE_SUFFIX                  ".cache"
+#define ADBLOCK_CACHE_MAGIC                   0x52474142
+#define ADBLOCK_CACHE_VERSION                 1
+#define ADBLOCK_CSS_CACHE_SIZE                64
+#define ADBLOCK_CSS_CACHE_REPORT_INTERVAL     100
 #define DEFAULT_SQL_MESSAGES_FILTER           "0 > 1"
 #define MAX_MULTICOLUMN_SORT_STATES           3
 #define ENCLOSURES_OUTER_SEPARATOR            '#'
 #define ECNLOSURES_INNER_SEPARATOR            '&'
+#define MSG_IMAGES_SEPARATOR                  '\n'
 #define URI_SCHEME_FEED_SHORT                 "feed:"
 #define URI_SCHEME_FEED                       "feed://"
 #define URI_SCHEME_HTTP                       "http://"
@@ -34,15 +55,25 @@
 #define DEFAULT_LOCALE                        "en"
 #define DEFAULT_FEED_ENCODING                 "UTF-8"
 #define DEFAULT_FEED_TYPE                     "RSS"
+#define FEED_TRANSCODING_CHUNK_SIZE           65536
 #define URL_REGEXP "^(http|https|feed|ftp):\\/\\/[\\w\\-_]+(\\.[\\w\\-_]+)+([\\w\\-\\.,@?^=%&amp;:/~\\+#]*[\\w\\-\\@?^=%&amp;/~\\+#])?$"
 #define TEXT_TITLE_LIMIT                      30
 #define RESELECT_MESSAGE_THRESSHOLD           500
+#define MSG_DISPLAY_CACHE_BATCH               64
+#define MSG_LOAD_BATCH_SIZE                   256
+#define MSG_PREVIEW_LENGTH                    200
+#define MSG_BACKFILL_BATCH_SIZE               200
+#define MSG_BACKFILL_DELAY                    10000
 #define ICON_SIZE_SETTINGS                    16
 #define NO_PARENT_CATEGORY                    -1
 #define ID_RECYCLE_BIN                        -2
 #define TRAY_ICON_BUBBLE_TIMEOUT              20000
 #define CLOSE_LOCK_TIMEOUT                    500
 #define DOWNLOAD_TIMEOUT                      30000
+#define DOWNLOAD_SEGMENT_MIN_SIZE             8388608
+#define DOWNLOAD_SPEED_SAMPLE_INTERVAL        500
+#define DOWNLOAD_BANDWIDTH_TICK               100
+#define DOWNLOAD_THROTTLED_BUFFER_SIZE        65536
 #define MESSAGES_VIEW_DEFAULT_COL             170
 #define MESSAGES_VIEW_MINIMUM_COL             16
 #define FEEDS_VIEW_COLUMN_COUNT               2
@@ -69,7 +100,8 @@
 #define GOOGLE_SEARCH_URL                     "https://www.google.com/search?q=%1&ie=utf-8&oe=utf-8"
 #define GOOGLE_SUGGEST_URL                    "http://suggestqueries.google.com/complete/search?output=toolbar&hl=en&q=%1"
 #define ENCRYPTION_FILE_NAME                  "key.private"
-#define RELOAD_MODEL_BORDER_NUM               10
+#define RELOAD_MODEL_COALESCE_INTERVAL        30
+#define COUNTS_UPDATE_COALESCE_INTERVAL       250
 #define EXTERNAL_TOOL_SEPARATOR               "###"
 #define EXTERNAL_TOOL_PARAM_SEPARATOR         "|||"
 
@@ -77,6 +109,11 @@
 #define HTTP_HEADERS_CONTENT_TYPE   "Content-Type"
 #define HTTP_HEADERS_AUTHORIZATION  "Authorization"
 #define HTTP_HEADERS_USER_AGENT     "User-Agent"
+#define HTTP_HEADERS_RANGE          "Range"
+#define HTTP_HEADERS_IF_RANGE       "If-Range"
+#define HTTP_HEADERS_ACCEPT_RANGES  "Accept-Ranges"
+#define HTTP_HEADERS_ETAG           "ETag"
+#define HTTP_HEADERS_LAST_MODIFIED  "Last-Modified"
 
 #define MAX_ZOOM_FACTOR     5.0f
 #define MIN_ZOOM_FACTOR     0.25f
@@ -111,9 +148,21 @@
 #define APP_DB_SQLITE_INIT            "db_init_sqlite.sql"
 #define APP_DB_SQLITE_PATH            "database/local"
 #define APP_DB_SQLITE_FILE            "database.db"
+#define APP_DB_SQLITE_WAL_SUFFIX      "-wal"
+#define APP_DB_SQLITE_SHM_SUFFIX      "-shm"
+#define APP_DB_CHECKPOINT_INTERVAL    30000
+#define APP_DB_WRITE_WAIT_REPORT      100
+#define APP_DB_CLEANUP_BATCH_SIZE     2000
+#define APP_DB_CLEANUP_BATCH_PAUSE    20
+#define APP_DB_CLEANUP_VACUUM_PAGES   1024
+#define APP_DB_CLEANUP_CHECK_INTERVAL 600000
+#define APP_DB_CLEANUP_INTERVAL_DAYS  1
+
+#define SETTINGS_READ_REPORT_INTERVAL 5000
+#define SETTINGS_READ_REPORT_KEYS     5
 
 // Keep this in sync with schema versions declared in SQL initialization code.
-#define APP_DB_SCHEMA_VERSION         "11"
+#define APP_DB_SCHEMA_VERSION         "15"
 #define APP_DB_UPDATE_FILE_PATTERN    "db_update_%1_%2_%3.sql"
 #define APP_DB_COMMENT_SPLIT          "-- !\n"
 #define APP_DB_NAME_PLACEHOLDER       "##"
@@ -172,6 +221,9 @@
 #define MSG_DB_CUSTOM_HASH_INDEX        14
 #define MSG_DB_FEED_CUSTOM_ID_INDEX     15
 #define MSG_DB_HAS_ENCLOSURES           16
+#define MSG_DB_IMAGES_INDEX             17
+#define MSG_DB_PREVIEW_INDEX            18
+#define MSG_DB_WORD_COUNT_INDEX         19
 
 // Indexes of columns as they are DEFINED IN THE TABLE for CATEGORIES.
 #define CAT_DB_ID_INDEX           0
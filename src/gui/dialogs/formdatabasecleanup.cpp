@@ -10,7 +10,8 @@
 #include <QDialogButtonBox>
 #include <QPushButton>
 
-FormDatabaseCleanup::FormDatabaseCleanup(QWidget* parent) : QDialog(parent), m_ui(new Ui::FormDatabaseCleanup), m_cleaner(nullptr) {
+FormDatabaseCleanup::FormDatabaseCleanup(QWidget* parent) : QDialog(parent), m_ui(new Ui::FormDatabaseCleanup), m_cleaner(nullptr),
+  m_cancelRequested(false) {
   m_ui->setupUi(this);
 
   // Set flags and attributes.
@@ -38,11 +39,25 @@ void FormDatabaseCleanup::setCleaner(DatabaseCleaner* cleaner) {
   connect(m_cleaner, &DatabaseCleaner::purgeStarted, this, &FormDatabaseCleanup::onPurgeStarted);
   connect(m_cleaner, &DatabaseCleaner::purgeProgress, this, &FormDatabaseCleanup::onPurgeProgress);
   connect(m_cleaner, &DatabaseCleaner::purgeFinished, this, &FormDatabaseCleanup::onPurgeFinished);
+
+  if (m_cleaner->isRunning()) {
+    // Automatic cleanup is running in background.
+    onPurgeStarted();
+  }
 }
 
 void FormDatabaseCleanup::closeEvent(QCloseEvent* event) {
   if (m_ui->m_progressBar->isEnabled()) {
     event->ignore();
+
+    if (!m_cancelRequested) {
+      // Cleanup stops after current batch of messages.
+      m_cancelRequested = true;
+      m_cleaner->cancel();
+      m_ui->m_btnBox->button(QDialogButtonBox::Close)->setEnabled(false);
+      m_ui->m_lblResult->setStatus(WidgetWithStatus::Information, tr("Database cleanup is being cancelled."),
+                                   tr("Database cleanup is being cancelled."));
+    }
   }
   else {
     QDialog::closeEvent(event);
@@ -75,25 +90,36 @@ void FormDatabaseCleanup::startPurging() {
 }
 
 void FormDatabaseCleanup::onPurgeStarted() {
+  m_cancelRequested = false;
   m_ui->m_progressBar->setValue(0);
   m_ui->m_progressBar->setEnabled(true);
-  m_ui->m_btnBox->setEnabled(false);
+  m_ui->m_btnBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+  m_ui->m_btnBox->button(QDialogButtonBox::Close)->setText(tr("Cancel"));
   m_ui->m_lblResult->setStatus(WidgetWithStatus::Information, tr("Database cleanup is running."), tr("Database cleanup is running."));
 }
 
 void FormDatabaseCleanup::onPurgeProgress(int progress, const QString& description) {
   m_ui->m_progressBar->setValue(progress);
-  m_ui->m_lblResult->setStatus(WidgetWithStatus::Information, description, description);
+
+  if (!m_cancelRequested) {
+    m_ui->m_lblResult->setStatus(WidgetWithStatus::Information, description, description);
+  }
 }
 
 void FormDatabaseCleanup::onPurgeFinished(bool finished) {
   m_ui->m_progressBar->setEnabled(false);
   m_ui->m_progressBar->setValue(0);
-  m_ui->m_btnBox->setEnabled(true);
+  m_ui->m_btnBox->button(QDialogButtonBox::Ok)->setEnabled(true);
+  m_ui->m_btnBox->button(QDialogButtonBox::Close)->setEnabled(true);
+  m_ui->m_btnBox->button(QDialogButtonBox::Close)->setText(tr("Close"));
 
   if (finished) {
     m_ui->m_lblResult->setStatus(WidgetWithStatus::Ok, tr("Database cleanup is completed."), tr("Database cleanup is completed."));
   }
+  else if (m_cancelRequested) {
+    m_ui->m_lblResult->setStatus(WidgetWithStatus::Warning, tr("Database cleanup was cancelled."),
+                                 tr("Database cleanup was cancelled. Remaining messages will be removed next time."));
+  }
   else {
     m_ui->m_lblResult->setStatus(WidgetWithStatus::Error, tr("Database cleanup failed."), tr("Database cleanup failed."));
   }
@@ -40,6 +40,7 @@ class FormDatabaseCleanup : public QDialog {
   private:
     QScopedPointer<Ui::FormDatabaseCleanup> m_ui;
     DatabaseCleaner* m_cleaner;
+    bool m_cancelRequested;
 };
 
 #endif // FORMDATABASECLEANUP_H
@@ -209,6 +209,9 @@ void FeedMessageViewer::createConnections() {
   // State of many messages is changed, then we need
   // to reload selections.
   connect(m_feedsView->sourceModel(), &FeedsModel::reloadMessageListRequested, m_messagesView, &MessagesView::reloadSelections);
+
+  // Feeds can be renamed, message list displays and sorts by their titles.
+  connect(m_feedsView->sourceModel(), &FeedsModel::dataChanged, m_messagesView, &MessagesView::reloadFeedTitles);
 }
 
 void FeedMessageViewer::initialize() {
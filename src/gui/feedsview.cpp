@@ -12,6 +12,7 @@
 #include "miscellaneous/feedreader.h"
 #include "miscellaneous/mutex.h"
 #include "miscellaneous/systemfactory.h"
+#include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/feed.h"
 #include "services/abstract/rootitem.h"
 #include "services/abstract/serviceroot.h"
@@ -196,6 +197,14 @@ void FeedsView::clearAllFeeds() {
   m_sourceModel->markItemCleared(m_sourceModel->rootItem(), false);
 }
 
+// Items of account cannot be edited or removed while its cached
+// message states are sent to server in background.
+static bool isSendingCachedData(RootItem* item) {
+  auto cache = item != nullptr ? dynamic_cast<CacheForServiceRoot*>(item->getParentServiceRoot()) : nullptr;
+
+  return cache != nullptr && cache->isSendingCachedData();
+}
+
 void FeedsView::editSelectedItem() {
   if (!qApp->feedUpdateLock()->tryLock()) {
     // Lock was not obtained because
@@ -209,6 +218,14 @@ void FeedsView::editSelectedItem() {
     return;
   }
 
+  if (isSendingCachedData(selectedItem())) {
+    qApp->showGuiMessage(tr("Cannot edit item"),
+                         tr("Selected item cannot be edited because its account is sending changes to server."),
+                         QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
+    qApp->feedUpdateLock()->unlock();
+    return;
+  }
+
   if (selectedItem()->canBeEdited()) {
     selectedItem()->editViaGui();
   }
@@ -245,6 +262,14 @@ void FeedsView::deleteSelectedItem() {
 
   RootItem* selected_item = selectedItem();
 
+  if (isSendingCachedData(selected_item)) {
+    qApp->showGuiMessage(tr("Cannot delete item"),
+                         tr("Selected item cannot be deleted because its account is sending changes to server."),
+                         QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
+    qApp->feedUpdateLock()->unlock();
+    return;
+  }
+
   if (selected_item != nullptr) {
     if (selected_item->canBeDeleted()) {
       // Ask user first.
@@ -6,6 +6,8 @@
 #include "gui/messagebox.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasequeries.h"
+#include "miscellaneous/feedreader.h"
+#include "network-web/enclosureprefetcher.h"
 #include "network-web/webfactory.h"
 #include "services/abstract/serviceroot.h"
 
@@ -228,8 +230,13 @@ QString MessagePreviewer::prepareHtmlForMessage(const Message& message) {
 
   foreach (const Enclosure& enc, message.m_enclosures) {
     QString enc_url;
+    const QString local_file = qApp->feedReader()->enclosurePrefetcher()->localFile(enc.m_url);
 
-    if (!enc.m_url.contains(QRegularExpression(QSL("^(http|ftp|\\/)")))) {
+    if (!local_file.isEmpty()) {
+      // Enclosure was downloaded in advance.
+      enc_url = QUrl::fromLocalFile(local_file).toString();
+    }
+    else if (!enc.m_url.startsWith(QL1S("http")) && !enc.m_url.startsWith(QL1S("ftp")) && !enc.m_url.startsWith(QL1C('/'))) {
       enc_url = QString(INTERNAL_URL_PASSATTACHMENT) + QL1S("/?") + enc.m_url;
     }
     else {
@@ -239,15 +246,10 @@ QString MessagePreviewer::prepareHtmlForMessage(const Message& message) {
     html += QString("[%2] <a href=\"%1\">%1</a><br/>").arg(enc_url, enc.m_mimeType);
   }
 
-  int offset = 0;
-  QRegExp imgTagRegex("\\<img[^\\>]*src\\s*=\\s*\"([^\"]*)\"[^\\>]*\\>", Qt::CaseInsensitive);
-
-  imgTagRegex.setMinimal(true);
-
-  while ((offset = imgTagRegex.indexIn(message.m_contents, offset)) != -1) {
-    m_pictures.append(imgTagRegex.cap(1));
-    offset += imgTagRegex.matchedLength();
-    html += QString("[%2] <a href=\"%1\">%1</a><br/>").arg(imgTagRegex.cap(1), tr("image"));
+  // Images were extracted from contents when message was stored.
+  foreach (const QString& image_url, message.m_imageUrls) {
+    m_pictures.append(image_url);
+    html += QString("[%2] <a href=\"%1\">%1</a><br/>").arg(image_url, tr("image"));
   }
 
   html += "<br/>";
@@ -36,7 +36,9 @@
 #include <QScrollBar>
 #include <QTimer>
 
-MessagesView::MessagesView(QWidget* parent) : QTreeView(parent), m_contextMenu(nullptr), m_columnsAdjusted(false) {
+MessagesView::MessagesView(QWidget* parent)
+  : QTreeView(parent), m_contextMenu(nullptr), m_columnsAdjusted(false), m_reselectedMessageId(0),
+  m_selectNextUnreadWhenLoaded(false) {
   m_sourceModel = qApp->feedReader()->messagesModel();
   m_proxyModel = qApp->feedReader()->messagesProxyModel();
 
@@ -78,6 +80,26 @@ void MessagesView::createConnections() {
   // Adjust columns when layout gets changed.
   connect(header(), &QHeaderView::geometriesChanged, this, &MessagesView::adjustColumns);
   connect(header(), &QHeaderView::sortIndicatorChanged, this, &MessagesView::onSortIndicatorChanged);
+  connect(m_sourceModel, &MessagesModel::rowsInserted, this, &MessagesView::reselectLoadedMessage);
+  connect(m_sourceModel, &MessagesModel::loadingStateChanged, this, [this](bool loading) {
+    if (loading) {
+      viewport()->setCursor(Qt::BusyCursor);
+      return;
+    }
+
+    viewport()->unsetCursor();
+
+    if (m_reselectedMessageId > 0) {
+      // Previously selected message is not in the list anymore.
+      m_reselectedMessageId = 0;
+      emit currentMessageRemoved();
+    }
+
+    if (m_selectNextUnreadWhenLoaded) {
+      m_selectNextUnreadWhenLoaded = false;
+      selectNextUnreadItem();
+    }
+  });
 }
 
 void MessagesView::keyboardSearch(const QString& search) {
@@ -88,53 +110,62 @@ void MessagesView::keyboardSearch(const QString& search) {
   setSelectionMode(QAbstractItemView::ExtendedSelection);
 }
 
+void MessagesView::reloadFeedTitles() {
+  if (m_sourceModel->reloadFeedTitles()) {
+    reloadSelections();
+  }
+}
+
 void MessagesView::reloadSelections() {
-  const QDateTime dt1 = QDateTime::currentDateTime();
-  QModelIndex current_index = selectionModel()->currentIndex();
-  const QModelIndex mapped_current_index = m_proxyModel->mapToSource(current_index);
-  const Message selected_message = m_sourceModel->messageAt(mapped_current_index.row());
+  const QModelIndex current_index = selectionModel()->currentIndex();
   const int col = header()->sortIndicatorSection();
   const Qt::SortOrder ord = header()->sortIndicatorOrder();
 
-  // Reload the model now.
+  // Message which is still waiting for reselection from previous reload is kept.
+  const int selected_id = current_index.isValid() ?
+                          m_sourceModel->messageId(m_proxyModel->mapToSource(current_index).row()) :
+                          m_reselectedMessageId;
+
+  // Reload the model now, rows are loaded in background. Previously
+  // focused message is selected again when its row is loaded.
+  m_reselectedMessageId = 0;
   sort(col, ord, true, false, false);
+  m_reselectedMessageId = selected_id;
 
-  // Now, we must find the same previously focused message.
-  if (selected_message.m_id > 0) {
-    if (m_proxyModel->rowCount() == 0) {
-      current_index = QModelIndex();
-    }
-    else {
-      for (int i = 0; i < m_proxyModel->rowCount(); i++) {
-        QModelIndex msg_idx = m_proxyModel->index(i, MSG_DB_TITLE_INDEX);
-        Message msg = m_sourceModel->messageAt(m_proxyModel->mapToSource(msg_idx).row());
+  if (selected_id <= 0) {
+    // Nothing can be selected and no message can be displayed.
+    emit currentMessageRemoved();
+  }
+}
 
-        if (msg.m_id == selected_message.m_id) {
-          current_index = msg_idx;
-          break;
-        }
+void MessagesView::reselectLoadedMessage(const QModelIndex& parent, int first, int last) {
+  Q_UNUSED(parent)
 
-        if (i == m_proxyModel->rowCount() - 1) {
-          current_index = QModelIndex();
-        }
-      }
-    }
+  if (m_reselectedMessageId <= 0) {
+    return;
   }
 
-  if (current_index.isValid()) {
-    scrollTo(current_index);
-    setCurrentIndex(current_index);
-    reselectIndexes(QModelIndexList() << current_index);
-  }
-  else {
-    // Messages were probably removed from the model, nothing can
-    // be selected and no message can be displayed.
-    emit currentMessageRemoved();
-  }
+  for (int row = first; row <= last; row++) {
+    if (m_sourceModel->messageId(row) != m_reselectedMessageId) {
+      continue;
+    }
+
+    const QModelIndex current_index = m_proxyModel->mapFromSource(m_sourceModel->index(row, MSG_DB_TITLE_INDEX));
+
+    m_reselectedMessageId = 0;
 
-  const QDateTime dt2 = QDateTime::currentDateTime();
+    if (current_index.isValid()) {
+      scrollTo(current_index);
+      setCurrentIndex(current_index);
+      reselectIndexes(QModelIndexList() << current_index);
+    }
+    else {
+      // Message is hidden by filter.
+      emit currentMessageRemoved();
+    }
 
-  qDebug("Reloading of msg selections took %lld miliseconds.", dt1.msecsTo(dt2));
+    return;
+  }
 }
 
 void MessagesView::setupAppearance() {
@@ -286,6 +317,9 @@ void MessagesView::selectionChanged(const QItemSelection& selected, const QItemS
          mapped_current_index.column());
 
   if (mapped_current_index.isValid() && selected_rows.count() > 0) {
+    // User selected another message meanwhile, do not change the selection.
+    m_reselectedMessageId = 0;
+
     Message message = m_sourceModel->messageAt(m_proxyModel->mapToSource(current_index).row());
 
     // Set this message as read only if current item
@@ -310,6 +344,8 @@ void MessagesView::loadItem(RootItem* item) {
   const int col = header()->sortIndicatorSection();
   const Qt::SortOrder ord = header()->sortIndicatorOrder();
 
+  m_reselectedMessageId = 0;
+  m_selectNextUnreadWhenLoaded = false;
   scrollToTop();
   sort(col, ord, false, true, false);
   m_sourceModel->loadMessages(item);
@@ -502,9 +538,14 @@ void MessagesView::selectNextUnreadItem() {
     active_row = 0;
   }
 
-  const QModelIndex next_unread = m_proxyModel->getNextPreviousUnreadItemIndex(active_row);
+  // Unread message can be in rows which are not loaded yet,
+  // so previous messages are searched only after loading.
+  const QModelIndex next_unread = m_proxyModel->getNextPreviousUnreadItemIndex(active_row, !m_sourceModel->isLoading());
 
-  if (next_unread.isValid()) {
+  if (!next_unread.isValid() && m_sourceModel->isLoading()) {
+    m_selectNextUnreadWhenLoaded = true;
+  }
+  else if (next_unread.isValid()) {
     // We found unread message, mark it.
     setCurrentIndex(next_unread);
     selectionModel()->select(next_unread, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
@@ -570,6 +611,8 @@ void MessagesView::adjustColumns() {
     hideColumn(MSG_DB_CUSTOM_ID_INDEX);
     hideColumn(MSG_DB_CUSTOM_HASH_INDEX);
     hideColumn(MSG_DB_FEED_CUSTOM_ID_INDEX);
+    hideColumn(MSG_DB_IMAGES_INDEX);
+    hideColumn(MSG_DB_PREVIEW_INDEX);
   }
 }
 
@@ -35,6 +35,10 @@ class MessagesView : public QTreeView {
     // and it needs to be reloaded to the view.
     void reloadSelections();
 
+    // Refreshes titles of feeds displayed in message list after
+    // feeds were changed, e.g. renamed.
+    void reloadFeedTitles();
+
     // Loads un-deleted messages from selected feeds.
     void loadItem(RootItem* item);
 
@@ -65,6 +69,9 @@ class MessagesView : public QTreeView {
     // Marks given indexes as selected.
     void reselectIndexes(const QModelIndexList& indexes);
 
+    // Selects previously selected message once its row is loaded.
+    void reselectLoadedMessage(const QModelIndex& parent, int first, int last);
+
     // Changes resize mode for all columns.
     void adjustColumns();
 
@@ -103,6 +110,10 @@ class MessagesView : public QTreeView {
     MessagesProxyModel* m_proxyModel;
     MessagesModel* m_sourceModel;
     bool m_columnsAdjusted;
+
+    // ID of message which is selected again when its row is loaded.
+    int m_reselectedMessageId;
+    bool m_selectNextUnreadWhenLoaded;
 };
 
 #endif // MESSAGESVIEW_H
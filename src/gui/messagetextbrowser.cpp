@@ -4,17 +4,32 @@
 
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
+#include "network-web/networkdiskcache.h"
 #include "network-web/networkfactory.h"
 
+#include <QImage>
+
 MessageTextBrowser::MessageTextBrowser(QWidget* parent) : QTextBrowser(parent) {}
 
 MessageTextBrowser::~MessageTextBrowser() {}
 
 QVariant MessageTextBrowser::loadResource(int type, const QUrl& name) {
-  Q_UNUSED(name)
-
   switch (type) {
     case QTextDocument::ImageResource: {
+      // Show images which were already downloaded or prefetched.
+      const QByteArray cached_data = NetworkDiskCache::cachedData(name);
+      QImage image;
+
+      if (!cached_data.isEmpty() && image.loadFromData(cached_data)) {
+        const int max_width = viewport()->width() - 2 * document()->documentMargin();
+
+        if (max_width > 0 && image.width() > max_width) {
+          image = image.scaledToWidth(max_width, Qt::SmoothTransformation);
+        }
+
+        return image;
+      }
+
       if (m_imagePlaceholder.isNull()) {
         m_imagePlaceholder = qApp->icons()->miscPixmap(QSL("image-placeholder")).scaledToWidth(20, Qt::FastTransformation);
       }
@@ -21,6 +21,11 @@ SettingsDatabase::SettingsDatabase(Settings* settings, QWidget* parent)
   connect(m_ui->m_txtMysqlHostname->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_txtMysqlPassword->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_checkUseTransactions, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
+  connect(m_ui->m_gbAutoCleanup, &QGroupBox::toggled, this, &SettingsDatabase::dirtifySettings);
+  connect(m_ui->m_spinAutoCleanupOlderThan, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this,
+          &SettingsDatabase::dirtifySettings);
+  connect(m_ui->m_checkAutoCleanupReadMessages, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
+  connect(m_ui->m_checkAutoCleanupRecycleBin, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_txtMysqlUsername->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_spinMysqlPort, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_cmbDatabaseDriver, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
@@ -153,6 +158,13 @@ void SettingsDatabase::loadSettings() {
     m_ui->m_checkMysqlShowPassword->setChecked(false);
   }
 
+  // Load automatic cleanup.
+  m_ui->m_gbAutoCleanup->setChecked(settings()->value(GROUP(Database), SETTING(Database::AutoCleanupEnabled)).toBool());
+  m_ui->m_spinAutoCleanupOlderThan->setValue(settings()->value(GROUP(Database), SETTING(Database::AutoCleanupOlderThan)).toInt());
+  m_ui->m_checkAutoCleanupReadMessages->setChecked(settings()->value(GROUP(Database),
+                                                                     SETTING(Database::AutoCleanupReadMessages)).toBool());
+  m_ui->m_checkAutoCleanupRecycleBin->setChecked(settings()->value(GROUP(Database), SETTING(Database::AutoCleanupRecycleBin)).toBool());
+
   int index_current_backend = m_ui->m_cmbDatabaseDriver->findData(settings()->value(GROUP(Database),
                                                                                     SETTING(Database::ActiveDriver)).toString());
 
@@ -190,6 +202,12 @@ void SettingsDatabase::saveSettings() {
 
   settings()->setValue(GROUP(Database), Database::ActiveDriver, selected_db_driver);
 
+  // Save automatic cleanup.
+  settings()->setValue(GROUP(Database), Database::AutoCleanupEnabled, m_ui->m_gbAutoCleanup->isChecked());
+  settings()->setValue(GROUP(Database), Database::AutoCleanupOlderThan, m_ui->m_spinAutoCleanupOlderThan->value());
+  settings()->setValue(GROUP(Database), Database::AutoCleanupReadMessages, m_ui->m_checkAutoCleanupReadMessages->isChecked());
+  settings()->setValue(GROUP(Database), Database::AutoCleanupRecycleBin, m_ui->m_checkAutoCleanupRecycleBin->isChecked());
+
   if (original_db_driver != selected_db_driver || original_inmemory != new_inmemory) {
     requireRestart();
   }
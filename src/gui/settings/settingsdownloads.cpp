@@ -14,6 +14,12 @@ SettingsDownloads::SettingsDownloads(Settings* settings, QWidget* parent)
   connect(m_ui->m_checkOpenManagerWhenDownloadStarts, &QCheckBox::toggled, this, &SettingsDownloads::dirtifySettings);
   connect(m_ui->m_txtDownloadsTargetDirectory, &QLineEdit::textChanged, this, &SettingsDownloads::dirtifySettings);
   connect(m_ui->m_rbDownloadsAskEachFile, &QRadioButton::toggled, this, &SettingsDownloads::dirtifySettings);
+  connect(m_ui->m_spinMaxConcurrentDownloads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+          this, &SettingsDownloads::dirtifySettings);
+  connect(m_ui->m_spinMaxDownloadSpeed, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+          this, &SettingsDownloads::dirtifySettings);
+  connect(m_ui->m_spinDownloadSegments, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+          this, &SettingsDownloads::dirtifySettings);
   connect(m_ui->m_btnDownloadsTargetDirectory, &QPushButton::clicked, this, &SettingsDownloads::selectDownloadsDirectory);
 }
 
@@ -40,6 +46,9 @@ void SettingsDownloads::loadSettings() {
                                                                                           SETTING(Downloads::TargetDirectory)).toString()));
   m_ui->m_rbDownloadsAskEachFile->setChecked(settings()->value(GROUP(Downloads),
                                                                SETTING(Downloads::AlwaysPromptForFilename)).toBool());
+  m_ui->m_spinMaxConcurrentDownloads->setValue(settings()->value(GROUP(Downloads), SETTING(Downloads::MaxConcurrentDownloads)).toInt());
+  m_ui->m_spinMaxDownloadSpeed->setValue(settings()->value(GROUP(Downloads), SETTING(Downloads::MaxDownloadSpeed)).toInt());
+  m_ui->m_spinDownloadSegments->setValue(settings()->value(GROUP(Downloads), SETTING(Downloads::DownloadSegments)).toInt());
   onEndLoadSettings();
 }
 
@@ -49,6 +58,10 @@ void SettingsDownloads::saveSettings() {
                        m_ui->m_checkOpenManagerWhenDownloadStarts->isChecked());
   settings()->setValue(GROUP(Downloads), Downloads::TargetDirectory, m_ui->m_txtDownloadsTargetDirectory->text());
   settings()->setValue(GROUP(Downloads), Downloads::AlwaysPromptForFilename, m_ui->m_rbDownloadsAskEachFile->isChecked());
+  settings()->setValue(GROUP(Downloads), Downloads::MaxConcurrentDownloads, m_ui->m_spinMaxConcurrentDownloads->value());
+  settings()->setValue(GROUP(Downloads), Downloads::MaxDownloadSpeed, m_ui->m_spinMaxDownloadSpeed->value());
+  settings()->setValue(GROUP(Downloads), Downloads::DownloadSegments, m_ui->m_spinDownloadSegments->value());
   qApp->downloadManager()->setDownloadDirectory(m_ui->m_txtDownloadsTargetDirectory->text());
+  qApp->downloadManager()->loadSettings();
   onEndSaveSettings();
 }
@@ -7,15 +7,50 @@
 #include "gui/tabwidget.h"
 #include "gui/webbrowser.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/feedreader.h"
 #include "miscellaneous/skinfactory.h"
 #include "network-web/adblock/adblockicon.h"
 #include "network-web/adblock/adblockmanager.h"
+#include "network-web/enclosureprefetcher.h"
 #include "network-web/webfactory.h"
 #include "network-web/webpage.h"
 
 #include <QWebEngineContextMenuData>
 #include <QWheelEvent>
 
+// Appends layout with "%1" to "%99" placeholders replaced by arguments. Layout is
+// scanned only once, so placeholders are never looked up in inserted contents.
+static void appendLayout(QString& target, const QString& layout, const QStringList& arguments) {
+  const int length = layout.size();
+  int copied = 0;
+
+  for (int i = 0; i < length - 1; i++) {
+    if (layout.at(i) != QL1C('%') || !layout.at(i + 1).isDigit()) {
+      continue;
+    }
+
+    int argument = layout.at(i + 1).digitValue();
+    int placeholder_length = 2;
+
+    if (i + 2 < length && layout.at(i + 2).isDigit() &&
+        argument * 10 + layout.at(i + 2).digitValue() <= arguments.size()) {
+      argument = argument * 10 + layout.at(i + 2).digitValue();
+      placeholder_length = 3;
+    }
+
+    if (argument < 1 || argument > arguments.size()) {
+      continue;
+    }
+
+    target.append(layout.midRef(copied, i - copied));
+    target.append(arguments.at(argument - 1));
+    copied = i + placeholder_length;
+    i = copied - 1;
+  }
+
+  target.append(layout.midRef(copied));
+}
+
 WebViewer::WebViewer(QWidget* parent) : QWebEngineView(parent), m_root(nullptr) {
   WebPage* page = new WebPage(this);
 
@@ -75,6 +110,7 @@ void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root) {
   Skin skin = qApp->skins()->currentSkin();
   QString messages_layout;
   QString single_message_layout = skin.m_layoutMarkup;
+  const QString image_height = QString::number(qApp->settings()->snapshot().m_messageHeadImageHeight);
 
   foreach (const Message& message, messages) {
     QString enclosures;
@@ -82,8 +118,14 @@ void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root) {
 
     foreach (const Enclosure& enclosure, message.m_enclosures) {
       QString enc_url;
+      const QString local_file = qApp->feedReader()->enclosurePrefetcher()->localFile(enclosure.m_url);
 
-      if (!enclosure.m_url.contains(QRegularExpression(QSL("^(http|ftp|\\/)")))) {
+      if (!local_file.isEmpty()) {
+        // Enclosure was downloaded in advance.
+        enc_url = QUrl::fromLocalFile(local_file).toString();
+      }
+      else if (!enclosure.m_url.startsWith(QL1S("http")) && !enclosure.m_url.startsWith(QL1S("ftp")) &&
+               !enclosure.m_url.startsWith(QL1C('/'))) {
         enc_url = QString(INTERNAL_URL_PASSATTACHMENT) + QL1S("/?") + enclosure.m_url;
       }
       else {
@@ -98,23 +140,23 @@ void WebViewer::loadMessages(const QList<Message>& messages, RootItem* root) {
         enclosure_images += skin.m_enclosureImageMarkup.arg(
           enclosure.m_url,
           enclosure.m_mimeType,
-          qApp->settings()->value(GROUP(Messages), SETTING(Messages::MessageHeadImageHeight)).toString());
+          image_height);
       }
     }
 
-    messages_layout.append(single_message_layout
-                           .arg(message.m_title,
-                                tr("Written by ") + (message.m_author.isEmpty() ?
-                                                     tr("unknown author") :
-                                                     message.m_author),
-                                message.m_url,
-                                message.m_contents,
-                                message.m_created.toString(Qt::DefaultLocaleShortDate),
-                                enclosures,
-                                message.m_isRead ? "mark-unread" : "mark-read",
-                                message.m_isImportant ? "mark-unstarred" : "mark-starred",
-                                QString::number(message.m_id))
-                           .arg(enclosure_images));
+    appendLayout(messages_layout, single_message_layout,
+                 QStringList() << message.m_title
+                               << tr("Written by ") + (message.m_author.isEmpty() ?
+                                                       tr("unknown author") :
+                                                       message.m_author)
+                               << message.m_url
+                               << message.m_contents
+                               << message.m_created.toString(Qt::DefaultLocaleShortDate)
+                               << enclosures
+                               << (message.m_isRead ? QSL("mark-unread") : QSL("mark-read"))
+                               << (message.m_isImportant ? QSL("mark-unstarred") : QSL("mark-starred"))
+                               << QString::number(message.m_id)
+                               << enclosure_images);
   }
 
   m_root = root;
@@ -60,6 +60,11 @@ Application::Application(const QString& id, int& argc, char** argv)
   m_urlInterceptor->loadSettings();
   QWebEngineProfile::defaultProfile()->installUrlSchemeHandler(QByteArray(APP_LOW_NAME),
                                                                new RssGuardSchemeHandler(QWebEngineProfile::defaultProfile()));
+
+  // Web engine keeps its own disk cache, keep it bounded and next to other user data.
+  QWebEngineProfile::defaultProfile()->setCachePath(userDataFolder() + QDir::separator() + WEB_CACHE_SUBDIRECTORY);
+  QWebEngineProfile::defaultProfile()->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+  QWebEngineProfile::defaultProfile()->setHttpCacheMaximumSize(NETWORK_CACHE_MAX_SIZE);
 #endif
 }
 
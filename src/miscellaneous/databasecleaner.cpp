@@ -2,81 +2,167 @@
 
 #include "miscellaneous/databasecleaner.h"
 
+#include "definitions/definitions.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasequeries.h"
 
+#include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QThread>
 
-DatabaseCleaner::DatabaseCleaner(QObject* parent) : QObject(parent) {}
+DatabaseCleaner::DatabaseCleaner(QObject* parent) : QObject(parent), m_running(0), m_cancelled(0) {}
 
 DatabaseCleaner::~DatabaseCleaner() {}
 
+bool DatabaseCleaner::isRunning() const {
+  return m_running.load() != 0;
+}
+
+void DatabaseCleaner::cancel() {
+  if (isRunning()) {
+    qDebug("Cancelling running database cleanup.");
+    m_cancelled.store(1);
+  }
+}
+
 void DatabaseCleaner::purgeDatabaseData(const CleanerOrders& which_data) {
   qDebug().nospace() << "Performing database cleanup in thread: \'" << QThread::currentThreadId() << "\'.";
 
+  m_running.store(1);
+  m_cancelled.store(0);
+
   // Inform everyone about the start of the process.
   emit purgeStarted();
-  bool result = true;
-  const int difference = 99 / 8;
-  int progress = 0;
+  QElapsedTimer timer;
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  QList<PurgeStep> steps;
+  bool result = true;
+  int total = 0;
+  int purged = 0;
 
-  if (which_data.m_removeReadMessages) {
-    progress += difference;
-    emit purgeProgress(progress, tr("Removing read messages..."));
+  timer.start();
 
-    // Remove read messages.
-    result &= purgeReadMessages(database);
-    progress += difference;
-    emit purgeProgress(progress, tr("Read messages purged..."));
+  // NOTE: Starred messages are kept by all other steps.
+  if (which_data.m_removeReadMessages) {
+    steps.append(PurgeStep {tr("Removing read messages"),
+                            QSL("is_important = 0 AND is_deleted = 0 AND is_read = 1"), QVariantHash(), 0});
   }
 
   if (which_data.m_removeRecycleBin) {
-    progress += difference;
-    emit purgeProgress(progress, tr("Purging recycle bin..."));
-
-    // Remove read messages.
-    result &= purgeRecycleBin(database);
-    progress += difference;
-    emit purgeProgress(progress, tr("Recycle bin purged..."));
+    steps.append(PurgeStep {tr("Purging recycle bin"), QSL("is_important = 0 AND is_deleted = 1"), QVariantHash(), 0});
   }
 
   if (which_data.m_removeOldMessages) {
-    progress += difference;
-    emit purgeProgress(progress, tr("Removing old messages..."));
+    QVariantHash values;
+
+    values.insert(QSL(":date_created"),
+                  QDateTime::currentDateTimeUtc().addDays(-which_data.m_barrierForRemovingOldMessagesInDays).toMSecsSinceEpoch());
+    steps.append(PurgeStep {tr("Removing old messages"), QSL("is_important = 0 AND date_created < :date_created"), values, 0});
+  }
 
-    // Remove old messages.
-    result &= purgeOldMessages(database, which_data.m_barrierForRemovingOldMessagesInDays);
-    progress += difference;
-    emit purgeProgress(progress, tr("Old messages purged..."));
+  if (which_data.m_removeStarredMessages) {
+    steps.append(PurgeStep {tr("Removing starred messages"), QSL("is_important = 1"), QVariantHash(), 0});
   }
 
-  if (which_data.m_shrinkDatabase) {
-    progress += difference;
-    emit purgeProgress(progress, tr("Shrinking database file..."));
+  // Messages are counted first, so that progress reflects real amount of work.
+  emit purgeProgress(0, tr("Counting messages to remove..."));
+
+  for (PurgeStep& step : steps) {
+    bool ok;
 
-    // Call driver-specific vacuuming function.
-    result &= qApp->database()->vacuumDatabase();
-    progress += difference;
-    emit purgeProgress(progress, tr("Database file shrinked..."));
+    step.m_count = DatabaseQueries::getMessagesCountForPurge(database, step.m_condition, step.m_values, &ok);
+    total += step.m_count;
+    result &= ok;
   }
 
-  emit purgeFinished(result);
-}
+  const int rows_progress = which_data.m_shrinkDatabase ? 90 : 99;
+
+  foreach (const PurgeStep& step, steps) {
+    if (isCancelled()) {
+      break;
+    }
 
-bool DatabaseCleaner::purgeStarredMessages(const QSqlDatabase& database) {
-  return DatabaseQueries::purgeImportantMessages(database);
+    result &= purgeMessages(database, step, &purged, total, rows_progress);
+  }
+
+  if (which_data.m_shrinkDatabase && !isCancelled()) {
+    result &= shrinkDatabase(rows_progress);
+  }
+
+  qDebug("Database cleanup removed %d of %d messages in %lld ms%s.",
+         purged, total, timer.elapsed(), isCancelled() ? " (cancelled)" : "");
+
+  const bool finished = result && !isCancelled();
+
+  m_running.store(0);
+  emit purgeFinished(finished);
 }
 
-bool DatabaseCleaner::purgeReadMessages(const QSqlDatabase& database) {
-  return DatabaseQueries::purgeReadMessages(database);
+bool DatabaseCleaner::isCancelled() const {
+  return m_cancelled.load() != 0;
 }
 
-bool DatabaseCleaner::purgeOldMessages(const QSqlDatabase& database, int days) {
-  return DatabaseQueries::purgeOldMessages(database, days);
+bool DatabaseCleaner::purgeMessages(const QSqlDatabase& database, const PurgeStep& step, int* purged, int total, int max_progress) {
+  int last_id = 0;
+
+  emit purgeProgress(total > 0 ? int(qint64(*purged) * max_progress / total) : 0, step.m_description + QSL("..."));
+
+  forever {
+    bool ok;
+    const int previous_last_id = last_id;
+    const int removed = DatabaseQueries::purgeMessagesBatch(database, step.m_condition, step.m_values,
+                                                            APP_DB_CLEANUP_BATCH_SIZE, &last_id, &ok);
+
+    if (!ok) {
+      qWarning("Removing batch of messages after ID %d failed.", previous_last_id);
+      return false;
+    }
+    else if (last_id == previous_last_id) {
+      return true;
+    }
+
+    *purged += removed;
+    emit purgeProgress(total > 0 ? int(qint64(qMin(*purged, total)) * max_progress / total) : max_progress,
+                       tr("%1 (%2 of %3 messages removed)...").arg(step.m_description,
+                                                                   QString::number(*purged),
+                                                                   QString::number(total)));
+
+    if (isCancelled()) {
+      return true;
+    }
+
+    // Give feed updates and GUI a chance to write in between batches.
+    QThread::msleep(APP_DB_CLEANUP_BATCH_PAUSE);
+  }
 }
 
-bool DatabaseCleaner::purgeRecycleBin(const QSqlDatabase& database) {
-  return DatabaseQueries::purgeRecycleBin(database);
+bool DatabaseCleaner::shrinkDatabase(int min_progress) {
+  emit purgeProgress(min_progress, tr("Shrinking database file..."));
+
+  const int free_pages = qApp->database()->incrementalVacuumPagesCount();
+
+  if (free_pages < 0) {
+    // Call driver-specific vacuuming function, this rebuilds whole database.
+    const bool result = qApp->database()->vacuumDatabase();
+
+    emit purgeProgress(99, tr("Database file shrinked..."));
+    return result;
+  }
+
+  int released_pages = 0;
+
+  while (released_pages < free_pages && !isCancelled()) {
+    if (!qApp->database()->incrementalVacuumDatabase(APP_DB_CLEANUP_VACUUM_PAGES)) {
+      return false;
+    }
+
+    released_pages = qMin(released_pages + APP_DB_CLEANUP_VACUUM_PAGES, free_pages);
+    emit purgeProgress(min_progress + (99 - min_progress) * released_pages / free_pages,
+                       tr("Shrinking database file (%1 of %2 pages released)...").arg(QString::number(released_pages),
+                                                                                      QString::number(free_pages)));
+    QThread::msleep(APP_DB_CLEANUP_BATCH_PAUSE);
+  }
+
+  return true;
 }
@@ -5,7 +5,9 @@
 
 #include <QObject>
 
+#include <QAtomicInt>
 #include <QSqlDatabase>
+#include <QVariantHash>
 
 struct CleanerOrders {
   bool m_removeReadMessages;
@@ -25,6 +27,13 @@ class DatabaseCleaner : public QObject {
     explicit DatabaseCleaner(QObject* parent = 0);
     virtual ~DatabaseCleaner();
 
+    // True if cleanup is running right now.
+    bool isRunning() const;
+
+    // Stops running cleanup after current batch of messages.
+    // NOTE: This is thread-safe.
+    void cancel();
+
   signals:
     void purgeStarted();
     void purgeProgress(int progress, const QString& description);
@@ -34,10 +43,22 @@ class DatabaseCleaner : public QObject {
     void purgeDatabaseData(const CleanerOrders& which_data);
 
   private:
-    bool purgeStarredMessages(const QSqlDatabase& database);
-    bool purgeReadMessages(const QSqlDatabase& database);
-    bool purgeOldMessages(const QSqlDatabase& database, int days);
-    bool purgeRecycleBin(const QSqlDatabase& database);
+    struct PurgeStep {
+      QString m_description;
+      QString m_condition;
+      QVariantHash m_values;
+      int m_count;
+    };
+
+    bool isCancelled() const;
+
+    // Removes messages of given step batch by batch, so that other writers
+    // are never blocked for long time.
+    bool purgeMessages(const QSqlDatabase& database, const PurgeStep& step, int* purged, int total, int max_progress);
+    bool shrinkDatabase(int min_progress);
+
+    QAtomicInt m_running;
+    QAtomicInt m_cancelled;
 };
 
 #endif // DATABASECLEANER_H
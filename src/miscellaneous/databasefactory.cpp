@@ -8,20 +8,80 @@
 #include "miscellaneous/textfactory.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QThread>
+#include <QThreadStorage>
+#include <QTimer>
 #include <QVariant>
 
+// Pooled connection of one thread together with its cached statements.
+// It is destroyed when its thread exits, which also removes the connection.
+class DatabaseThreadData {
+  public:
+    explicit DatabaseThreadData(const QString& connection_name) : m_connectionName(connection_name) {}
+
+    ~DatabaseThreadData() {
+      // Cached queries must go away before their connection.
+      m_statements.clear();
+      QSqlDatabase::removeDatabase(m_connectionName);
+
+      if (QSqlDatabase::contains(readOnlyConnectionName())) {
+        QSqlDatabase::removeDatabase(readOnlyConnectionName());
+      }
+    }
+
+    QString readOnlyConnectionName() const {
+      return m_connectionName + QSL("_ro");
+    }
+
+    QString m_connectionName;
+
+    // Prepared statements of all connections used in the thread, keyed by
+    // connection name and SQL text.
+    QHash<QString, QHash<QString, QSqlQuery>> m_statements;
+};
+
+static QThreadStorage<DatabaseThreadData*> s_threadData;
+
+static DatabaseThreadData* threadData() {
+  if (!s_threadData.hasLocalData()) {
+    s_threadData.setLocalData(new DatabaseThreadData(QSL("db_thread_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()),
+                                                                              0, 16)));
+  }
+
+  return s_threadData.localData();
+}
+
 DatabaseFactory::DatabaseFactory(QObject* parent)
   : QObject(parent),
+  m_writeMutex(QMutex::Recursive),
+  m_writeCount(0),
+  m_contendedWriteCount(0),
+  m_writeWaitTime(0),
+  m_checkpointTimer(new QTimer(this)),
+  m_lastSeenWriteCount(0),
+  m_lastCheckpointWriteCount(0),
   m_mysqlDatabaseInitialized(false),
   m_sqliteFileBasedDatabaseinitialized(false),
   m_sqliteInMemoryDatabaseInitialized(false) {
   setObjectName(QSL("DatabaseFactory"));
   determineDriver();
+
+  m_checkpointTimer->setInterval(APP_DB_CHECKPOINT_INTERVAL);
+  connect(m_checkpointTimer, &QTimer::timeout, this, &DatabaseFactory::checkpointIdleDatabase);
+
+  if (m_activeDatabaseDriver == SQLITE) {
+    m_checkpointTimer->start();
+  }
 }
 
-DatabaseFactory::~DatabaseFactory() {}
+DatabaseFactory::~DatabaseFactory() {
+  qDebug("Database writers waited for lock in %d of %d writes, %lld ms in total.",
+         m_contendedWriteCount, m_writeCount, m_writeWaitTime);
+}
 
 qint64 DatabaseFactory::getDatabaseFileSize() const {
   if (m_activeDatabaseDriver == SQLITE || m_activeDatabaseDriver == SQLITE_MEMORY) {
@@ -161,7 +221,12 @@ void DatabaseFactory::finishRestoration() {
   if (QFile::exists(backup_database_file)) {
     qWarning("Backup database file '%s' was detected. Restoring it.", qPrintable(QDir::toNativeSeparators(backup_database_file)));
 
-    if (IOFactory::copyFile(backup_database_file, m_sqliteDatabaseFilePath + QDir::separator() + APP_DB_SQLITE_FILE)) {
+    const QString database_file = m_sqliteDatabaseFilePath + QDir::separator() + APP_DB_SQLITE_FILE;
+
+    if (IOFactory::copyFile(backup_database_file, database_file)) {
+      // WAL file of the old database must not be applied to restored one.
+      QFile::remove(database_file + APP_DB_SQLITE_WAL_SUFFIX);
+      QFile::remove(database_file + APP_DB_SQLITE_SHM_SUFFIX);
       QFile::remove(backup_database_file);
       qDebug("Database file was restored successully.");
     }
@@ -171,6 +236,32 @@ void DatabaseFactory::finishRestoration() {
   }
 }
 
+void DatabaseFactory::sqliteSetupConnection(const QSqlDatabase& database) {
+  QSqlQuery query_db(database);
+
+  query_db.setForwardOnly(true);
+
+  // NORMAL is safe in WAL mode, only the very last transactions
+  // can be lost after power failure.
+  query_db.exec(QSL("PRAGMA synchronous = NORMAL"));
+  query_db.exec(QSL("PRAGMA cache_size = 16384"));
+  query_db.exec(QSL("PRAGMA count_changes = OFF"));
+  query_db.exec(QSL("PRAGMA temp_store = MEMORY"));
+}
+
+void DatabaseFactory::sqliteCheckpointDatabase() {
+  if (!m_sqliteFileBasedDatabaseinitialized) {
+    return;
+  }
+
+  DatabaseWriteLocker locker(this);
+  QSqlQuery query(connection(objectName()));
+
+  if (!query.exec(QSL("PRAGMA wal_checkpoint(TRUNCATE)")) || !query.next() || query.value(0).toInt() != 0) {
+    qWarning("Checkpoint of SQLite database was not completed, some readers are still active.");
+  }
+}
+
 void DatabaseFactory::sqliteAssemblyDatabaseFilePath() {
   m_sqliteDatabaseFilePath = qApp->userDataFolder() + QDir::separator() + QString(APP_DB_SQLITE_PATH);
 }
@@ -299,12 +390,22 @@ QSqlDatabase DatabaseFactory::sqliteInitializeFileBasedDatabase(const QString& c
 
     query_db.setForwardOnly(true);
     query_db.exec(QSL("PRAGMA encoding = \"UTF-8\""));
-    query_db.exec(QSL("PRAGMA synchronous = OFF"));
-    query_db.exec(QSL("PRAGMA journal_mode = MEMORY"));
     query_db.exec(QSL("PRAGMA page_size = 4096"));
-    query_db.exec(QSL("PRAGMA cache_size = 16384"));
-    query_db.exec(QSL("PRAGMA count_changes = OFF"));
-    query_db.exec(QSL("PRAGMA temp_store = MEMORY"));
+
+    // New databases are created with incremental auto-vacuum, existing ones are
+    // converted by the next full vacuum. Cleanup can then release free pages
+    // in small steps instead of rewriting the whole file.
+    query_db.exec(QSL("PRAGMA auto_vacuum = INCREMENTAL"));
+
+    // Journal mode is persistent, it is enough to set it once. With WAL,
+    // readers do not block the writer and the writer does not block readers.
+    if (!query_db.exec(QSL("PRAGMA journal_mode = WAL")) || !query_db.next() ||
+        query_db.value(0).toString().compare(QSL("wal"), Qt::CaseInsensitive) != 0) {
+      qWarning("SQLite database could not be switched to WAL journal mode.");
+    }
+
+    query_db.finish();
+    sqliteSetupConnection(database);
 
     // Sample query which checks for existence of tables.
     if (!query_db.exec(QSL("SELECT inf_value FROM Information WHERE inf_key = 'schema_version'"))) {
@@ -375,6 +476,9 @@ bool DatabaseFactory::sqliteUpdateDatabaseSchema(QSqlDatabase database, const QS
   const int current_version = QString(APP_DB_SCHEMA_VERSION).remove('.').toInt();
 
   // Now, it would be good to create backup of SQLite DB file.
+  // All data must be in the main file before we copy it.
+  database.exec(QSL("PRAGMA wal_checkpoint(TRUNCATE)"));
+
   if (IOFactory::copyFile(sqliteDatabaseFilePath(), sqliteDatabaseFilePath() + ".bak")) {
     qDebug("Creating backup of SQLite DB file.");
   }
@@ -455,15 +559,164 @@ bool DatabaseFactory::mysqlUpdateDatabaseSchema(QSqlDatabase database, const QSt
 }
 
 QSqlDatabase DatabaseFactory::connection(const QString& connection_name, DesiredType desired_type) {
+  Q_UNUSED(connection_name)
+
+  const QString thread_connection_name = threadConnectionName();
+
+  if (QSqlDatabase::contains(thread_connection_name) &&
+      !isOwnedByCurrentThread(QSqlDatabase::database(thread_connection_name, false))) {
+    // Connection was left behind by some finished thread, which
+    // had the same address as the calling one.
+    qWarning("Database connection '%s' belongs to another thread, recreating it.", qPrintable(thread_connection_name));
+    QSqlDatabase::removeDatabase(thread_connection_name);
+  }
+
   switch (m_activeDatabaseDriver) {
     case MYSQL:
-      return mysqlConnection(connection_name);
+      return mysqlConnection(thread_connection_name);
 
     case SQLITE:
     case SQLITE_MEMORY:
     default:
-      return sqliteConnection(connection_name, desired_type);
+      return sqliteConnection(thread_connection_name, desired_type);
+  }
+}
+
+QSqlQuery DatabaseFactory::preparedQuery(const QSqlDatabase& database, const QString& sql) {
+  if (!isOwnedByCurrentThread(database)) {
+    // Default in-memory connection is shared by all threads,
+    // its statements cannot be cached.
+    QSqlQuery query(database);
+
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    return query;
+  }
+
+  QHash<QString, QSqlQuery>& statements = threadData()->m_statements[database.connectionName()];
+  QHash<QString, QSqlQuery>::iterator statement = statements.find(sql);
+
+  if (statement == statements.end()) {
+    QSqlQuery query(database);
+
+    query.setForwardOnly(true);
+
+    if (!query.prepare(sql)) {
+      qWarning("Preparation of SQL statement failed: '%s'.", qPrintable(query.lastError().text()));
+      return query;
+    }
+
+    statement = statements.insert(sql, query);
+  }
+  else {
+    // Make sure that statement does not hold any
+    // results from its previous use.
+    statement.value().finish();
+  }
+
+  return statement.value();
+}
+
+QString DatabaseFactory::threadConnectionName() const {
+  return threadData()->m_connectionName;
+}
+
+bool DatabaseFactory::isOwnedByCurrentThread(const QSqlDatabase& database) const {
+  return database.isValid() && database.driver()->thread() == QThread::currentThread();
+}
+
+QSqlDatabase DatabaseFactory::readOnlyConnection(const QString& connection_name) {
+  if (m_activeDatabaseDriver != SQLITE) {
+    return connection(connection_name);
+  }
+
+  // Make sure that database file is initialized.
+  const QSqlDatabase standard_database = connection(connection_name);
+  const QString read_only_name = threadData()->readOnlyConnectionName();
+  QSqlDatabase database;
+
+  if (QSqlDatabase::contains(read_only_name)) {
+    database = QSqlDatabase::database(read_only_name);
+  }
+  else {
+    database = QSqlDatabase::addDatabase(APP_DB_SQLITE_DRIVER, read_only_name);
+    database.setDatabaseName(standard_database.databaseName());
+    database.setConnectOptions(QSL("QSQLITE_OPEN_READONLY"));
+  }
+
+  if (!database.isOpen()) {
+    if (database.open()) {
+      sqliteSetupConnection(database);
+    }
+    else {
+      qWarning("Read-only SQLite connection was NOT opened, using standard one. Delivered error message: '%s'.",
+               qPrintable(database.lastError().text()));
+      return standard_database;
+    }
+  }
+
+  return database;
+}
+
+void DatabaseFactory::lockForWriting() {
+  if (m_writeMutex.tryLock()) {
+    m_writeCount++;
+    return;
+  }
+
+  QElapsedTimer tmr;
+
+  tmr.start();
+  m_writeMutex.lock();
+
+  const qint64 waited = tmr.elapsed();
+
+  m_writeCount++;
+  m_contendedWriteCount++;
+  m_writeWaitTime += waited;
+
+  if (waited >= APP_DB_WRITE_WAIT_REPORT) {
+    qDebug("Database writer waited %lld ms for lock (%d of %d writes waited, %lld ms in total).",
+           waited, m_contendedWriteCount, m_writeCount, m_writeWaitTime);
+  }
+}
+
+void DatabaseFactory::unlockForWriting() {
+  m_writeMutex.unlock();
+}
+
+void DatabaseFactory::checkpointIdleDatabase() {
+  if (!m_sqliteFileBasedDatabaseinitialized || !m_writeMutex.tryLock()) {
+    // Somebody is writing right now, so database is not idle.
+    return;
+  }
+
+  // Database is idle if there were no writes during last interval
+  // but there were some since last checkpoint.
+  const bool idle = m_writeCount == m_lastSeenWriteCount && m_writeCount != m_lastCheckpointWriteCount;
+
+  m_lastSeenWriteCount = m_writeCount;
+
+  if (idle) {
+    QSqlQuery query(connection(objectName()));
+
+    if (query.exec(QSL("PRAGMA wal_checkpoint(PASSIVE)")) && query.next()) {
+      qDebug("Passive checkpoint of SQLite database moved %d of %d WAL frames.",
+             query.value(2).toInt(), query.value(1).toInt());
+    }
+
+    m_lastCheckpointWriteCount = m_writeCount;
   }
+
+  m_writeMutex.unlock();
+}
+
+DatabaseWriteLocker::DatabaseWriteLocker(DatabaseFactory* factory) : m_factory(factory) {
+  m_factory->lockForWriting();
+}
+
+DatabaseWriteLocker::~DatabaseWriteLocker() {
+  m_factory->unlockForWriting();
 }
 
 QString DatabaseFactory::humanDriverName(DatabaseFactory::UsedDriver driver) const {
@@ -731,6 +984,7 @@ QSqlDatabase DatabaseFactory::sqliteConnection(const QString& connection_name, D
     }
     else {
       QSqlDatabase database;
+      bool new_connection = false;
 
       if (QSqlDatabase::contains(connection_name)) {
         qDebug("SQLite connection '%s' is already active.", qPrintable(connection_name));
@@ -748,6 +1002,7 @@ QSqlDatabase DatabaseFactory::sqliteConnection(const QString& connection_name, D
 
         // Setup database file path.
         database.setDatabaseName(db_file.fileName());
+        new_connection = true;
       }
 
       if (!database.isOpen() && !database.open()) {
@@ -755,6 +1010,10 @@ QSqlDatabase DatabaseFactory::sqliteConnection(const QString& connection_name, D
                qPrintable(database.lastError().text()));
       }
       else {
+        if (new_connection) {
+          sqliteSetupConnection(database);
+        }
+
         qDebug("File-based SQLite database connection '%s' to file '%s' seems to be established.",
                qPrintable(connection_name),
                qPrintable(QDir::toNativeSeparators(database.databaseName())));
@@ -779,6 +1038,7 @@ bool DatabaseFactory::sqliteVacuumDatabase() {
     return false;
   }
 
+  DatabaseWriteLocker locker(this);
   QSqlQuery query_vacuum(database);
 
   return query_vacuum.exec(QSL("VACUUM"));
@@ -790,6 +1050,10 @@ void DatabaseFactory::saveDatabase() {
       sqliteSaveMemoryDatabase();
       break;
 
+    case SQLITE:
+      sqliteCheckpointDatabase();
+      break;
+
     default:
       break;
   }
@@ -808,3 +1072,41 @@ bool DatabaseFactory::vacuumDatabase() {
       return false;
   }
 }
+
+int DatabaseFactory::incrementalVacuumPagesCount() {
+  if (m_activeDatabaseDriver != SQLITE) {
+    return -1;
+  }
+
+  QSqlQuery query(connection(objectName(), StrictlyFileBased));
+
+  // Value 2 means INCREMENTAL.
+  if (!query.exec(QSL("PRAGMA auto_vacuum")) || !query.next() || query.value(0).toInt() != 2) {
+    return -1;
+  }
+
+  if (!query.exec(QSL("PRAGMA freelist_count")) || !query.next()) {
+    return -1;
+  }
+
+  return query.value(0).toInt();
+}
+
+bool DatabaseFactory::incrementalVacuumDatabase(int max_pages) {
+  if (m_activeDatabaseDriver != SQLITE) {
+    return false;
+  }
+
+  DatabaseWriteLocker locker(this);
+  QSqlQuery query(connection(objectName(), StrictlyFileBased));
+
+  if (!query.exec(QSL("PRAGMA incremental_vacuum(%1)").arg(max_pages))) {
+    qWarning("Incremental vacuum failed: '%s'.", qPrintable(query.lastError().text()));
+    return false;
+  }
+
+  // SQLite releases pages while the statement is being stepped through.
+  while (query.next()) {}
+
+  return true;
+}
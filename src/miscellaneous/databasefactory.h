@@ -3,8 +3,12 @@
 #ifndef DATABASEFACTORY_H
 #define DATABASEFACTORY_H
 
+#include <QMutex>
 #include <QObject>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+
+class QTimer;
 
 class DatabaseFactory : public QObject {
   Q_OBJECT
@@ -54,9 +58,21 @@ class DatabaseFactory : public QObject {
 
     // If in-memory is true, then :memory: database is returned
     // In-memory database is DEFAULT database.
+    // Connections are pooled, each thread gets its own connection,
+    // given name is used only to identify the caller.
     // NOTE: This always returns OPENED database.
     QSqlDatabase connection(const QString& connection_name, DesiredType desired_type = FromSettings);
 
+    // Returns read-only connection dedicated to calling thread. With file-based SQLite,
+    // readers work on consistent snapshot of data and never block the writer.
+    // NOTE: Other backends just return standard connection.
+    QSqlDatabase readOnlyConnection(const QString& connection_name);
+
+    // Returns query prepared for given SQL statement. Statements are cached
+    // per connection, so each of them is parsed only once per thread.
+    // NOTE: Call finish() on returned query once you are done with its results.
+    QSqlQuery preparedQuery(const QSqlDatabase& database, const QString& sql);
+
     QString humanDriverName(UsedDriver driver) const;
     QString humanDriverName(const QString& driver_code) const;
 
@@ -72,6 +88,13 @@ class DatabaseFactory : public QObject {
     // Performs cleanup of the database.
     bool vacuumDatabase();
 
+    // Returns number of free pages which can be released by incremental
+    // vacuum or -1 if active database does not support incremental vacuum.
+    int incrementalVacuumPagesCount();
+
+    // Releases at most given number of free pages back to file system.
+    bool incrementalVacuumDatabase(int max_pages);
+
     // Returns identification of currently active database driver.
     UsedDriver activeDatabaseDriver() const;
 
@@ -99,7 +122,17 @@ class DatabaseFactory : public QObject {
     // Interprets MySQL error code.
     QString mysqlInterpretErrorCode(MySQLError error_code) const;
 
+  private slots:
+
+    // Runs passive checkpoint of WAL file if nobody wrote to the database recently.
+    void checkpointIdleDatabase();
+
   private:
+    friend class DatabaseWriteLocker;
+
+    // Serializes all writers of the database.
+    void lockForWriting();
+    void unlockForWriting();
 
     //
     // GENERAL stuff.
@@ -109,9 +142,26 @@ class DatabaseFactory : public QObject {
     // application session.
     void determineDriver();
 
+    // Returns name of connection dedicated to calling thread.
+    QString threadConnectionName() const;
+
+    // Returns true if connection was created in calling thread.
+    bool isOwnedByCurrentThread(const QSqlDatabase& database) const;
+
     // Holds the type of currently activated database backend.
     UsedDriver m_activeDatabaseDriver;
 
+    // Writer lock and statistics of waiting for it. Statistics
+    // are only touched while the lock is held.
+    QMutex m_writeMutex;
+    int m_writeCount;
+    int m_contendedWriteCount;
+    qint64 m_writeWaitTime;
+
+    QTimer* m_checkpointTimer;
+    int m_lastSeenWriteCount;
+    int m_lastCheckpointWriteCount;
+
     //
     // MYSQL stuff.
     //
@@ -138,6 +188,13 @@ class DatabaseFactory : public QObject {
 
     QSqlDatabase sqliteConnection(const QString& connection_name, DesiredType desired_type);
 
+    // Applies per-connection settings to newly opened connection.
+    void sqliteSetupConnection(const QSqlDatabase& database);
+
+    // Moves all contents of WAL file into main database file, so that the file
+    // can be copied.
+    void sqliteCheckpointDatabase();
+
     // Runs "VACUUM" on the database.
     bool sqliteVacuumDatabase();
 
@@ -164,4 +221,17 @@ class DatabaseFactory : public QObject {
     bool m_sqliteInMemoryDatabaseInitialized;
 };
 
+// Holds database writer lock for its lifetime. All mutating
+// queries should run while some instance of this class lives.
+class DatabaseWriteLocker {
+  public:
+    explicit DatabaseWriteLocker(DatabaseFactory* factory);
+    ~DatabaseWriteLocker();
+
+  private:
+    Q_DISABLE_COPY(DatabaseWriteLocker)
+
+    DatabaseFactory* m_factory;
+};
+
 #endif // DATABASEFACTORY_H
@@ -2,6 +2,7 @@
 
 #include "miscellaneous/databasequeries.h"
 
+#include "core/messagecontentprocessor.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/textfactory.h"
@@ -31,6 +32,7 @@
 #include <QVariant>
 
 bool DatabaseQueries::markMessagesReadUnread(QSqlDatabase db, const QStringList& ids, RootItem::ReadStatus read) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -39,14 +41,8 @@ bool DatabaseQueries::markMessagesReadUnread(QSqlDatabase db, const QStringList&
 }
 
 bool DatabaseQueries::markMessageImportant(QSqlDatabase db, int id, RootItem::Importance importance) {
-  QSqlQuery q(db);
-
-  q.setForwardOnly(true);
-
-  if (!q.prepare(QSL("UPDATE Messages SET is_important = :important WHERE id = :id;"))) {
-    qWarning("Query preparation failed for message importance switch.");
-    return false;
-  }
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET is_important = :important WHERE id = :id;"));
 
   q.bindValue(QSL(":id"), id);
   q.bindValue(QSL(":important"), (int) importance);
@@ -56,6 +52,7 @@ bool DatabaseQueries::markMessageImportant(QSqlDatabase db, int id, RootItem::Im
 }
 
 bool DatabaseQueries::markFeedsReadUnread(QSqlDatabase db, const QStringList& ids, int account_id, RootItem::ReadStatus read) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -67,27 +64,26 @@ bool DatabaseQueries::markFeedsReadUnread(QSqlDatabase db, const QStringList& id
 }
 
 bool DatabaseQueries::markBinReadUnread(QSqlDatabase db, int account_id, RootItem::ReadStatus read) {
-  QSqlQuery q(db);
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET is_read = :read "
+                                                        "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;"));
 
-  q.setForwardOnly(true);
-  q.prepare("UPDATE Messages SET is_read = :read "
-            "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
   q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
   q.bindValue(QSL(":account_id"), account_id);
   return q.exec();
 }
 
 bool DatabaseQueries::markAccountReadUnread(QSqlDatabase db, int account_id, RootItem::ReadStatus read) {
-  QSqlQuery q(db);
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET is_read = :read WHERE is_pdeleted = 0 AND account_id = :account_id;"));
 
-  q.setForwardOnly(true);
-  q.prepare(QSL("UPDATE Messages SET is_read = :read WHERE is_pdeleted = 0 AND account_id = :account_id;"));
   q.bindValue(QSL(":account_id"), account_id);
   q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
   return q.exec();
 }
 
 bool DatabaseQueries::switchMessagesImportance(QSqlDatabase db, const QStringList& ids) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -95,6 +91,7 @@ bool DatabaseQueries::switchMessagesImportance(QSqlDatabase db, const QStringLis
 }
 
 bool DatabaseQueries::permanentlyDeleteMessages(QSqlDatabase db, const QStringList& ids) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -102,6 +99,7 @@ bool DatabaseQueries::permanentlyDeleteMessages(QSqlDatabase db, const QStringLi
 }
 
 bool DatabaseQueries::deleteOrRestoreMessagesToFromBin(QSqlDatabase db, const QStringList& ids, bool deleted) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -111,6 +109,7 @@ bool DatabaseQueries::deleteOrRestoreMessagesToFromBin(QSqlDatabase db, const QS
 }
 
 bool DatabaseQueries::restoreBin(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -120,136 +119,140 @@ bool DatabaseQueries::restoreBin(QSqlDatabase db, int account_id) {
   return q.exec();
 }
 
-bool DatabaseQueries::purgeImportantMessages(QSqlDatabase db) {
+int DatabaseQueries::getMessagesCountForPurge(QSqlDatabase db, const QString& condition, const QVariantHash& values, bool* ok) {
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare(QSL("DELETE FROM Messages WHERE is_important = 1;"));
-  return q.exec();
-}
+  q.prepare(QSL("SELECT count(*) FROM Messages WHERE %1;").arg(condition));
 
-bool DatabaseQueries::purgeReadMessages(QSqlDatabase db) {
-  QSqlQuery q(db);
+  for (auto i = values.constBegin(); i != values.constEnd(); i++) {
+    q.bindValue(i.key(), i.value());
+  }
 
-  q.setForwardOnly(true);
-  q.prepare(QSL("DELETE FROM Messages WHERE is_important = :is_important AND is_deleted = :is_deleted AND is_read = :is_read;"));
-  q.bindValue(QSL(":is_read"), 1);
+  if (q.exec() && q.next()) {
+    if (ok != nullptr) {
+      *ok = true;
+    }
 
-  // Remove only messages which are NOT in recycle bin.
-  q.bindValue(QSL(":is_deleted"), 0);
+    return q.value(0).toInt();
+  }
+  else {
+    if (ok != nullptr) {
+      *ok = false;
+    }
 
-  // Remove only messages which are NOT starred.
-  q.bindValue(QSL(":is_important"), 0);
-  return q.exec();
+    return 0;
+  }
 }
 
-bool DatabaseQueries::purgeOldMessages(QSqlDatabase db, int older_than_days) {
+int DatabaseQueries::purgeMessagesBatch(QSqlDatabase db, const QString& condition, const QVariantHash& values,
+                                        int batch_size, int* last_id, bool* ok) {
   QSqlQuery q(db);
-  const qint64 since_epoch = QDateTime::currentDateTimeUtc().addDays(-older_than_days).toMSecsSinceEpoch();
+  int first_batch_id = -1;
+  int last_batch_id = -1;
 
+  // Range of the batch is found without write lock, so that
+  // the lock is held only for the deletion itself.
   q.setForwardOnly(true);
-  q.prepare(QSL("DELETE FROM Messages WHERE is_important = :is_important AND date_created < :date_created;"));
-  q.bindValue(QSL(":date_created"), since_epoch);
+  q.prepare(QSL("SELECT id FROM Messages WHERE id > :last_id AND %1 ORDER BY id LIMIT %2;").arg(condition,
+                                                                                              QString::number(batch_size)));
+  q.bindValue(QSL(":last_id"), *last_id);
 
-  // Remove only messages which are NOT starred.
-  q.bindValue(QSL(":is_important"), 0);
-  return q.exec();
-}
+  for (auto i = values.constBegin(); i != values.constEnd(); i++) {
+    q.bindValue(i.key(), i.value());
+  }
 
-bool DatabaseQueries::purgeRecycleBin(QSqlDatabase db) {
-  QSqlQuery q(db);
+  if (!q.exec()) {
+    if (ok != nullptr) {
+      *ok = false;
+    }
 
-  q.setForwardOnly(true);
-  q.prepare(QSL("DELETE FROM Messages WHERE is_important = :is_important AND is_deleted = :is_deleted;"));
-  q.bindValue(QSL(":is_deleted"), 1);
+    return 0;
+  }
 
-  // Remove only messages which are NOT starred.
-  q.bindValue(QSL(":is_important"), 0);
-  return q.exec();
-}
+  while (q.next()) {
+    if (first_batch_id < 0) {
+      first_batch_id = q.value(0).toInt();
+    }
 
-QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForCategory(QSqlDatabase db, const QString& custom_id, int account_id,
-                                                                            bool including_total_counts, bool* ok) {
-  QMap<QString, QPair<int, int>> counts;
-  QSqlQuery q(db);
+    last_batch_id = q.value(0).toInt();
+  }
 
-  q.setForwardOnly(true);
+  if (first_batch_id < 0) {
+    // Nothing more to remove.
+    if (ok != nullptr) {
+      *ok = true;
+    }
 
-  if (including_total_counts) {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2), count(*) FROM Messages "
-              "WHERE feed IN (SELECT custom_id FROM Feeds WHERE category = :category AND account_id = :account_id) AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
-  }
-  else {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2) FROM Messages "
-              "WHERE feed IN (SELECT custom_id FROM Feeds WHERE category = :category AND account_id = :account_id) AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
+    return 0;
   }
 
-  q.bindValue(QSL(":category"), custom_id);
-  q.bindValue(QSL(":account_id"), account_id);
+  DatabaseWriteLocker locker(qApp->database());
 
-  if (q.exec()) {
-    while (q.next()) {
-      QString feed_custom_id = q.value(0).toString();
-      int unread_count = q.value(1).toInt();
+  // Condition is checked again, messages might have changed meanwhile.
+  q.prepare(QSL("DELETE FROM Messages WHERE id >= :first_id AND id <= :last_id AND %1;").arg(condition));
+  q.bindValue(QSL(":first_id"), first_batch_id);
+  q.bindValue(QSL(":last_id"), last_batch_id);
 
-      if (including_total_counts) {
-        int total_count = q.value(2).toInt();
+  for (auto i = values.constBegin(); i != values.constEnd(); i++) {
+    q.bindValue(i.key(), i.value());
+  }
 
-        counts.insert(feed_custom_id, QPair<int, int>(unread_count, total_count));
-      }
-      else {
-        counts.insert(feed_custom_id, QPair<int, int>(unread_count, 0));
-      }
-    }
+  if (q.exec()) {
+    *last_id = last_batch_id;
 
     if (ok != nullptr) {
       *ok = true;
     }
+
+    return q.numRowsAffected();
   }
   else {
     if (ok != nullptr) {
       *ok = false;
     }
-  }
 
-  return counts;
+    return 0;
+  }
 }
 
-QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForAccount(QSqlDatabase db, int account_id,
-                                                                           bool including_total_counts, bool* ok) {
-  QMap<QString, QPair<int, int>> counts;
-  QSqlQuery q(db);
+QHash<int, AccountMessageCounts> DatabaseQueries::getMessageCountsForAllAccounts(QSqlDatabase db, bool* ok) {
+  QHash<int, AccountMessageCounts> counts;
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("SELECT account_id, feed, is_deleted, sum((is_read + 1) % 2), count(*) FROM Messages "
+                                                        "WHERE is_pdeleted = 0 "
+                                                        "GROUP BY account_id, feed, is_deleted;"));
 
-  q.setForwardOnly(true);
+  if (q.exec()) {
+    while (q.next()) {
+      addMessageCounts(counts[q.value(0).toInt()], q, 1);
+    }
 
-  if (including_total_counts) {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2), count(*) FROM Messages "
-              "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
+    if (ok != nullptr) {
+      *ok = true;
+    }
   }
   else {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2) FROM Messages "
-              "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
+    qWarning("Counts of messages cannot be obtained: '%s'.", qPrintable(q.lastError().text()));
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
   }
 
+  return counts;
+}
+
+AccountMessageCounts DatabaseQueries::getMessageCountsForAccount(QSqlDatabase db, int account_id, bool* ok) {
+  AccountMessageCounts counts;
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("SELECT feed, is_deleted, sum((is_read + 1) % 2), count(*) FROM Messages "
+                                                        "WHERE is_pdeleted = 0 AND account_id = :account_id "
+                                                        "GROUP BY feed, is_deleted;"));
+
   q.bindValue(QSL(":account_id"), account_id);
 
   if (q.exec()) {
     while (q.next()) {
-      QString feed_id = q.value(0).toString();
-      int unread_count = q.value(1).toInt();
-
-      if (including_total_counts) {
-        int total_count = q.value(2).toInt();
-
-        counts.insert(feed_id, QPair<int, int>(unread_count, total_count));
-      }
-      else {
-        counts.insert(feed_id, QPair<int, int>(unread_count, 0));
-      }
+      addMessageCounts(counts, q, 0);
     }
 
     if (ok != nullptr) {
@@ -257,6 +260,8 @@ QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForAccount(QSqlD
     }
   }
   else {
+    qWarning("Counts of messages of account %d cannot be obtained: '%s'.", account_id, qPrintable(q.lastError().text()));
+
     if (ok != nullptr) {
       *ok = false;
     }
@@ -265,69 +270,70 @@ QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForAccount(QSqlD
   return counts;
 }
 
-int DatabaseQueries::getMessageCountsForFeed(QSqlDatabase db, const QString& feed_custom_id,
-                                             int account_id, bool including_total_counts, bool* ok) {
-  QSqlQuery q(db);
-
-  q.setForwardOnly(true);
-
-  if (including_total_counts) {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE feed = :feed AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id;");
-  }
-  else {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE feed = :feed AND is_deleted = 0 AND is_pdeleted = 0 AND is_read = 0 AND account_id = :account_id;");
-  }
+QPair<int, int> DatabaseQueries::getMessageCountsForFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok) {
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("SELECT sum((is_read + 1) % 2), count(*) FROM Messages "
+                                                        "WHERE feed = :feed AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id;"));
 
   q.bindValue(QSL(":feed"), feed_custom_id);
   q.bindValue(QSL(":account_id"), account_id);
 
   if (q.exec() && q.next()) {
+    const QPair<int, int> counts(q.value(0).toInt(), q.value(1).toInt());
+
+    q.finish();
+
     if (ok != nullptr) {
       *ok = true;
     }
 
-    return q.value(0).toInt();
+    return counts;
   }
   else {
     if (ok != nullptr) {
       *ok = false;
     }
 
-    return 0;
+    return QPair<int, int>(0, 0);
   }
 }
 
-int DatabaseQueries::getMessageCountsForBin(QSqlDatabase db, int account_id, bool including_total_counts, bool* ok) {
-  QSqlQuery q(db);
-
-  q.setForwardOnly(true);
-
-  if (including_total_counts) {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
-  }
-  else {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE is_read = 0 AND is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
-  }
+QPair<int, int> DatabaseQueries::getMessageCountsForBin(QSqlDatabase db, int account_id, bool* ok) {
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("SELECT sum((is_read + 1) % 2), count(*) FROM Messages "
+                                                        "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;"));
 
   q.bindValue(QSL(":account_id"), account_id);
 
   if (q.exec() && q.next()) {
+    const QPair<int, int> counts(q.value(0).toInt(), q.value(1).toInt());
+
+    q.finish();
+
     if (ok != nullptr) {
       *ok = true;
     }
 
-    return q.value(0).toInt();
+    return counts;
   }
   else {
     if (ok != nullptr) {
       *ok = false;
     }
 
-    return 0;
+    return QPair<int, int>(0, 0);
+  }
+}
+
+void DatabaseQueries::addMessageCounts(AccountMessageCounts& counts, const QSqlQuery& query, int first_column) {
+  const int unread_count = query.value(first_column + 2).toInt();
+  const int total_count = query.value(first_column + 3).toInt();
+
+  if (query.value(first_column + 1).toInt() == 1) {
+    // Deleted messages of all feeds are in recycle bin.
+    counts.m_recycleBin.first += unread_count;
+    counts.m_recycleBin.second += total_count;
+  }
+  else {
+    counts.m_feeds.insert(query.value(first_column).toString(), QPair<int, int>(unread_count, total_count));
   }
 }
 
@@ -336,7 +342,8 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForFeed(QSqlDatabase db, con
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed "
+  q.prepare("SELECT id, is_read, is_deleted, is_important, feed, title, url, author, date_created, contents, is_pdeleted, enclosures, "
+            "account_id, custom_id, custom_hash, feed, 0 AS has_enclosures, images, preview, word_count "
             "FROM Messages "
             "WHERE is_deleted = 0 AND is_pdeleted = 0 AND feed = :feed AND account_id = :account_id;");
   q.bindValue(QSL(":feed"), feed_custom_id);
@@ -370,7 +377,8 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForBin(QSqlDatabase db, int
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed "
+  q.prepare("SELECT id, is_read, is_deleted, is_important, feed, title, url, author, date_created, contents, is_pdeleted, enclosures, "
+            "account_id, custom_id, custom_hash, feed, 0 AS has_enclosures, images, preview, word_count "
             "FROM Messages "
             "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
   q.bindValue(QSL(":account_id"), account_id);
@@ -403,7 +411,8 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForAccount(QSqlDatabase db,
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed "
+  q.prepare("SELECT id, is_read, is_deleted, is_important, feed, title, url, author, date_created, contents, is_pdeleted, enclosures, "
+            "account_id, custom_id, custom_hash, feed, 0 AS has_enclosures, images, preview, word_count "
             "FROM Messages "
             "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id;");
   q.bindValue(QSL(":account_id"), account_id);
@@ -431,6 +440,87 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForAccount(QSqlDatabase db,
   return messages;
 }
 
+int DatabaseQueries::processMessagesContentsBatch(QSqlDatabase db, int batch_size, bool* ok) {
+  QSqlQuery q(db);
+  QList<Message> messages;
+
+  // Contents are read and processed without write lock, so that
+  // the lock is held only for storing of results.
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT id, contents FROM Messages WHERE word_count IS NULL LIMIT %1;").arg(batch_size));
+
+  if (!q.exec()) {
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+
+  while (q.next()) {
+    Message message;
+
+    message.m_id = q.value(0).toInt();
+    message.m_contents = q.value(1).toString();
+    messages.append(message);
+  }
+
+  if (messages.isEmpty()) {
+    if (ok != nullptr) {
+      *ok = true;
+    }
+
+    return 0;
+  }
+
+  MessageContentProcessor::processMessages(messages);
+
+  DatabaseWriteLocker locker(qApp->database());
+
+  // Only derived data are stored, original contents are kept intact.
+  // Messages re-downloaded meanwhile are already processed, they are skipped.
+  QSqlQuery query_update = qApp->database()->preparedQuery(db, QSL("UPDATE Messages "
+                                                                   "SET images = :images, preview = :preview, word_count = :word_count "
+                                                                   "WHERE id = :id AND word_count IS NULL;"));
+
+  db.transaction();
+
+  foreach (const Message& message, messages) {
+    query_update.bindValue(QSL(":images"), message.m_imageUrls.join(MSG_IMAGES_SEPARATOR));
+    query_update.bindValue(QSL(":preview"), message.m_preview);
+    query_update.bindValue(QSL(":word_count"), message.m_wordCount);
+    query_update.bindValue(QSL(":id"), message.m_id);
+
+    if (!query_update.exec()) {
+      qWarning("Storing of processed contents of message failed: '%s'.", qPrintable(query_update.lastError().text()));
+      db.rollback();
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      return 0;
+    }
+  }
+
+  if (!db.commit()) {
+    qWarning("Storing of processed contents of messages failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+
+  if (ok != nullptr) {
+    *ok = true;
+  }
+
+  return messages.size();
+}
+
 int DatabaseQueries::updateMessages(QSqlDatabase db,
                                     const QList<Message>& messages,
                                     const QString& feed_custom_id,
@@ -438,23 +528,22 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
                                     const QString& url,
                                     bool* any_message_changed,
                                     bool* ok) {
+  DatabaseWriteLocker locker(qApp->database());
+
   if (messages.isEmpty()) {
     *any_message_changed = false;
     *ok = true;
     return 0;
   }
 
-  bool use_transactions = qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool();
+  bool use_transactions = qApp->settings()->snapshot().m_useTransactions;
 
   // Does not make any difference, since each feed now has
   // its own "custom ID" (standard feeds have their custom ID equal to primary key ID).
   int updated_messages = 0;
 
-  // Prepare queries.
-  QSqlQuery query_select_with_url(db);
-  QSqlQuery query_select_with_id(db);
-  QSqlQuery query_update(db);
-  QSqlQuery query_insert(db);
+  // Prepare queries. They are cached by database factory,
+  // so they are parsed only once per connection.
   QSqlQuery query_begin_transaction(db);
 
   // Here we have query which will check for existence of the "same" message in given feed.
@@ -463,27 +552,24 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
   //   2) they have same URL AND,
   //   3) they have same AUTHOR AND,
   //   4) they have same title.
-  query_select_with_url.setForwardOnly(true);
-  query_select_with_url.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
-                                "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;");
+  QSqlQuery query_select_with_url = qApp->database()->preparedQuery(db, QSL("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
+                                                                            "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;"));
 
   // When we have custom ID of the message, we can check directly for existence
   // of that particular message.
-  query_select_with_id.setForwardOnly(true);
-  query_select_with_id.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
-                               "WHERE custom_id = :custom_id AND account_id = :account_id;");
+  QSqlQuery query_select_with_id = qApp->database()->preparedQuery(db, QSL("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
+                                                                           "WHERE custom_id = :custom_id AND account_id = :account_id;"));
 
   // Used to insert new messages.
-  query_insert.setForwardOnly(true);
-  query_insert.prepare("INSERT INTO Messages "
-                       "(feed, title, is_read, is_important, url, author, date_created, contents, enclosures, custom_id, custom_hash, account_id) "
-                       "VALUES (:feed, :title, :is_read, :is_important, :url, :author, :date_created, :contents, :enclosures, :custom_id, :custom_hash, :account_id);");
+  QSqlQuery query_insert = qApp->database()->preparedQuery(db, QSL("INSERT INTO Messages "
+                                                                   "(feed, title, is_read, is_important, url, author, date_created, contents, enclosures, custom_id, custom_hash, account_id, images, preview, word_count) "
+                                                                   "VALUES (:feed, :title, :is_read, :is_important, :url, :author, :date_created, :contents, :enclosures, :custom_id, :custom_hash, :account_id, :images, :preview, :word_count);"));
 
   // Used to update existing messages.
-  query_update.setForwardOnly(true);
-  query_update.prepare("UPDATE Messages "
-                       "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures, feed = :feed "
-                       "WHERE id = :id;");
+  QSqlQuery query_update = qApp->database()->preparedQuery(db, QSL("UPDATE Messages "
+                                                                   "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures, feed = :feed, "
+                                                                   "images = :images, preview = :preview, word_count = :word_count "
+                                                                   "WHERE id = :id;"));
 
   if (use_transactions && !query_begin_transaction.exec(qApp->database()->obtainBeginTransactionSql())) {
     qCritical("Transaction start for message downloader failed: '%s'.", qPrintable(query_begin_transaction.lastError().text()));
@@ -591,6 +677,9 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
         query_update.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
         query_update.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
         query_update.bindValue(QSL(":feed"), unnulifyString(feed_id_existing_message));
+        query_update.bindValue(QSL(":images"), message.m_imageUrls.join(MSG_IMAGES_SEPARATOR));
+        query_update.bindValue(QSL(":preview"), message.m_preview);
+        query_update.bindValue(QSL(":word_count"), message.m_wordCount);
         query_update.bindValue(QSL(":id"), id_existing_message);
         *any_message_changed = true;
 
@@ -622,6 +711,9 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
       query_insert.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
       query_insert.bindValue(QSL(":custom_hash"), unnulifyString(message.m_customHash));
       query_insert.bindValue(QSL(":account_id"), account_id);
+      query_insert.bindValue(QSL(":images"), message.m_imageUrls.join(MSG_IMAGES_SEPARATOR));
+      query_insert.bindValue(QSL(":preview"), message.m_preview);
+      query_insert.bindValue(QSL(":word_count"), message.m_wordCount);
 
       if (query_insert.exec() && query_insert.numRowsAffected() == 1) {
         updated_messages++;
@@ -665,6 +757,7 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
 }
 
 bool DatabaseQueries::purgeMessagesFromBin(QSqlDatabase db, bool clear_only_read, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -681,12 +774,16 @@ bool DatabaseQueries::purgeMessagesFromBin(QSqlDatabase db, bool clear_only_read
 }
 
 bool DatabaseQueries::deleteAccount(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery query(db);
 
   query.setForwardOnly(true);
   QStringList queries;
 
   queries << QSL("DELETE FROM Messages WHERE account_id = :account_id;") <<
+    QSL("DELETE FROM EnclosurePolicies WHERE account_id = :account_id;") <<
+    QSL("DELETE FROM EnclosureFiles WHERE account_id = :account_id;") <<
+    QSL("DELETE FROM MessageStatesOutbox WHERE account_id = :account_id;") <<
     QSL("DELETE FROM Feeds WHERE account_id = :account_id;") <<
     QSL("DELETE FROM Categories WHERE account_id = :account_id;") <<
     QSL("DELETE FROM Accounts WHERE id = :account_id;");
@@ -708,6 +805,7 @@ bool DatabaseQueries::deleteAccount(QSqlDatabase db, int account_id) {
 }
 
 bool DatabaseQueries::deleteAccountData(QSqlDatabase db, int account_id, bool delete_messages_too) {
+  DatabaseWriteLocker locker(qApp->database());
   bool result = true;
   QSqlQuery q(db);
 
@@ -731,6 +829,7 @@ bool DatabaseQueries::deleteAccountData(QSqlDatabase db, int account_id, bool de
 }
 
 bool DatabaseQueries::cleanFeeds(QSqlDatabase db, const QStringList& ids, bool clean_read_only, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -759,6 +858,7 @@ bool DatabaseQueries::cleanFeeds(QSqlDatabase db, const QStringList& ids, bool c
 }
 
 bool DatabaseQueries::purgeLeftoverMessages(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -775,51 +875,96 @@ bool DatabaseQueries::purgeLeftoverMessages(QSqlDatabase db, int account_id) {
   }
 }
 
-bool DatabaseQueries::storeAccountTree(QSqlDatabase db, RootItem* tree_root, int account_id) {
-  QSqlQuery query_category(db);
-  QSqlQuery query_feed(db);
+bool DatabaseQueries::storeAccountTreeChanges(QSqlDatabase db, const AccountTreeChanges& changes, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery query_insert_category = qApp->database()->preparedQuery(db, QSL("INSERT INTO Categories (parent_id, title, account_id, custom_id) "
+                                                                            "VALUES (:parent_id, :title, :account_id, :custom_id);"));
+  QSqlQuery query_insert_feed = qApp->database()->preparedQuery(db, QSL("INSERT INTO Feeds (title, icon, category, protected, update_type, update_interval, account_id, custom_id) "
+                                                                        "VALUES (:title, :icon, :category, :protected, :update_type, :update_interval, :account_id, :custom_id);"));
+  QSqlQuery query_update_category = qApp->database()->preparedQuery(db, QSL("UPDATE Categories SET parent_id = :parent_id, title = :title "
+                                                                            "WHERE id = :id;"));
+  QSqlQuery query_update_feed = qApp->database()->preparedQuery(db, QSL("UPDATE Feeds SET title = :title, icon = :icon, category = :category "
+                                                                        "WHERE id = :id;"));
+  QSqlQuery query_remove_category = qApp->database()->preparedQuery(db, QSL("DELETE FROM Categories WHERE id = :id;"));
+  QSqlQuery query_remove_feed = qApp->database()->preparedQuery(db, QSL("DELETE FROM Feeds WHERE id = :id;"));
 
-  query_category.setForwardOnly(true);
-  query_feed.setForwardOnly(true);
-  query_category.prepare("INSERT INTO Categories (parent_id, title, account_id, custom_id) "
-                         "VALUES (:parent_id, :title, :account_id, :custom_id);");
-  query_feed.prepare("INSERT INTO Feeds (title, icon, category, protected, update_type, update_interval, account_id, custom_id) "
-                     "VALUES (:title, :icon, :category, :protected, :update_type, :update_interval, :account_id, :custom_id);");
+  // Top-level items of account have no parent category.
+  auto parent_id = [&changes](RootItem* item) {
+    RootItem* parent = changes.m_parents.value(item);
 
-  // Iterate all children.
-  foreach (RootItem* child, tree_root->getSubTree()) {
-    if (child->kind() == RootItemKind::Category) {
-      query_category.bindValue(QSL(":parent_id"), child->parent()->id());
-      query_category.bindValue(QSL(":title"), child->title());
-      query_category.bindValue(QSL(":account_id"), account_id);
-      query_category.bindValue(QSL(":custom_id"), child->customId());
+    return parent == nullptr || parent->kind() == RootItemKind::ServiceRoot ? NO_PARENT_CATEGORY : parent->id();
+  };
 
-      if (query_category.exec()) {
-        child->setId(query_category.lastInsertId().toInt());
-      }
-      else {
-        return false;
-      }
+  if (!db.transaction()) {
+    qCritical("Transaction start for account tree changes failed: '%s'.", qPrintable(db.lastError().text()));
+    return false;
+  }
+
+  // Parents are inserted before their children, so their IDs are known.
+  foreach (RootItem* item, changes.m_insertedItems) {
+    QSqlQuery& query = item->kind() == RootItemKind::Category ? query_insert_category : query_insert_feed;
+
+    if (item->kind() == RootItemKind::Category) {
+      query.bindValue(QSL(":parent_id"), parent_id(item));
+    }
+    else {
+      query.bindValue(QSL(":icon"), qApp->icons()->toByteArray(item->icon()));
+      query.bindValue(QSL(":category"), parent_id(item));
+      query.bindValue(QSL(":protected"), 0);
+      query.bindValue(QSL(":update_type"), (int) item->toFeed()->autoUpdateType());
+      query.bindValue(QSL(":update_interval"), item->toFeed()->autoUpdateInitialInterval());
     }
-    else if (child->kind() == RootItemKind::Feed) {
-      Feed* feed = child->toFeed();
 
-      query_feed.bindValue(QSL(":title"), feed->title());
-      query_feed.bindValue(QSL(":icon"), qApp->icons()->toByteArray(feed->icon()));
-      query_feed.bindValue(QSL(":category"), feed->parent()->id());
-      query_feed.bindValue(QSL(":protected"), 0);
-      query_feed.bindValue(QSL(":update_type"), (int) feed->autoUpdateType());
-      query_feed.bindValue(QSL(":update_interval"), feed->autoUpdateInitialInterval());
-      query_feed.bindValue(QSL(":account_id"), account_id);
-      query_feed.bindValue(QSL(":custom_id"), feed->customId());
+    query.bindValue(QSL(":title"), item->title());
+    query.bindValue(QSL(":account_id"), account_id);
+    query.bindValue(QSL(":custom_id"), item->customId());
 
-      if (query_feed.exec()) {
-        feed->setId(query_feed.lastInsertId().toInt());
-      }
-      else {
-        return false;
-      }
+    if (!query.exec()) {
+      qCritical("Inserting of item of account tree failed: '%s'.", qPrintable(query.lastError().text()));
+      db.rollback();
+      return false;
     }
+
+    item->setId(query.lastInsertId().toInt());
+  }
+
+  for (const QPair<RootItem*, RootItem*>& update : changes.m_updatedItems) {
+    QSqlQuery& query = update.first->kind() == RootItemKind::Category ? query_update_category : query_update_feed;
+
+    if (update.first->kind() == RootItemKind::Category) {
+      query.bindValue(QSL(":parent_id"), parent_id(update.first));
+    }
+    else {
+      query.bindValue(QSL(":icon"), qApp->icons()->toByteArray(update.second->icon()));
+      query.bindValue(QSL(":category"), parent_id(update.first));
+    }
+
+    query.bindValue(QSL(":title"), update.second->title());
+    query.bindValue(QSL(":id"), update.first->id());
+
+    if (!query.exec()) {
+      qCritical("Updating of item of account tree failed: '%s'.", qPrintable(query.lastError().text()));
+      db.rollback();
+      return false;
+    }
+  }
+
+  foreach (RootItem* item, changes.m_removedItems) {
+    QSqlQuery& query = item->kind() == RootItemKind::Category ? query_remove_category : query_remove_feed;
+
+    query.bindValue(QSL(":id"), item->id());
+
+    if (!query.exec()) {
+      qCritical("Removing of item of account tree failed: '%s'.", qPrintable(query.lastError().text()));
+      db.rollback();
+      return false;
+    }
+  }
+
+  if (!db.commit()) {
+    qCritical("Transaction commit for account tree changes failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+    return false;
   }
 
   return true;
@@ -965,6 +1110,7 @@ QList<ServiceRoot*> DatabaseQueries::getTtRssAccounts(QSqlDatabase db, bool* ok)
 }
 
 bool DatabaseQueries::deleteOwnCloudAccount(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -975,6 +1121,7 @@ bool DatabaseQueries::deleteOwnCloudAccount(QSqlDatabase db, int account_id) {
 
 bool DatabaseQueries::overwriteOwnCloudAccount(QSqlDatabase db, const QString& username, const QString& password,
                                                const QString& url, bool force_server_side_feed_update, int batch_size, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery query(db);
 
   query.prepare("UPDATE OwnCloudAccounts "
@@ -999,6 +1146,7 @@ bool DatabaseQueries::overwriteOwnCloudAccount(QSqlDatabase db, const QString& u
 bool DatabaseQueries::createOwnCloudAccount(QSqlDatabase db, int id_to_assign, const QString& username,
                                             const QString& password, const QString& url,
                                             bool force_server_side_feed_update, int batch_size) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.prepare("INSERT INTO OwnCloudAccounts (id, username, password, url, force_update, msg_limit) "
@@ -1020,6 +1168,7 @@ bool DatabaseQueries::createOwnCloudAccount(QSqlDatabase db, int id_to_assign, c
 }
 
 int DatabaseQueries::createAccount(QSqlDatabase db, const QString& code, bool* ok) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   // First obtain the ID, which can be assigned to this new account.
@@ -1088,6 +1237,7 @@ Assignment DatabaseQueries::getOwnCloudFeeds(QSqlDatabase db, int account_id, bo
 }
 
 bool DatabaseQueries::deleteFeed(QSqlDatabase db, int feed_custom_id, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1101,6 +1251,23 @@ bool DatabaseQueries::deleteFeed(QSqlDatabase db, int feed_custom_id, int accoun
     return false;
   }
 
+  // Downloaded enclosures are left on disk, only the feed does not manage them anymore.
+  q.prepare(QSL("DELETE FROM EnclosurePolicies WHERE feed = :feed AND account_id = :account_id;"));
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (!q.exec()) {
+    return false;
+  }
+
+  q.prepare(QSL("DELETE FROM EnclosureFiles WHERE feed = :feed AND account_id = :account_id;"));
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (!q.exec()) {
+    return false;
+  }
+
   // Remove feed itself.
   q.prepare(QSL("DELETE FROM Feeds WHERE custom_id = :feed AND account_id = :account_id;"));
   q.bindValue(QSL(":feed"), feed_custom_id);
@@ -1109,6 +1276,7 @@ bool DatabaseQueries::deleteFeed(QSqlDatabase db, int feed_custom_id, int accoun
 }
 
 bool DatabaseQueries::deleteCategory(QSqlDatabase db, int id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   // Remove this category from database.
@@ -1121,6 +1289,7 @@ bool DatabaseQueries::deleteCategory(QSqlDatabase db, int id) {
 int DatabaseQueries::addCategory(QSqlDatabase db, int parent_id, int account_id, const QString& title,
                                  const QString& description, QDateTime creation_date, const QIcon& icon,
                                  bool* ok) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1162,6 +1331,7 @@ int DatabaseQueries::addCategory(QSqlDatabase db, int parent_id, int account_id,
 
 bool DatabaseQueries::editCategory(QSqlDatabase db, int parent_id, int category_id,
                                    const QString& title, const QString& description, const QIcon& icon) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1182,6 +1352,7 @@ int DatabaseQueries::addFeed(QSqlDatabase db, int parent_id, int account_id, con
                              const QString& username, const QString& password,
                              Feed::AutoUpdateType auto_update_type,
                              int auto_update_interval, StandardFeed::Type feed_format, bool* ok) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   qDebug() << "Adding feed with title '" << title.toUtf8() << "' to DB.";
@@ -1242,6 +1413,7 @@ bool DatabaseQueries::editFeed(QSqlDatabase db, int parent_id, int feed_id, cons
                                const QString& username, const QString& password,
                                Feed::AutoUpdateType auto_update_type,
                                int auto_update_interval, StandardFeed::Type feed_format) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1273,6 +1445,7 @@ bool DatabaseQueries::editFeed(QSqlDatabase db, int parent_id, int feed_id, cons
 
 bool DatabaseQueries::editBaseFeed(QSqlDatabase db, int feed_id, Feed::AutoUpdateType auto_update_type,
                                    int auto_update_interval) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1397,6 +1570,7 @@ Assignment DatabaseQueries::getStandardFeeds(QSqlDatabase db, int account_id, bo
 }
 
 bool DatabaseQueries::deleteTtRssAccount(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1411,6 +1585,7 @@ bool DatabaseQueries::deleteTtRssAccount(QSqlDatabase db, int account_id) {
 bool DatabaseQueries::overwriteTtRssAccount(QSqlDatabase db, const QString& username, const QString& password,
                                             bool auth_protected, const QString& auth_username, const QString& auth_password,
                                             const QString& url, bool force_server_side_feed_update, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.prepare("UPDATE TtRssAccounts "
@@ -1439,6 +1614,7 @@ bool DatabaseQueries::createTtRssAccount(QSqlDatabase db, int id_to_assign, cons
                                          const QString& password, bool auth_protected, const QString& auth_username,
                                          const QString& auth_password, const QString& url,
                                          bool force_server_side_feed_update) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.prepare("INSERT INTO TtRssAccounts (id, username, password, auth_protected, auth_username, auth_password, url, force_update) "
@@ -1563,6 +1739,7 @@ QList<ServiceRoot*> DatabaseQueries::getGmailAccounts(QSqlDatabase db, bool* ok)
 }
 
 bool DatabaseQueries::deleteGmailAccount(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1572,6 +1749,7 @@ bool DatabaseQueries::deleteGmailAccount(QSqlDatabase db, int account_id) {
 }
 
 bool DatabaseQueries::deleteInoreaderAccount(QSqlDatabase db, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
@@ -1612,6 +1790,7 @@ Assignment DatabaseQueries::getInoreaderFeeds(QSqlDatabase db, int account_id, b
 }
 
 bool DatabaseQueries::storeNewInoreaderTokens(QSqlDatabase db, const QString& refresh_token, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery query(db);
 
   query.prepare("UPDATE InoreaderAccounts "
@@ -1668,6 +1847,7 @@ QList<ServiceRoot*> DatabaseQueries::getInoreaderAccounts(QSqlDatabase db, bool*
 bool DatabaseQueries::overwriteGmailAccount(QSqlDatabase db, const QString& username, const QString& app_id,
                                             const QString& app_key, const QString& redirect_url,
                                             const QString& refresh_token, int batch_size, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery query(db);
 
   query.prepare("UPDATE GmailAccounts "
@@ -1694,6 +1874,7 @@ bool DatabaseQueries::overwriteGmailAccount(QSqlDatabase db, const QString& user
 bool DatabaseQueries::createGmailAccount(QSqlDatabase db, int id_to_assign, const QString& username,
                                          const QString& app_id, const QString& app_key, const QString& redirect_url,
                                          const QString& refresh_token, int batch_size) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.prepare("INSERT INTO GmailAccounts (id, username, app_id, app_key, redirect_url, refresh_token, msg_limit) "
@@ -1718,6 +1899,7 @@ bool DatabaseQueries::createGmailAccount(QSqlDatabase db, int id_to_assign, cons
 bool DatabaseQueries::overwriteInoreaderAccount(QSqlDatabase db, const QString& username, const QString& app_id,
                                                 const QString& app_key, const QString& redirect_url,
                                                 const QString& refresh_token, int batch_size, int account_id) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery query(db);
 
   query.prepare("UPDATE InoreaderAccounts "
@@ -1744,6 +1926,7 @@ bool DatabaseQueries::overwriteInoreaderAccount(QSqlDatabase db, const QString&
 bool DatabaseQueries::createInoreaderAccount(QSqlDatabase db, int id_to_assign, const QString& username,
                                              const QString& app_id, const QString& app_key, const QString& redirect_url,
                                              const QString& refresh_token, int batch_size) {
+  DatabaseWriteLocker locker(qApp->database());
   QSqlQuery q(db);
 
   q.prepare("INSERT INTO InoreaderAccounts (id, username, app_id, app_key, redirect_url, refresh_token, msg_limit) "
@@ -1799,6 +1982,342 @@ Assignment DatabaseQueries::getTtRssFeeds(QSqlDatabase db, int account_id, bool*
   return feeds;
 }
 
+EnclosurePolicy DatabaseQueries::getEnclosurePolicy(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok) {
+  EnclosurePolicy policy;
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT mime_types, max_size, keep_last FROM EnclosurePolicies WHERE feed = :feed AND account_id = :account_id;"));
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (q.exec()) {
+    if (q.next()) {
+      policy.m_enabled = true;
+      policy.m_mimeTypes = q.value(0).toString().split(QL1C(','), QString::SkipEmptyParts);
+      policy.m_maxSize = q.value(1).toInt();
+      policy.m_keepLast = q.value(2).toInt();
+    }
+
+    if (ok != nullptr) {
+      *ok = true;
+    }
+  }
+  else {
+    qWarning("Loading of enclosure policy failed: '%s'.", qPrintable(q.lastError().text()));
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+  }
+
+  return policy;
+}
+
+bool DatabaseQueries::storeEnclosurePolicy(QSqlDatabase db, const QString& feed_custom_id, int account_id,
+                                           const EnclosurePolicy& policy) {
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("DELETE FROM EnclosurePolicies WHERE feed = :feed AND account_id = :account_id;"));
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (!q.exec()) {
+    qWarning("Removing of enclosure policy failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  if (!policy.m_enabled) {
+    return true;
+  }
+
+  q.prepare(QSL("INSERT INTO EnclosurePolicies (account_id, feed, mime_types, max_size, keep_last) "
+                "VALUES (:account_id, :feed, :mime_types, :max_size, :keep_last);"));
+  q.bindValue(QSL(":account_id"), account_id);
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":mime_types"), policy.m_mimeTypes.join(QL1C(',')));
+  q.bindValue(QSL(":max_size"), policy.m_maxSize);
+  q.bindValue(QSL(":keep_last"), policy.m_keepLast);
+
+  if (!q.exec()) {
+    qWarning("Saving of enclosure policy failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  return true;
+}
+
+EnclosureFile DatabaseQueries::getEnclosureFile(QSqlDatabase db, const QString& url, int account_id, bool* ok) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT account_id, feed, url, file_name, state, date_created FROM EnclosureFiles "
+                "WHERE url = :url AND account_id = :account_id;"));
+  q.bindValue(QSL(":url"), url);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (ok != nullptr) {
+    *ok = q.exec();
+  }
+  else {
+    q.exec();
+  }
+
+  return q.next() ? enclosureFileFromRecord(q) : EnclosureFile();
+}
+
+QList<EnclosureFile> DatabaseQueries::getEnclosureFiles(QSqlDatabase db, bool* ok) {
+  QList<EnclosureFile> files;
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+
+  if (ok != nullptr) {
+    *ok = q.exec(QSL("SELECT account_id, feed, url, file_name, state, date_created FROM EnclosureFiles "
+                     "WHERE state = 0 OR state = 1;"));
+  }
+  else {
+    q.exec(QSL("SELECT account_id, feed, url, file_name, state, date_created FROM EnclosureFiles "
+               "WHERE state = 0 OR state = 1;"));
+  }
+
+  while (q.next()) {
+    files.append(enclosureFileFromRecord(q));
+  }
+
+  return files;
+}
+
+QList<EnclosureFile> DatabaseQueries::getEnclosureFilesForFeed(QSqlDatabase db, const QString& feed_custom_id,
+                                                               int account_id, bool* ok) {
+  QList<EnclosureFile> files;
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT account_id, feed, url, file_name, state, date_created FROM EnclosureFiles "
+                "WHERE feed = :feed AND account_id = :account_id "
+                "ORDER BY date_created DESC;"));
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (ok != nullptr) {
+    *ok = q.exec();
+  }
+  else {
+    q.exec();
+  }
+
+  while (q.next()) {
+    files.append(enclosureFileFromRecord(q));
+  }
+
+  return files;
+}
+
+bool DatabaseQueries::addEnclosureFile(QSqlDatabase db, const EnclosureFile& file) {
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("INSERT INTO EnclosureFiles (account_id, feed, url, file_name, state, date_created) "
+                "VALUES (:account_id, :feed, :url, :file_name, :state, :date_created);"));
+  q.bindValue(QSL(":account_id"), file.m_accountId);
+  q.bindValue(QSL(":feed"), file.m_feedId);
+  q.bindValue(QSL(":url"), file.m_url);
+  q.bindValue(QSL(":file_name"), file.m_fileName);
+  q.bindValue(QSL(":state"), int(file.m_state));
+  q.bindValue(QSL(":date_created"), file.m_created.toMSecsSinceEpoch());
+
+  if (!q.exec()) {
+    qWarning("Saving of enclosure file failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  return true;
+}
+
+bool DatabaseQueries::setEnclosureFilesState(QSqlDatabase db, int account_id, const QStringList& file_names,
+                                             EnclosureFile::State state) {
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE EnclosureFiles SET state = :state WHERE file_name = :file_name AND account_id = :account_id;"));
+
+  foreach (const QString& file_name, file_names) {
+    q.bindValue(QSL(":state"), int(state));
+    q.bindValue(QSL(":file_name"), file_name);
+    q.bindValue(QSL(":account_id"), account_id);
+
+    if (!q.exec()) {
+      qWarning("Updating of enclosure file state failed: '%s'.", qPrintable(q.lastError().text()));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool DatabaseQueries::getMessageStatesOutbox(QSqlDatabase db, int account_id,
+                                             QHash<QString, RootItem::ReadStatus>& read_states,
+                                             QHash<QString, Message>& important_states) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT custom_id, field, value, feed, custom_hash FROM MessageStatesOutbox "
+                "WHERE account_id = :account_id ORDER BY id ASC;"));
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (!q.exec()) {
+    qWarning("Loading of outbox of message states failed: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  while (q.next()) {
+    const QString custom_id = q.value(0).toString();
+    const bool value = q.value(2).toInt() == 1;
+
+    if (q.value(1).toInt() == OutboxRead) {
+      read_states.insert(custom_id, value ? RootItem::Read : RootItem::Unread);
+    }
+    else {
+      Message message;
+
+      message.m_accountId = account_id;
+      message.m_customId = custom_id;
+      message.m_feedId = q.value(3).toString();
+      message.m_customHash = q.value(4).toString();
+      message.m_isImportant = value;
+      important_states.insert(custom_id, message);
+    }
+  }
+
+  return true;
+}
+
+bool DatabaseQueries::storeMessageStatesToOutbox(QSqlDatabase db, int account_id, const QStringList& custom_ids,
+                                                 RootItem::ReadStatus read) {
+  QList<Message> messages;
+
+  foreach (const QString& custom_id, custom_ids) {
+    Message message;
+
+    message.m_customId = custom_id;
+    messages.append(message);
+  }
+
+  return storeOutboxStates(db, account_id, OutboxRead, read == RootItem::Read ? 1 : 0, messages);
+}
+
+bool DatabaseQueries::storeMessageStatesToOutbox(QSqlDatabase db, int account_id, const QList<Message>& messages,
+                                                 RootItem::Importance importance) {
+  return storeOutboxStates(db, account_id, OutboxImportant, importance == RootItem::Important ? 1 : 0, messages);
+}
+
+bool DatabaseQueries::removeMessageStatesFromOutbox(QSqlDatabase db, int account_id, const QStringList& custom_ids,
+                                                    RootItem::ReadStatus read) {
+  return removeOutboxStates(db, account_id, OutboxRead, read == RootItem::Read ? 1 : 0, custom_ids);
+}
+
+bool DatabaseQueries::removeMessageStatesFromOutbox(QSqlDatabase db, int account_id, const QStringList& custom_ids,
+                                                    RootItem::Importance importance) {
+  return removeOutboxStates(db, account_id, OutboxImportant, importance == RootItem::Important ? 1 : 0, custom_ids);
+}
+
+bool DatabaseQueries::storeOutboxStates(QSqlDatabase db, int account_id, int field, int value, const QList<Message>& messages) {
+  if (messages.isEmpty()) {
+    return true;
+  }
+
+  DatabaseWriteLocker locker(qApp->database());
+  QSqlQuery query_delete = qApp->database()->preparedQuery(db, QSL("DELETE FROM MessageStatesOutbox "
+                                                                   "WHERE account_id = :account_id AND custom_id = :custom_id AND field = :field;"));
+  QSqlQuery query_insert = qApp->database()->preparedQuery(db, QSL("INSERT INTO MessageStatesOutbox "
+                                                                   "(account_id, custom_id, field, value, feed, custom_hash) "
+                                                                   "VALUES (:account_id, :custom_id, :field, :value, :feed, :custom_hash);"));
+
+  // Only last state of each message is kept, all rows are written at once.
+  db.transaction();
+
+  foreach (const Message& message, messages) {
+    query_delete.bindValue(QSL(":account_id"), account_id);
+    query_delete.bindValue(QSL(":custom_id"), message.m_customId);
+    query_delete.bindValue(QSL(":field"), field);
+
+    query_insert.bindValue(QSL(":account_id"), account_id);
+    query_insert.bindValue(QSL(":custom_id"), message.m_customId);
+    query_insert.bindValue(QSL(":field"), field);
+    query_insert.bindValue(QSL(":value"), value);
+    query_insert.bindValue(QSL(":feed"), message.m_feedId);
+    query_insert.bindValue(QSL(":custom_hash"), message.m_customHash);
+
+    if (!query_delete.exec() || !query_insert.exec()) {
+      qWarning("Saving of message states to outbox failed: '%s', '%s'.",
+               qPrintable(query_delete.lastError().text()), qPrintable(query_insert.lastError().text()));
+      db.rollback();
+      return false;
+    }
+  }
+
+  if (!db.commit()) {
+    qWarning("Saving of message states to outbox failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+    return false;
+  }
+
+  return true;
+}
+
+bool DatabaseQueries::removeOutboxStates(QSqlDatabase db, int account_id, int field, int value, const QStringList& custom_ids) {
+  if (custom_ids.isEmpty()) {
+    return true;
+  }
+
+  DatabaseWriteLocker locker(qApp->database());
+
+  // State is removed only if it was not changed again in the meantime.
+  QSqlQuery q = qApp->database()->preparedQuery(db, QSL("DELETE FROM MessageStatesOutbox "
+                                                        "WHERE account_id = :account_id AND custom_id = :custom_id AND "
+                                                        "field = :field AND value = :value;"));
+
+  db.transaction();
+
+  foreach (const QString& custom_id, custom_ids) {
+    q.bindValue(QSL(":account_id"), account_id);
+    q.bindValue(QSL(":custom_id"), custom_id);
+    q.bindValue(QSL(":field"), field);
+    q.bindValue(QSL(":value"), value);
+
+    if (!q.exec()) {
+      qWarning("Removing of message states from outbox failed: '%s'.", qPrintable(q.lastError().text()));
+      db.rollback();
+      return false;
+    }
+  }
+
+  if (!db.commit()) {
+    qWarning("Removing of message states from outbox failed: '%s'.", qPrintable(db.lastError().text()));
+    db.rollback();
+    return false;
+  }
+
+  return true;
+}
+
+EnclosureFile DatabaseQueries::enclosureFileFromRecord(const QSqlQuery& query) {
+  EnclosureFile file;
+
+  file.m_accountId = query.value(0).toInt();
+  file.m_feedId = query.value(1).toString();
+  file.m_url = query.value(2).toString();
+  file.m_fileName = query.value(3).toString();
+  file.m_state = static_cast<EnclosureFile::State>(query.value(4).toInt());
+  file.m_created = TextFactory::parseDateTime(query.value(5).value<qint64>());
+  return file;
+}
+
 QString DatabaseQueries::unnulifyString(const QString &str) {
   return str.isNull() ? "" : str;
 }
@@ -5,6 +5,7 @@
 
 #include "services/abstract/rootitem.h"
 
+#include "network-web/enclosureprefetcher.h"
 #include "services/abstract/serviceroot.h"
 #include "services/standard/standardfeed.h"
 
@@ -24,22 +25,20 @@ class DatabaseQueries {
     static bool deleteOrRestoreMessagesToFromBin(QSqlDatabase db, const QStringList& ids, bool deleted);
     static bool restoreBin(QSqlDatabase db, int account_id);
 
-    // Purge database.
-    static bool purgeImportantMessages(QSqlDatabase db);
-    static bool purgeReadMessages(QSqlDatabase db);
-    static bool purgeOldMessages(QSqlDatabase db, int older_than_days);
-    static bool purgeRecycleBin(QSqlDatabase db);
+    // Purge database. Messages matching given SQL condition are removed in batches
+    // of consecutive IDs, "last_id" is cursor which is advanced by each batch.
+    static int getMessagesCountForPurge(QSqlDatabase db, const QString& condition, const QVariantHash& values, bool* ok = nullptr);
+    static int purgeMessagesBatch(QSqlDatabase db, const QString& condition, const QVariantHash& values,
+                                  int batch_size, int* last_id, bool* ok = nullptr);
     static bool purgeMessagesFromBin(QSqlDatabase db, bool clear_only_read, int account_id);
     static bool purgeLeftoverMessages(QSqlDatabase db, int account_id);
 
-    // Obtain counts of unread/all messages.
-    static QMap<QString, QPair<int, int>> getMessageCountsForCategory(QSqlDatabase db, const QString& custom_id, int account_id,
-                                                                      bool including_total_counts, bool* ok = nullptr);
-    static QMap<QString, QPair<int, int>> getMessageCountsForAccount(QSqlDatabase db, int account_id,
-                                                                     bool including_total_counts, bool* ok = nullptr);
-    static int getMessageCountsForFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id,
-                                       bool including_total_counts, bool* ok = nullptr);
-    static int getMessageCountsForBin(QSqlDatabase db, int account_id, bool including_total_counts, bool* ok = nullptr);
+    // Obtain counts of unread/all messages, pairs hold unread and total counts.
+    // Counts of feeds and recycle bin of whole account are obtained with single grouped scan.
+    static QHash<int, AccountMessageCounts> getMessageCountsForAllAccounts(QSqlDatabase db, bool* ok = nullptr);
+    static AccountMessageCounts getMessageCountsForAccount(QSqlDatabase db, int account_id, bool* ok = nullptr);
+    static QPair<int, int> getMessageCountsForFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
+    static QPair<int, int> getMessageCountsForBin(QSqlDatabase db, int account_id, bool* ok = nullptr);
 
     // Get messages (for newspaper view for example).
     static QList<Message> getUndeletedMessagesForFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
@@ -51,13 +50,17 @@ class DatabaseQueries {
     static QStringList customIdsOfMessagesFromBin(QSqlDatabase db, int account_id, bool* ok = nullptr);
     static QStringList customIdsOfMessagesFromFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
 
+    // Fills images, preview and word count of messages stored by older versions,
+    // their contents are left intact. Returns count of processed messages.
+    static int processMessagesContentsBatch(QSqlDatabase db, int batch_size, bool* ok = nullptr);
+
     // Common accounts methods.
     static int updateMessages(QSqlDatabase db, const QList<Message>& messages, const QString& feed_custom_id,
                               int account_id, const QString& url, bool* any_message_changed, bool* ok = nullptr);
     static bool deleteAccount(QSqlDatabase db, int account_id);
     static bool deleteAccountData(QSqlDatabase db, int account_id, bool delete_messages_too);
     static bool cleanFeeds(QSqlDatabase db, const QStringList& ids, bool clean_read_only, int account_id);
-    static bool storeAccountTree(QSqlDatabase db, RootItem* tree_root, int account_id);
+    static bool storeAccountTreeChanges(QSqlDatabase db, const AccountTreeChanges& changes, int account_id);
     static bool editBaseFeed(QSqlDatabase db, int feed_id, Feed::AutoUpdateType auto_update_type,
                              int auto_update_interval);
     static Assignment getCategories(QSqlDatabase db, int account_id, bool* ok = nullptr);
@@ -129,7 +132,36 @@ class DatabaseQueries {
                                    bool force_server_side_feed_update);
     static Assignment getTtRssFeeds(QSqlDatabase db, int account_id, bool* ok = nullptr);
 
+    // Enclosure prefetching.
+    static EnclosurePolicy getEnclosurePolicy(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
+    static bool storeEnclosurePolicy(QSqlDatabase db, const QString& feed_custom_id, int account_id, const EnclosurePolicy& policy);
+    static EnclosureFile getEnclosureFile(QSqlDatabase db, const QString& url, int account_id, bool* ok = nullptr);
+    static QList<EnclosureFile> getEnclosureFiles(QSqlDatabase db, bool* ok = nullptr);
+    static QList<EnclosureFile> getEnclosureFilesForFeed(QSqlDatabase db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
+    static bool addEnclosureFile(QSqlDatabase db, const EnclosureFile& file);
+    static bool setEnclosureFilesState(QSqlDatabase db, int account_id, const QStringList& file_names, EnclosureFile::State state);
+
+    // Outbox of changed message states which were not confirmed by server yet.
+    static bool getMessageStatesOutbox(QSqlDatabase db, int account_id, QHash<QString, RootItem::ReadStatus>& read_states,
+                                       QHash<QString, Message>& important_states);
+    static bool storeMessageStatesToOutbox(QSqlDatabase db, int account_id, const QStringList& custom_ids, RootItem::ReadStatus read);
+    static bool storeMessageStatesToOutbox(QSqlDatabase db, int account_id, const QList<Message>& messages,
+                                           RootItem::Importance importance);
+    static bool removeMessageStatesFromOutbox(QSqlDatabase db, int account_id, const QStringList& custom_ids,
+                                              RootItem::ReadStatus read);
+    static bool removeMessageStatesFromOutbox(QSqlDatabase db, int account_id, const QStringList& custom_ids,
+                                              RootItem::Importance importance);
+
   private:
+    enum OutboxField {
+      OutboxRead = 0,
+      OutboxImportant = 1
+    };
+
+    static bool storeOutboxStates(QSqlDatabase db, int account_id, int field, int value, const QList<Message>& messages);
+    static bool removeOutboxStates(QSqlDatabase db, int account_id, int field, int value, const QStringList& custom_ids);
+    static void addMessageCounts(AccountMessageCounts& counts, const QSqlQuery& query, int first_column);
+    static EnclosureFile enclosureFileFromRecord(const QSqlQuery& query);
     static QString unnulifyString(const QString& str);
 
     explicit DatabaseQueries();
@@ -9,7 +9,10 @@
 #include "core/messagesproxymodel.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasecleaner.h"
+#include "miscellaneous/databasequeries.h"
 #include "miscellaneous/mutex.h"
+#include "network-web/enclosureprefetcher.h"
+#include "network-web/imageprefetcher.h"
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/serviceroot.h"
 #include "services/gmail/gmailentrypoint.h"
@@ -25,15 +28,22 @@
 FeedReader::FeedReader(QObject* parent)
   : QObject(parent), m_feedServices(QList<ServiceEntryPoint*>()),
   m_autoUpdateTimer(new QTimer(this)), m_feedDownloader(nullptr),
-  m_dbCleanerThread(nullptr), m_dbCleaner(nullptr) {
+  m_dbCleanerThread(nullptr), m_dbCleaner(nullptr), m_autoCleanupTimer(new QTimer(this)),
+  m_autoCleanupRunning(false), m_imagePrefetcher(new ImagePrefetcher(this)),
+  m_enclosurePrefetcher(new EnclosurePrefetcher(this)), m_cacheSaveWatcher(new QFutureWatcher<void>(this)),
+  m_contentsProcessWatcher(new QFutureWatcher<void>(this)), m_contentsProcessCancelled(0) {
   m_feedsModel = new FeedsModel(this);
   m_feedsProxyModel = new FeedsProxyModel(m_feedsModel, this);
   m_messagesModel = new MessagesModel(this);
   m_messagesProxyModel = new MessagesProxyModel(m_messagesModel, this);
 
   connect(m_autoUpdateTimer, &QTimer::timeout, this, &FeedReader::executeNextAutoUpdate);
+  connect(m_autoCleanupTimer, &QTimer::timeout, this, &FeedReader::executeAutoCleanup);
+  connect(m_cacheSaveWatcher, &QFutureWatcher<void>::finished, this, &FeedReader::cachedDataSent);
+  m_autoCleanupTimer->start(APP_DB_CLEANUP_CHECK_INTERVAL);
   updateAutoUpdateStatus();
   asyncCacheSaveFinished();
+  QTimer::singleShot(MSG_BACKFILL_DELAY, this, &FeedReader::processOldMessagesContents);
 
   if (qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::FeedsUpdateOnStartup)).toBool()) {
     qDebug("Requesting update for all feeds on application startup.");
@@ -74,11 +84,18 @@ void FeedReader::updateFeeds(const QList<Feed*>& feeds) {
 
     // Downloader setup.
     qRegisterMetaType<QList<Feed*>>("QList<Feed*>");
+    qRegisterMetaType<QList<QUrl>>("QList<QUrl>");
+    qRegisterMetaType<QList<Message>>("QList<Message>");
 
     connect(m_feedDownloader, &FeedDownloader::updateFinished, this, &FeedReader::feedUpdatesFinished);
     connect(m_feedDownloader, &FeedDownloader::updateProgress, this, &FeedReader::feedUpdatesProgress);
     connect(m_feedDownloader, &FeedDownloader::updateStarted, this, &FeedReader::feedUpdatesStarted);
     connect(m_feedDownloader, &FeedDownloader::updateFinished, qApp->feedUpdateLock(), &Mutex::unlock);
+    connect(m_feedDownloader, &FeedDownloader::imagesFound, m_imagePrefetcher, &ImagePrefetcher::prefetch);
+    connect(m_feedDownloader, &FeedDownloader::enclosuresFound, m_enclosurePrefetcher, &EnclosurePrefetcher::prefetch);
+
+    // Failed enclosure downloads are retried after each update.
+    connect(m_feedDownloader, &FeedDownloader::updateFinished, m_enclosurePrefetcher, &EnclosurePrefetcher::resumePendingDownloads);
   }
 
   QMetaObject::invokeMethod(m_feedDownloader, "updateFeeds", Q_ARG(QList<Feed*>, feeds));
@@ -142,6 +159,7 @@ DatabaseCleaner* FeedReader::databaseCleaner() {
     qRegisterMetaType<CleanerOrders>("CleanerOrders");
     m_dbCleaner->moveToThread(m_dbCleanerThread);
     connect(m_dbCleanerThread, SIGNAL(finished()), m_dbCleanerThread, SLOT(deleteLater()));
+    connect(m_dbCleaner, &DatabaseCleaner::purgeFinished, this, &FeedReader::autoCleanupFinished);
 
     // Connections are made, start the feed downloader thread.
     m_dbCleanerThread->start();
@@ -150,6 +168,51 @@ DatabaseCleaner* FeedReader::databaseCleaner() {
   return m_dbCleaner;
 }
 
+void FeedReader::executeAutoCleanup() {
+  Settings* settings = qApp->settings();
+
+  if (!settings->value(GROUP(Database), SETTING(Database::AutoCleanupEnabled)).toBool()) {
+    return;
+  }
+
+  const QDateTime last_cleanup = settings->value(GROUP(Database), SETTING(Database::LastAutoCleanupOn)).toDateTime();
+
+  if (last_cleanup.isValid() && last_cleanup.addDays(APP_DB_CLEANUP_INTERVAL_DAYS) > QDateTime::currentDateTimeUtc()) {
+    return;
+  }
+
+  // Cleanup runs only when user does not work with the application
+  // and no other critical operation is ongoing.
+  if (qApp->applicationState() == Qt::ApplicationActive || qApp->feedUpdateLock()->isLocked() ||
+      (m_dbCleaner != nullptr && m_dbCleaner->isRunning())) {
+    return;
+  }
+
+  CleanerOrders orders;
+  const int older_than = settings->value(GROUP(Database), SETTING(Database::AutoCleanupOlderThan)).toInt();
+
+  orders.m_removeReadMessages = settings->value(GROUP(Database), SETTING(Database::AutoCleanupReadMessages)).toBool();
+  orders.m_removeRecycleBin = settings->value(GROUP(Database), SETTING(Database::AutoCleanupRecycleBin)).toBool();
+  orders.m_removeOldMessages = older_than > 0;
+  orders.m_barrierForRemovingOldMessagesInDays = older_than;
+  orders.m_removeStarredMessages = false;
+
+  // Full vacuum rebuilds whole database, so only cheap incremental one is done.
+  orders.m_shrinkDatabase = qApp->database()->incrementalVacuumPagesCount() >= 0;
+
+  qDebug("Starting automatic database cleanup.");
+  m_autoCleanupRunning = true;
+  settings->setValue(GROUP(Database), Database::LastAutoCleanupOn, QDateTime::currentDateTimeUtc());
+  QMetaObject::invokeMethod(databaseCleaner(), "purgeDatabaseData", Qt::QueuedConnection, Q_ARG(CleanerOrders, orders));
+}
+
+void FeedReader::autoCleanupFinished() {
+  if (m_autoCleanupRunning) {
+    m_autoCleanupRunning = false;
+    m_feedsModel->reloadCountsOfWholeModel();
+  }
+}
+
 FeedDownloader* FeedReader::feedDownloader() const {
   return m_feedDownloader;
 }
@@ -200,23 +263,71 @@ void FeedReader::executeNextAutoUpdate() {
 }
 
 void FeedReader::checkServicesForAsyncOperations() {
+  QList<CacheForServiceRoot*> caches;
+
   foreach (ServiceRoot* service, m_feedsModel->serviceRoots()) {
     auto cache = dynamic_cast<CacheForServiceRoot*>(service);
 
-    if (cache != nullptr) {
+    if (cache != nullptr && cache->hasCachedStatesToSend()) {
+      caches.append(cache);
+    }
+  }
+
+  if (caches.isEmpty()) {
+    asyncCacheSaveFinished();
+    return;
+  }
+
+  // Only accounts whose data are sent cannot be edited or removed,
+  // feed updates and other accounts are not blocked meanwhile.
+  foreach (CacheForServiceRoot* cache, caches) {
+    cache->setSendingCachedData(true);
+  }
+
+  m_sendingCaches = caches;
+
+  // Server confirms each batch, do not block GUI meanwhile.
+  m_cacheSaveWatcher->setFuture(QtConcurrent::run([caches] {
+    foreach (CacheForServiceRoot* cache, caches) {
       cache->saveAllCachedData();
     }
+  }));
+}
+
+void FeedReader::cachedDataSent() {
+  foreach (CacheForServiceRoot* cache, m_sendingCaches) {
+    cache->setSendingCachedData(false);
   }
 
+  m_sendingCaches.clear();
   asyncCacheSaveFinished();
 }
 
 void FeedReader::asyncCacheSaveFinished() {
-  qDebug("I will start next check for cached service data in 30 seconds.");
-  QTimer::singleShot(60000, [&] {
-    qDebug("Starting next check for cached service data in NOW.");
-    checkServicesForAsyncOperations();
-  });
+  qDebug("I will start next check for cached service data in %d seconds.", CACHED_STATES_CHECK_INTERVAL / 1000);
+  QTimer::singleShot(CACHED_STATES_CHECK_INTERVAL, this, &FeedReader::checkServicesForAsyncOperations);
+}
+
+void FeedReader::processOldMessagesContents() {
+  m_contentsProcessWatcher->setFuture(QtConcurrent::run([this] {
+    QSqlDatabase database = qApp->database()->connection(QSL("FeedReader"), DatabaseFactory::FromSettings);
+    int processed = 0;
+    int batch;
+    bool ok = true;
+
+    // Batches are small, so that feed updates are not blocked for long.
+    do {
+      batch = DatabaseQueries::processMessagesContentsBatch(database, MSG_BACKFILL_BATCH_SIZE, &ok);
+      processed += batch;
+    } while (ok && batch > 0 && m_contentsProcessCancelled.load() == 0);
+
+    if (!ok) {
+      qWarning("Processing of contents of messages stored by older version failed.");
+    }
+    else if (processed > 0) {
+      qDebug("Contents of %d messages stored by older version were processed.", processed);
+    }
+  }));
 }
 
 void FeedReader::quit() {
@@ -224,6 +335,19 @@ void FeedReader::quit() {
     m_autoUpdateTimer->stop();
   }
 
+  m_autoCleanupTimer->stop();
+
+  if (m_cacheSaveWatcher->isRunning()) {
+    qDebug("Waiting for cached service data to be sent.");
+    m_cacheSaveWatcher->waitForFinished();
+  }
+
+  if (m_contentsProcessWatcher->isRunning()) {
+    qDebug("Stopping processing of contents of old messages.");
+    m_contentsProcessCancelled.store(1);
+    m_contentsProcessWatcher->waitForFinished();
+  }
+
   // Stop running updates.
   if (m_feedDownloader != nullptr) {
     m_feedDownloader->stopRunningUpdate();
@@ -238,6 +362,7 @@ void FeedReader::quit() {
 
   if (m_dbCleanerThread != nullptr && m_dbCleanerThread->isRunning()) {
     qDebug("Quitting database cleaner thread.");
+    m_dbCleaner->cancel();
     m_dbCleanerThread->quit();
 
     if (!m_dbCleanerThread->wait(CLOSE_LOCK_TIMEOUT)) {
@@ -268,6 +393,10 @@ MessagesProxyModel* FeedReader::messagesProxyModel() const {
   return m_messagesProxyModel;
 }
 
+EnclosurePrefetcher* FeedReader::enclosurePrefetcher() const {
+  return m_enclosurePrefetcher;
+}
+
 FeedsProxyModel* FeedReader::feedsProxyModel() const {
   return m_feedsProxyModel;
 }
@@ -8,14 +8,18 @@
 #include "core/feeddownloader.h"
 #include "services/abstract/feed.h"
 
+#include <QAtomicInt>
 #include <QFutureWatcher>
 
+class CacheForServiceRoot;
 class FeedsModel;
 class MessagesModel;
 class MessagesProxyModel;
 class FeedsProxyModel;
 class ServiceEntryPoint;
 class DatabaseCleaner;
+class EnclosurePrefetcher;
+class ImagePrefetcher;
 class QTimer;
 
 class FeedReader : public QObject {
@@ -36,6 +40,7 @@ class FeedReader : public QObject {
     MessagesModel* messagesModel() const;
     FeedsProxyModel* feedsProxyModel() const;
     MessagesProxyModel* messagesProxyModel() const;
+    EnclosurePrefetcher* enclosurePrefetcher() const;
 
     // Schedules given feeds for update.
     void updateFeeds(const QList<Feed*>& feeds);
@@ -63,8 +68,18 @@ class FeedReader : public QObject {
     // Is executed when next auto-update round could be done.
     void executeNextAutoUpdate();
     void checkServicesForAsyncOperations();
+
+    // Runs automatic database cleanup according to retention settings
+    // if application is idle.
+    void executeAutoCleanup();
+    void autoCleanupFinished();
+    void cachedDataSent();
     void asyncCacheSaveFinished();
 
+    // Processes contents of messages stored by older versions in background,
+    // so that they are not processed each time they are displayed.
+    void processOldMessagesContents();
+
   signals:
     void feedUpdatesStarted();
     void feedUpdatesFinished(FeedDownloadResults updated_feeds);
@@ -86,6 +101,14 @@ class FeedReader : public QObject {
     FeedDownloader* m_feedDownloader;
     QThread* m_dbCleanerThread;
     DatabaseCleaner* m_dbCleaner;
+    QTimer* m_autoCleanupTimer;
+    bool m_autoCleanupRunning;
+    ImagePrefetcher* m_imagePrefetcher;
+    EnclosurePrefetcher* m_enclosurePrefetcher;
+    QFutureWatcher<void>* m_cacheSaveWatcher;
+    QList<CacheForServiceRoot*> m_sendingCaches;
+    QFutureWatcher<void>* m_contentsProcessWatcher;
+    QAtomicInt m_contentsProcessCancelled;
 };
 
 #endif // FEEDREADER_H
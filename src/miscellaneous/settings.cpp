@@ -9,6 +9,8 @@
 #include <QLocale>
 #include <QPointer>
 
+#include <algorithm>
+
 DKEY WebEngineAttributes::ID = "web_engine_attributes";
 
 // AdBlock.
@@ -247,9 +249,23 @@ DKEY Downloads::ShowDownloadsWhenNewDownloadStarts = "show_downloads_on_new_down
 
 DVALUE(bool) Downloads::ShowDownloadsWhenNewDownloadStartsDef = true;
 
+DKEY Downloads::MaxConcurrentDownloads = "max_concurrent_downloads";
+
+DVALUE(int) Downloads::MaxConcurrentDownloadsDef = 3;
+
+DKEY Downloads::MaxDownloadSpeed = "max_download_speed";
+
+DVALUE(int) Downloads::MaxDownloadSpeedDef = 0;
+
+DKEY Downloads::DownloadSegments = "download_segments";
+
+DVALUE(int) Downloads::DownloadSegmentsDef = 4;
+
 DKEY Downloads::ItemUrl = "download_%1_url";
 DKEY Downloads::ItemLocation = "download_%1_location";
 DKEY Downloads::ItemDone = "download_%1_done";
+DKEY Downloads::ItemOffset = "download_%1_offset";
+DKEY Downloads::ItemValidator = "download_%1_validator";
 
 // Proxy.
 DKEY Proxy::ID = "proxy";
@@ -307,6 +323,26 @@ DKEY Database::ActiveDriver = "database_driver";
 
 DVALUE(char*) Database::ActiveDriverDef = APP_DB_SQLITE_DRIVER;
 
+DKEY Database::AutoCleanupEnabled = "auto_cleanup_enabled";
+
+DVALUE(bool) Database::AutoCleanupEnabledDef = false;
+
+DKEY Database::AutoCleanupOlderThan = "auto_cleanup_older_than";
+
+DVALUE(int) Database::AutoCleanupOlderThanDef = 0;
+
+DKEY Database::AutoCleanupReadMessages = "auto_cleanup_read_messages";
+
+DVALUE(bool) Database::AutoCleanupReadMessagesDef = false;
+
+DKEY Database::AutoCleanupRecycleBin = "auto_cleanup_recycle_bin";
+
+DVALUE(bool) Database::AutoCleanupRecycleBinDef = true;
+
+DKEY Database::LastAutoCleanupOn = "last_auto_cleanup_on";
+
+DVALUE(QDateTime) Database::LastAutoCleanupOnDef = QDateTime();
+
 // Keyboard.
 DKEY Keyboard::ID = "keyboard";
 
@@ -352,9 +388,81 @@ DVALUE(QStringList) Browser::ExternalToolsDef = QStringList();
 DKEY CategoriesExpandStates::ID = "categories_expand_states";
 
 Settings::Settings(const QString& file_name, Format format, const SettingsProperties::SettingsType& status, QObject* parent)
-  : QSettings(file_name, format, parent), m_initializationStatus(status) {}
+  : QSettings(file_name, format, parent), m_initializationStatus(status), m_snapshot(nullptr) {
+#if !defined(QT_NO_DEBUG)
+  m_totalReads = 0;
+#endif
+
+  m_snapshotKeys << QString(QSL("%1/%2")).arg(GROUP(Database), Database::UseTransactions)
+                 << QString(QSL("%1/%2")).arg(GROUP(Feeds), Feeds::UpdateTimeout)
+                 << QString(QSL("%1/%2")).arg(GROUP(Messages), Messages::MessageHeadImageHeight);
+  rebuildSnapshot();
+}
+
+Settings::~Settings() {
+#if !defined(QT_NO_DEBUG)
+  qDebug("Settings were read %d times in total.", m_totalReads);
+#endif
+
+  delete m_snapshot.loadAcquire();
+  qDeleteAll(m_retiredSnapshots);
+}
 
-Settings::~Settings() {}
+void Settings::updateSnapshot(const QString& full_key) {
+  // Whole group might be removed, so check prefixes too.
+  foreach (const QString& snapshot_key, m_snapshotKeys) {
+    if (snapshot_key == full_key || snapshot_key.startsWith(full_key + QL1C('/')) || full_key.isEmpty()) {
+      rebuildSnapshot();
+      return;
+    }
+  }
+}
+
+void Settings::rebuildSnapshot() {
+  SettingsSnapshot* snapshot = new SettingsSnapshot();
+
+  snapshot->m_useTransactions = value(GROUP(Database), SETTING(Database::UseTransactions)).toBool();
+  snapshot->m_feedUpdateTimeout = value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  snapshot->m_messageHeadImageHeight = value(GROUP(Messages), SETTING(Messages::MessageHeadImageHeight)).toInt();
+
+  QMutexLocker locker(&m_snapshotMutex);
+
+  // Readers may still hold older snapshot, keep it alive. Snapshots
+  // are tiny and only change when user alters settings.
+  const SettingsSnapshot* old_snapshot = m_snapshot.fetchAndStoreOrdered(snapshot);
+
+  if (old_snapshot != nullptr) {
+    m_retiredSnapshots.append(old_snapshot);
+  }
+}
+
+#if !defined(QT_NO_DEBUG)
+void Settings::countRead(const QString& full_key) const {
+  QMutexLocker locker(&m_readCountsMutex);
+
+  m_readCounts[full_key]++;
+
+  if (++m_totalReads % SETTINGS_READ_REPORT_INTERVAL == 0) {
+    QList<QPair<int, QString>> counts;
+
+    for (QHash<QString, int>::const_iterator i = m_readCounts.constBegin(); i != m_readCounts.constEnd(); i++) {
+      counts.append(QPair<int, QString>(i.value(), i.key()));
+    }
+
+    std::sort(counts.begin(), counts.end(), [](const QPair<int, QString>& lhs, const QPair<int, QString>& rhs) {
+      return lhs.first > rhs.first;
+    });
+
+    QStringList hottest;
+
+    for (int i = 0; i < qMin(counts.size(), SETTINGS_READ_REPORT_KEYS); i++) {
+      hottest.append(QString(QSL("%1 (%2x)")).arg(counts.at(i).second, QString::number(counts.at(i).first)));
+    }
+
+    qDebug("Settings were read %d times, most read keys: %s.", m_totalReads, qPrintable(hottest.join(QSL(", "))));
+  }
+}
+#endif
 
 QString Settings::pathName() const {
   return QFileInfo(fileName()).absolutePath();
@@ -9,9 +9,12 @@
 
 #include "miscellaneous/settingsproperties.h"
 
+#include <QAtomicPointer>
 #include <QByteArray>
 #include <QColor>
 #include <QDateTime>
+#include <QHash>
+#include <QMutex>
 #include <QNetworkProxy>
 #include <QStringList>
 
@@ -273,9 +276,23 @@ namespace Downloads {
 
   VALUE(bool) ShowDownloadsWhenNewDownloadStartsDef;
 
+  KEY MaxConcurrentDownloads;
+
+  VALUE(int) MaxConcurrentDownloadsDef;
+
+  KEY MaxDownloadSpeed;
+
+  VALUE(int) MaxDownloadSpeedDef;
+
+  KEY DownloadSegments;
+
+  VALUE(int) DownloadSegmentsDef;
+
   KEY ItemUrl;
   KEY ItemLocation;
   KEY ItemDone;
+  KEY ItemOffset;
+  KEY ItemValidator;
 }
 
 // Proxy.
@@ -336,6 +353,26 @@ namespace Database {
   KEY ActiveDriver;
 
   VALUE(char*) ActiveDriverDef;
+
+  KEY AutoCleanupEnabled;
+
+  VALUE(bool) AutoCleanupEnabledDef;
+
+  KEY AutoCleanupOlderThan;
+
+  VALUE(int) AutoCleanupOlderThanDef;
+
+  KEY AutoCleanupReadMessages;
+
+  VALUE(bool) AutoCleanupReadMessagesDef;
+
+  KEY AutoCleanupRecycleBin;
+
+  VALUE(bool) AutoCleanupRecycleBinDef;
+
+  KEY LastAutoCleanupOn;
+
+  VALUE(QDateTime) LastAutoCleanupOnDef;
 }
 
 // Keyboard.
@@ -388,6 +425,16 @@ namespace CategoriesExpandStates {
   KEY ID;
 }
 
+// Immutable, typed copy of settings which are read on hot paths,
+// possibly from worker threads. New copy is published each time
+// any of covered settings changes, old copies stay valid until
+// settings are destroyed.
+struct SettingsSnapshot {
+  bool m_useTransactions;
+  int m_feedUpdateTimeout;
+  int m_messageHeadImageHeight;
+};
+
 class Settings : public QSettings {
   Q_OBJECT
 
@@ -403,15 +450,25 @@ class Settings : public QSettings {
 
     // Getters/setters for settings values.
     inline QVariant value(const QString& section, const QString& key, const QVariant& default_value = QVariant()) const {
-      return QSettings::value(QString(QSL("%1/%2")).arg(section, key), default_value);
+      const QString full_key = QString(QSL("%1/%2")).arg(section, key);
+
+#if !defined(QT_NO_DEBUG)
+      countRead(full_key);
+#endif
+
+      return QSettings::value(full_key, default_value);
     }
 
     inline void setValue(const QString& section, const QString& key, const QVariant& value) {
-      QSettings::setValue(QString(QSL("%1/%2")).arg(section, key), value);
+      const QString full_key = QString(QSL("%1/%2")).arg(section, key);
+
+      QSettings::setValue(full_key, value);
+      updateSnapshot(full_key);
     }
 
     inline void setValue(const QString& key, const QVariant& value) {
       QSettings::setValue(key, value);
+      updateSnapshot(key);
     }
 
     inline bool contains(const QString& section, const QString& key) const {
@@ -419,7 +476,17 @@ class Settings : public QSettings {
     }
 
     inline void remove(const QString& section, const QString& key) {
-      QSettings::remove(QString(QSL("%1/%2")).arg(section, key));
+      const QString full_key = QString(QSL("%1/%2")).arg(section, key);
+
+      QSettings::remove(full_key);
+      updateSnapshot(full_key);
+    }
+
+    // Returns current snapshot of hot-path settings. Reading it
+    // is lock-free and returned reference stays valid for
+    // whole lifetime of settings.
+    inline const SettingsSnapshot& snapshot() const {
+      return *m_snapshot.loadAcquire();
     }
 
     // Returns the path which contains the settings.
@@ -442,7 +509,25 @@ class Settings : public QSettings {
     // Constructor.
     explicit Settings(const QString& file_name, Format format, const SettingsProperties::SettingsType& type, QObject* parent = 0);
 
+    // Rebuilds and publishes snapshot if given key is covered by it.
+    void updateSnapshot(const QString& full_key);
+    void rebuildSnapshot();
+
+#if !defined(QT_NO_DEBUG)
+    void countRead(const QString& full_key) const;
+#endif
+
     SettingsProperties::SettingsType m_initializationStatus;
+    QAtomicPointer<const SettingsSnapshot> m_snapshot;
+    QList<const SettingsSnapshot*> m_retiredSnapshots;
+    QMutex m_snapshotMutex;
+    QStringList m_snapshotKeys;
+
+#if !defined(QT_NO_DEBUG)
+    mutable QMutex m_readCountsMutex;
+    mutable QHash<QString, int> m_readCounts;
+    mutable int m_totalReads;
+#endif
 };
 
 #endif // SETTINGS_H
@@ -118,6 +118,119 @@ QString TextFactory::shorten(const QString& input, int text_length_limit) {
   }
 }
 
+QString TextFactory::decodePercentEncoding(const QString& input) {
+  return normalizeText(input, false);
+}
+
+QString TextFactory::normalizeTitle(const QString& input) {
+  return normalizeText(input, true);
+}
+
+static inline int hexDigitValue(ushort character) {
+  if (character >= '0' && character <= '9') {
+    return character - '0';
+  }
+  else if (character >= 'a' && character <= 'f') {
+    return character - 'a' + 10;
+  }
+  else if (character >= 'A' && character <= 'F') {
+    return character - 'A' + 10;
+  }
+  else {
+    return -1;
+  }
+}
+
+QString TextFactory::normalizeText(const QString& input, bool sanitize_white_space) {
+  const bool has_percent = input.contains(QL1C('%'));
+
+  if (!has_percent && !sanitize_white_space) {
+    return input;
+  }
+
+  const QChar* data = input.constData();
+  const int length = input.size();
+  QString output;
+  QByteArray pending_bytes;
+  int white_space_run = 0;
+  QChar white_space_first;
+
+  output.reserve(length);
+
+  // Emits white space which was collected so far. Runs of two or more white space
+  // characters are replaced with single space, lonely newlines are dropped
+  // and leading white space is dropped completely.
+  auto flush_white_space = [&]() {
+    if (white_space_run == 0) {
+      return;
+    }
+
+    if (!output.isEmpty()) {
+      if (white_space_run > 1) {
+        output.append(QL1C(' '));
+      }
+      else if (white_space_first != QL1C('\n') && white_space_first != QL1C('\r')) {
+        output.append(white_space_first);
+      }
+    }
+
+    white_space_run = 0;
+  };
+
+  auto push_character = [&](QChar character) {
+    if (!sanitize_white_space) {
+      output.append(character);
+    }
+    else if (character.isSpace()) {
+      if (white_space_run++ == 0) {
+        white_space_first = character;
+      }
+    }
+    else {
+      flush_white_space();
+      output.append(character);
+    }
+  };
+
+  // Decoded bytes are collected until the percent-encoded run ends
+  // so that multi-byte UTF-8 sequences are decoded as whole.
+  auto flush_pending_bytes = [&]() {
+    if (pending_bytes.isEmpty()) {
+      return;
+    }
+
+    const QString decoded = QString::fromUtf8(pending_bytes);
+
+    for (const QChar& character : decoded) {
+      push_character(character);
+    }
+
+    pending_bytes.clear();
+  };
+
+  for (int i = 0; i < length; i++) {
+    const QChar character = data[i];
+
+    if (has_percent && character == QL1C('%') && i + 2 < length) {
+      const int high = hexDigitValue(data[i + 1].unicode());
+      const int low = hexDigitValue(data[i + 2].unicode());
+
+      if (high >= 0 && low >= 0) {
+        pending_bytes.append(char((high << 4) | low));
+        i += 2;
+        continue;
+      }
+    }
+
+    flush_pending_bytes();
+    push_character(character);
+  }
+
+  flush_pending_bytes();
+  flush_white_space();
+  return output;
+}
+
 quint64 TextFactory::initializeSecretEncryptionKey() {
   if (s_encryptionKey == 0x0) {
     // Check if file with encryption key exists.
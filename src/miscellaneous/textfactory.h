@@ -38,7 +38,17 @@ class TextFactory {
     // Shortens input string according to given length limit.
     static QString shorten(const QString& input, int text_length_limit = TEXT_TITLE_LIMIT);
 
+    // Decodes percent-encoded UTF-8 sequences in single pass.
+    // NOTE: Input is returned untouched if it does not contain any '%' character.
+    static QString decodePercentEncoding(const QString& input);
+
+    // Decodes percent-encoded sequences, replaces all continuous white space with
+    // single space and removes all newlines and leading white space.
+    // Everything is done in single linear scan of the input.
+    static QString normalizeTitle(const QString& input);
+
   private:
+    static QString normalizeText(const QString& input, bool sanitize_white_space);
     static quint64 initializeSecretEncryptionKey();
     static quint64 generateSecretEncryptionKey();
     static quint64 s_encryptionKey;
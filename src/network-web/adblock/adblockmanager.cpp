@@ -30,10 +30,11 @@
 
 #include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QMessageBox>
-#include <QMutexLocker>
 #include <QSaveFile>
 #include <QTextStream>
+#include <QThreadPool>
 #include <QTimer>
 #include <QUrlQuery>
 #include <QWebEngineProfile>
@@ -41,8 +42,19 @@
 
 Q_GLOBAL_STATIC(AdBlockManager, qz_adblock_manager)
 
+// Upper bounds (in microseconds) of match latency histogram buckets,
+// last bucket collects everything slower.
+static const qint64 kMatchLatencyBounds[ADBLOCK_LATENCY_BUCKETS - 1] = { 5, 10, 25, 50, 100, 500, 1000 };
+
 AdBlockManager::AdBlockManager(QObject* parent)
-  : QObject(parent), m_loaded(false), m_enabled(true), m_matcher(new AdBlockMatcher(this)), m_interceptor(new AdBlockUrlInterceptor(this)) {
+  : QObject(parent), m_loaded(false), m_enabled(true), m_matcher(new AdBlockMatcher()), m_activeReaders(0),
+  m_retireTimer(new QTimer(this)), m_matcherBuildRunning(false), m_matcherBuildPending(false), m_matcherGeneration(0), m_matchedRequests(0),
+  m_interceptor(new AdBlockUrlInterceptor(this)) {
+  qRegisterMetaType<AdBlockMatcher*>("AdBlockMatcher*");
+
+  m_retireTimer->setInterval(ADBLOCK_MATCHER_RETIRE_INTERVAL);
+  connect(m_retireTimer, &QTimer::timeout, this, &AdBlockManager::deleteRetiredMatchers);
+
   load();
   m_adblockIcon = new AdBlockIcon(this);
   m_adblockIcon->setObjectName(QSL("m_adblockIconAction"));
@@ -50,6 +62,8 @@ AdBlockManager::AdBlockManager(QObject* parent)
 
 AdBlockManager::~AdBlockManager() {
   qDeleteAll(m_subscriptions);
+  qDeleteAll(m_retiredMatchers);
+  delete m_matcher.load();
 }
 
 AdBlockManager* AdBlockManager::instance() {
@@ -67,13 +81,11 @@ void AdBlockManager::setEnabled(bool enabled) {
   qApp->settings()->setValue(GROUP(AdBlock), AdBlock::AdBlockEnabled, m_enabled);
   load();
 
-  QMutexLocker locker(&m_mutex);
-
   if (m_enabled) {
-    m_matcher->update();
+    updateMatcher();
   }
   else {
-    m_matcher->clear();
+    publishMatcher(new AdBlockMatcher());
   }
 }
 
@@ -82,52 +94,90 @@ QList<AdBlockSubscription*> AdBlockManager::subscriptions() const {
 }
 
 bool AdBlockManager::block(QWebEngineUrlRequestInfo& request) {
-  QMutexLocker locker(&m_mutex);
-
   if (!isEnabled()) {
     return false;
   }
 
-  const QString urlString = request.requestUrl().toEncoded().toLower();
-  const QString urlDomain = request.requestUrl().host().toLower();
-  const QString urlScheme = request.requestUrl().scheme().toLower();
+  const QUrl request_url = request.requestUrl();
 
-  if (!canRunOnScheme(urlScheme) || !canBeBlocked(request.firstPartyUrl())) {
+  // QUrl keeps scheme and host normalized to lowercase.
+  if (!canRunOnScheme(request_url.scheme())) {
     return false;
   }
 
-  bool res = false;
-  const AdBlockRule* blockedRule = m_matcher->match(request, urlDomain, urlString);
+  QElapsedTimer tmr;
 
-  if (blockedRule) {
-    if (request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame) {
-      QUrlQuery query;
-      QUrl url(QSL("rssguard:adblockedpage"));
+  tmr.start();
 
-      query.addQueryItem(QSL("rule"), blockedRule->filter());
-      query.addQueryItem(QSL("subscription"), blockedRule->subscription()->title());
-      url.setQuery(query);
-      request.redirect(url);
-    }
-    else {
-      res = true;
-      request.block(true);
+  // This method is called from network thread, matcher snapshot must stay
+  // alive until we are done with it.
+  m_activeReaders.ref();
+
+  const AdBlockMatcher* matcher = m_matcher.loadAcquire();
+  bool res = false;
+
+  if (canBeBlocked(matcher, request.firstPartyUrl())) {
+    const QString urlString = QString::fromUtf8(request_url.toEncoded().toLower());
+    const QString urlDomain = request_url.host();
+    const AdBlockRule* blockedRule = matcher->match(request, urlDomain, urlString);
+
+    if (blockedRule) {
+      if (request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame) {
+        QUrlQuery query;
+        QUrl url(QSL("rssguard:adblockedpage"));
+
+        query.addQueryItem(QSL("rule"), blockedRule->filter());
+        query.addQueryItem(QSL("subscription"), matcher->subscriptionTitle(blockedRule));
+        url.setQuery(query);
+        request.redirect(url);
+      }
+      else {
+        res = true;
+        request.block(true);
+      }
     }
   }
 
+  m_activeReaders.deref();
+  recordMatchLatency(tmr.nsecsElapsed());
   return res;
 }
 
-QStringList AdBlockManager::disabledRules() const {
+void AdBlockManager::recordMatchLatency(qint64 nsecs) {
+  const qint64 usecs = nsecs / 1000;
+  int bucket = 0;
+
+  while (bucket < ADBLOCK_LATENCY_BUCKETS - 1 && usecs > kMatchLatencyBounds[bucket]) {
+    bucket++;
+  }
+
+  m_matchLatencies[bucket].ref();
+
+  if (m_matchedRequests.fetchAndAddRelaxed(1) % ADBLOCK_LATENCY_REPORT_INTERVAL == ADBLOCK_LATENCY_REPORT_INTERVAL - 1) {
+    QStringList histogram;
+
+    for (int i = 0; i < ADBLOCK_LATENCY_BUCKETS; i++) {
+      const QString bound = i < ADBLOCK_LATENCY_BUCKETS - 1
+                            ? QSL("<=%1").arg(kMatchLatencyBounds[i])
+                            : QSL(">%1").arg(kMatchLatencyBounds[i - 1]);
+
+      histogram.append(QSL("%1 us: %2").arg(bound, QString::number(m_matchLatencies[i].load())));
+    }
+
+    qDebug("AdBlock match latency histogram: %s.", qPrintable(histogram.join(QSL(", "))));
+  }
+}
+
+QSet<QString> AdBlockManager::disabledRules() const {
   return m_disabledRules;
 }
 
 void AdBlockManager::addDisabledRule(const QString& filter) {
-  m_disabledRules.append(filter);
+  m_disabledRules.insert(filter);
 }
 
 void AdBlockManager::removeDisabledRule(const QString& filter) {
-  m_disabledRules.removeOne(filter);
+  m_disabledRules.remove(filter);
 }
 
 bool AdBlockManager::addSubscriptionFromUrl(const QUrl& url) {
@@ -192,15 +242,16 @@ AdBlockSubscription* AdBlockManager::addSubscription(const QString& title, const
 }
 
 bool AdBlockManager::removeSubscription(AdBlockSubscription* subscription) {
-  QMutexLocker locker(&m_mutex);
-
   if (!m_subscriptions.contains(subscription) || !subscription->canBeRemoved()) {
     return false;
   }
 
   QFile(subscription->filePath()).remove();
+  QFile(subscription->cacheFilePath()).remove();
   m_subscriptions.removeOne(subscription);
-  m_matcher->update();
+  updateMatcher();
+
+  // Matcher works with copies of rules, so subscription can go away right now.
   delete subscription;
   return true;
 }
@@ -222,14 +273,12 @@ QString AdBlockManager::storedListsPath() {
 }
 
 void AdBlockManager::load() {
-  QMutexLocker locker(&m_mutex);
-
   if (m_loaded) {
     return;
   }
 
   m_enabled = qApp->settings()->value(GROUP(AdBlock), SETTING(AdBlock::AdBlockEnabled)).toBool();
-  m_disabledRules = qApp->settings()->value(GROUP(AdBlock), SETTING(AdBlock::DisabledRules)).toStringList();
+  m_disabledRules = qApp->settings()->value(GROUP(AdBlock), SETTING(AdBlock::DisabledRules)).toStringList().toSet();
   QDateTime lastUpdate = qApp->settings()->value(GROUP(AdBlock), SETTING(AdBlock::LastUpdatedOn)).toDateTime();
 
   if (!m_enabled) {
@@ -288,15 +337,71 @@ void AdBlockManager::load() {
     QTimer::singleShot(1000 * 60, this, SLOT(updateAllSubscriptions()));
   }
 
-  m_matcher->update();
+  updateMatcher();
   m_loaded = true;
   qApp->urlIinterceptor()->installUrlInterceptor(m_interceptor);
 }
 
 void AdBlockManager::updateMatcher() {
-  QMutexLocker locker(&m_mutex);
+  // Requests are blocked by the previous matcher until the new one
+  // is built. Multiple requests for rebuild are coalesced into one.
+  if (m_matcherBuildRunning) {
+    m_matcherBuildPending = true;
+    return;
+  }
+
+  AdBlockMatcherBuilder* builder = new AdBlockMatcherBuilder(m_subscriptions);
+  const int generation = ++m_matcherGeneration;
+
+  // Builder deletes itself before its result is delivered, so
+  // the result is recognized by generation of the build.
+  connect(builder, &AdBlockMatcherBuilder::matcherBuilt, this, [this, generation](AdBlockMatcher* matcher) {
+    onMatcherBuilt(matcher, generation);
+  }, Qt::QueuedConnection);
+  m_matcherBuildRunning = true;
+  QThreadPool::globalInstance()->start(builder);
+}
+
+void AdBlockManager::onMatcherBuilt(AdBlockMatcher* matcher, int generation) {
+  if (generation != m_matcherGeneration) {
+    delete matcher;
+    return;
+  }
+
+  m_matcherBuildRunning = false;
+
+  if (!m_enabled) {
+    // AdBlock was disabled in the meantime.
+    delete matcher;
+    matcher = new AdBlockMatcher();
+  }
 
-  m_matcher->update();
+  publishMatcher(matcher);
+}
+
+void AdBlockManager::publishMatcher(AdBlockMatcher* matcher) {
+  AdBlockMatcher* old_matcher = m_matcher.fetchAndStoreOrdered(matcher);
+
+  // Network thread might still be using old matcher.
+  if (old_matcher != nullptr) {
+    m_retiredMatchers.append(old_matcher);
+    m_retireTimer->start();
+  }
+
+  if (m_matcherBuildPending) {
+    m_matcherBuildPending = false;
+    updateMatcher();
+  }
+}
+
+void AdBlockManager::deleteRetiredMatchers() {
+  // Readers always obtain current matcher, so once there is no reader,
+  // nobody can hold pointer to retired matchers anymore.
+  if (m_activeReaders.load() == 0) {
+    qDeleteAll(m_retiredMatchers);
+    m_retiredMatchers.clear();
+    m_retireTimer->stop();
+  }
 }
 
 void AdBlockManager::updateAllSubscriptions() {
@@ -317,7 +422,7 @@ void AdBlockManager::save() {
   }
 
   qApp->settings()->setValue(GROUP(AdBlock), AdBlock::AdBlockEnabled, m_enabled);
-  qApp->settings()->setValue(GROUP(AdBlock), AdBlock::DisabledRules, m_disabledRules);
+  qApp->settings()->setValue(GROUP(AdBlock), AdBlock::DisabledRules, QStringList(m_disabledRules.toList()));
 }
 
 bool AdBlockManager::isEnabled() const {
@@ -328,25 +433,31 @@ bool AdBlockManager::canRunOnScheme(const QString& scheme) const {
   return !(scheme == QSL("file") || scheme == QSL("qrc") || scheme == QSL("data") || scheme == QSL("abp"));
 }
 
-bool AdBlockManager::canBeBlocked(const QUrl& url) const {
-  return !m_matcher->adBlockDisabledForUrl(url);
+bool AdBlockManager::canBeBlocked(const AdBlockMatcher* matcher, const QUrl& url) const {
+  return !matcher->adBlockDisabledForUrl(url);
 }
 
+// NOTE: Element hiding rules are only queried from main thread, which
+// is also the only thread which retires matchers, so no reader counting is needed.
 QString AdBlockManager::elementHidingRules(const QUrl& url) const {
-  if (!isEnabled() || !canRunOnScheme(url.scheme()) || !canBeBlocked(url)) {
+  const AdBlockMatcher* matcher = m_matcher.load();
+
+  if (!isEnabled() || !canRunOnScheme(url.scheme()) || !canBeBlocked(matcher, url)) {
     return QString();
   }
   else {
-    return m_matcher->elementHidingRules();
+    return matcher->elementHidingRules();
   }
 }
 
 QString AdBlockManager::elementHidingRulesForDomain(const QUrl& url) const {
-  if (!isEnabled() || !canRunOnScheme(url.scheme()) || !canBeBlocked(url)) {
+  const AdBlockMatcher* matcher = m_matcher.load();
+
+  if (!isEnabled() || !canRunOnScheme(url.scheme()) || !canBeBlocked(matcher, url)) {
     return QString();
   }
   else {
-    return m_matcher->elementHidingRulesForDomain(url.host());
+    return matcher->elementHidingRulesForDomain(url.host());
   }
 }
 
@@ -20,12 +20,17 @@
 #ifndef ADBLOCKMANAGER_H
 #define ADBLOCKMANAGER_H
 
-#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QObject>
 #include <QPointer>
+#include <QSet>
 #include <QStringList>
 
+#include "definitions/definitions.h"
+
 class QUrl;
+class QTimer;
 class QWebEngineUrlRequestInfo;
 class AdBlockMatcher;
 class AdBlockCustomList;
@@ -57,7 +62,7 @@ class AdBlockManager : public QObject {
 
     bool block(QWebEngineUrlRequestInfo& request);
 
-    QStringList disabledRules() const;
+    QSet<QString> disabledRules() const;
     void addDisabledRule(const QString& filter);
     void removeDisabledRule(const QString& filter);
 
@@ -84,19 +89,37 @@ class AdBlockManager : public QObject {
     void updateAllSubscriptions();
     void showDialog();
 
+  private slots:
+    void publishMatcher(AdBlockMatcher* matcher);
+    void deleteRetiredMatchers();
+
   private:
-    inline bool canBeBlocked(const QUrl& url) const;
+    inline bool canBeBlocked(const AdBlockMatcher* matcher, const QUrl& url) const;
+    void recordMatchLatency(qint64 nsecs);
+    void onMatcherBuilt(AdBlockMatcher* matcher, int generation);
+
     bool m_loaded;
     bool m_enabled;
     AdBlockIcon* m_adblockIcon;
 
     QList<AdBlockSubscription*> m_subscriptions;
-    AdBlockMatcher* m_matcher;
-    QStringList m_disabledRules;
+
+    // Current matcher snapshot. It is replaced as a whole, never modified. Readers
+    // outside of main thread must be counted in m_activeReaders while they use it.
+    QAtomicPointer<AdBlockMatcher> m_matcher;
+    QAtomicInt m_activeReaders;
+    QList<AdBlockMatcher*> m_retiredMatchers;
+    QTimer* m_retireTimer;
+    bool m_matcherBuildRunning;
+    bool m_matcherBuildPending;
+    int m_matcherGeneration;
+
+    QAtomicInt m_matchLatencies[ADBLOCK_LATENCY_BUCKETS];
+    QAtomicInt m_matchedRequests;
+    QSet<QString> m_disabledRules;
     AdBlockUrlInterceptor* m_interceptor;
 
     QPointer<AdBlockDialog> m_adBlockDialog;
-    QMutex m_mutex;
 };
 
 #endif // ADBLOCKMANAGER_H
@@ -17,53 +17,38 @@
 // You should have received a copy of the GNU General Public License
 // along with RSS Guard. If not, see <http://www.gnu.org/licenses/>.
 
-#include "network-web/adblock/adblockmanager.h"
 #include "network-web/adblock/adblockmatcher.h"
+
 #include "network-web/adblock/adblockrule.h"
 #include "network-web/adblock/adblocksubscription.h"
 
 #include "definitions/definitions.h"
 
-AdBlockMatcher::AdBlockMatcher(AdBlockManager* manager)
-  : QObject(manager), m_manager(manager) {}
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+AdBlockMatcher::AdBlockMatcher(const QVector<AdBlockRule*>& rules,
+                               const QHash<const AdBlockSubscription*, QString>& subscription_titles)
+  : m_rules(rules), m_subscriptionTitles(subscription_titles), m_cssCache(ADBLOCK_CSS_CACHE_SIZE),
+  m_cssCacheHits(0), m_cssCacheMisses(0) {
+  build();
+}
 
 AdBlockMatcher::~AdBlockMatcher() {
-  clear();
+  qDeleteAll(m_createdRules);
+  qDeleteAll(m_rules);
 }
 
 const AdBlockRule* AdBlockMatcher::match(const QWebEngineUrlRequestInfo& request, const QString& urlDomain,
                                          const QString& urlString) const {
   // Exception rules.
-  if (m_networkExceptionTree.find(request, urlDomain, urlString)) {
+  if (m_networkExceptionIndex.find(request, urlDomain, urlString)) {
     return 0;
   }
 
-  int count = m_networkExceptionRules.count();
-
-  for (int i = 0; i < count; ++i) {
-    const AdBlockRule* rule = m_networkExceptionRules.at(i);
-
-    if (rule->networkMatch(request, urlDomain, urlString)) {
-      return 0;
-    }
-  }
-
   // Block rules.
-  if (const AdBlockRule* rule = m_networkBlockTree.find(request, urlDomain, urlString)) {
-    return rule;
-  }
-
-  count = m_networkBlockRules.count();
-
-  for (int i = 0; i < count; ++i) {
-    const AdBlockRule* rule = m_networkBlockRules.at(i);
-
-    if (rule->networkMatch(request, urlDomain, urlString)) {
-      return rule;
-    }
-  }
-
-  return 0;
+  return m_networkBlockIndex.find(request, urlDomain, urlString);
 }
 
 bool AdBlockMatcher::adBlockDisabledForUrl(const QUrl& url) const {
@@ -99,12 +84,52 @@ QString AdBlockMatcher::elementHidingRules() const {
 }
 
 QString AdBlockMatcher::elementHidingRulesForDomain(const QString& domain) const {
+  QMutexLocker locker(&m_cssCacheMutex);
+  const QString* cached_rules = m_cssCache.object(domain);
+  QString rules;
+
+  if (cached_rules != nullptr) {
+    m_cssCacheHits++;
+    rules = *cached_rules;
+  }
+  else {
+    m_cssCacheMisses++;
+    rules = buildElementHidingRulesForDomain(domain);
+    m_cssCache.insert(domain, new QString(rules));
+  }
+
+  if ((m_cssCacheHits + m_cssCacheMisses) % ADBLOCK_CSS_CACHE_REPORT_INTERVAL == 0) {
+    qDebug("AdBlock element hiding cache: %d hits, %d misses.", m_cssCacheHits, m_cssCacheMisses);
+  }
+
+  return rules;
+}
+
+QString AdBlockMatcher::buildElementHidingRulesForDomain(const QString& domain) const {
+  // Gather rules allowed for the domain itself or any of its parent domains.
+  QVector<int> candidates = m_cssRulesForAnyDomain;
+  QString suffix = domain;
+
+  forever {
+    candidates += m_cssRulesByDomain.value(suffix);
+    const int dot_index = suffix.indexOf(QL1C('.'));
+
+    if (dot_index < 0) {
+      break;
+    }
+
+    suffix = suffix.mid(dot_index + 1);
+  }
+
+  // Keep original order of rules and drop duplicates.
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
   QString rules;
   int addedRulesCount = 0;
-  int count = m_domainRestrictedCssRules.count();
 
-  for (int i = 0; i < count; ++i) {
-    const AdBlockRule* rule = m_domainRestrictedCssRules.at(i);
+  foreach (int offset, candidates) {
+    const AdBlockRule* rule = m_domainRestrictedCssRules.at(offset);
 
     if (!rule->matchDomain(domain)) {
       continue;
@@ -129,51 +154,40 @@ QString AdBlockMatcher::elementHidingRulesForDomain(const QString& domain) const
   return rules;
 }
 
-void AdBlockMatcher::update() {
-  clear();
+QString AdBlockMatcher::subscriptionTitle(const AdBlockRule* rule) const {
+  return m_subscriptionTitles.value(rule->subscription());
+}
+
+void AdBlockMatcher::build() {
   QHash<QString, const AdBlockRule*> cssRulesHash;
   QVector<const AdBlockRule*> exceptionCssRules;
 
-  foreach (AdBlockSubscription* subscription, m_manager->subscriptions()) {
-    foreach (const AdBlockRule* rule, subscription->allRules()) {
-      // Don't add internally disabled rules to cache.
-      if (rule->isInternalDisabled()) {
-        continue;
-      }
-
-      if (rule->isCssRule()) {
-        // We will add only enabled css rules to cache, because there is no enabled/disabled
-        // check on match. They are directly embedded to pages.
-        if (!rule->isEnabled()) {
-          continue;
-        }
-
-        if (rule->isException()) {
-          exceptionCssRules.append(rule);
-        }
-        else {
-          cssRulesHash.insert(rule->cssSelector(), rule);
-        }
-      }
-      else if (rule->isDocument()) {
-        m_documentRules.append(rule);
-      }
-      else if (rule->isElemhide()) {
-        m_elemhideRules.append(rule);
-      }
-      else if (rule->isException()) {
-        if (!m_networkExceptionTree.add(rule)) {
-          m_networkExceptionRules.append(rule);
-        }
+  foreach (const AdBlockRule* rule, m_rules) {
+    if (rule->isCssRule()) {
+      if (rule->isException()) {
+        exceptionCssRules.append(rule);
       }
       else {
-        if (!m_networkBlockTree.add(rule)) {
-          m_networkBlockRules.append(rule);
-        }
+        cssRulesHash.insert(rule->cssSelector(), rule);
       }
     }
+    else if (rule->isDocument()) {
+      m_documentRules.append(rule);
+    }
+    else if (rule->isElemhide()) {
+      m_elemhideRules.append(rule);
+    }
+    else if (rule->isException()) {
+      m_networkExceptionIndex.add(rule);
+    }
+    else {
+      m_networkBlockIndex.add(rule);
+    }
   }
 
+  m_networkExceptionIndex.build();
+  m_networkBlockIndex.build();
+
   foreach (const AdBlockRule* rule, exceptionCssRules) {
     const AdBlockRule* originalRule = cssRulesHash.value(rule->cssSelector());
 
@@ -219,17 +233,54 @@ void AdBlockMatcher::update() {
     m_elementHidingRules = m_elementHidingRules.left(m_elementHidingRules.size() - 1);
     m_elementHidingRules.append(QL1S("{display:none !important;} "));
   }
+
+  for (int i = 0; i < m_domainRestrictedCssRules.size(); i++) {
+    const AdBlockRule* rule = m_domainRestrictedCssRules.at(i);
+
+    if (rule->m_allowedDomains.isEmpty()) {
+      m_cssRulesForAnyDomain.append(i);
+    }
+    else {
+      foreach (const QString& allowed_domain, rule->m_allowedDomains) {
+        QVector<int>& offsets = m_cssRulesByDomain[allowed_domain];
+
+        if (offsets.isEmpty() || offsets.last() != i) {
+          offsets.append(i);
+        }
+      }
+    }
+  }
 }
 
-void AdBlockMatcher::clear() {
-  m_networkExceptionTree.clear();
-  m_networkExceptionRules.clear();
-  m_networkBlockTree.clear();
-  m_networkBlockRules.clear();
-  m_domainRestrictedCssRules.clear();
-  m_elementHidingRules.clear();
-  m_documentRules.clear();
-  m_elemhideRules.clear();
-  qDeleteAll(m_createdRules);
-  m_createdRules.clear();
+AdBlockMatcherBuilder::AdBlockMatcherBuilder(const QList<AdBlockSubscription*>& subscriptions) : QObject(), QRunnable() {
+  foreach (const AdBlockSubscription* subscription, subscriptions) {
+    m_subscriptionTitles.insert(subscription, subscription->title());
+
+    foreach (const AdBlockRule* rule, subscription->allRules()) {
+      // Don't add internally disabled rules to cache.
+      if (rule->isInternalDisabled()) {
+        continue;
+      }
+
+      // We will add only enabled css rules to cache, because there is no enabled/disabled
+      // check on match. They are directly embedded to pages.
+      if (rule->isCssRule() && !rule->isEnabled()) {
+        continue;
+      }
+
+      m_rules.append(rule->copy());
+    }
+  }
+}
+
+AdBlockMatcherBuilder::~AdBlockMatcherBuilder() {}
+
+void AdBlockMatcherBuilder::run() {
+  QElapsedTimer tmr;
+
+  tmr.start();
+  AdBlockMatcher* matcher = new AdBlockMatcher(m_rules, m_subscriptionTitles);
+
+  qDebug("AdBlock matcher with %d rules built in %lld ms.", m_rules.size(), tmr.elapsed());
+  emit matcherBuilt(matcher);
 }
@@ -22,20 +22,27 @@
 
 #include <QUrl>
 
-#include "network-web/adblock/adblocksearchtree.h"
+#include "network-web/adblock/adblocktokenindex.h"
 
+#include <QCache>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QRunnable>
 #include <QVector>
 
 class QWebEngineUrlRequestInfo;
-class AdBlockManager;
-
-class AdBlockMatcher : public QObject {
-  Q_OBJECT
+class AdBlockSubscription;
 
+// Immutable snapshot of all active rules. Once constructed, matcher
+// is never modified, so it can be queried from any thread.
+class AdBlockMatcher {
   public:
-    explicit AdBlockMatcher(AdBlockManager* manager);
-    virtual ~AdBlockMatcher();
+    // Matcher takes ownership of given rules.
+    explicit AdBlockMatcher(const QVector<AdBlockRule*>& rules = QVector<AdBlockRule*>(),
+                            const QHash<const AdBlockSubscription*, QString>& subscription_titles =
+                              QHash<const AdBlockSubscription*, QString>());
+    ~AdBlockMatcher();
 
     const AdBlockRule* match(const QWebEngineUrlRequestInfo& request, const QString& urlDomain, const QString& urlString) const;
 
@@ -43,25 +50,61 @@ class AdBlockMatcher : public QObject {
     bool elemHideDisabledForUrl(const QUrl& url) const;
 
     QString elementHidingRules() const;
+    // Returns stylesheet for given domain. Generated stylesheets
+    // are kept in LRU cache which lives as long as this matcher.
     QString elementHidingRulesForDomain(const QString& domain) const;
 
-  public slots:
-    void update();
-    void clear();
+    // Returns title of subscription given rule originated from. Subscription
+    // itself might be already gone, so it is never dereferenced.
+    QString subscriptionTitle(const AdBlockRule* rule) const;
 
   private:
-    AdBlockManager* m_manager;
+    Q_DISABLE_COPY(AdBlockMatcher)
 
+    void build();
+    QString buildElementHidingRulesForDomain(const QString& domain) const;
+
+    QVector<AdBlockRule*> m_rules;
     QVector<AdBlockRule*> m_createdRules;
-    QVector<const AdBlockRule*> m_networkExceptionRules;
-    QVector<const AdBlockRule*> m_networkBlockRules;
     QVector<const AdBlockRule*> m_domainRestrictedCssRules;
+
+    // Offsets of domain-restricted CSS rules keyed by their allowed domains.
+    // Rules with excluded domains only may apply anywhere and are kept aside.
+    QHash<QString, QVector<int>> m_cssRulesByDomain;
+    QVector<int> m_cssRulesForAnyDomain;
     QVector<const AdBlockRule*> m_documentRules;
     QVector<const AdBlockRule*> m_elemhideRules;
+    QHash<const AdBlockSubscription*, QString> m_subscriptionTitles;
 
     QString m_elementHidingRules;
-    AdBlockSearchTree m_networkBlockTree;
-    AdBlockSearchTree m_networkExceptionTree;
+    AdBlockTokenIndex m_networkBlockIndex;
+    AdBlockTokenIndex m_networkExceptionIndex;
+
+    mutable QMutex m_cssCacheMutex;
+    mutable QCache<QString, QString> m_cssCache;
+    mutable int m_cssCacheHits;
+    mutable int m_cssCacheMisses;
 };
 
+// Builds new matcher on thread pool. Rules are copied from subscriptions
+// in constructor, so subscriptions can be freely edited during the build.
+class AdBlockMatcherBuilder : public QObject, public QRunnable {
+  Q_OBJECT
+
+  public:
+    explicit AdBlockMatcherBuilder(const QList<AdBlockSubscription*>& subscriptions);
+    virtual ~AdBlockMatcherBuilder();
+
+    void run();
+
+  signals:
+    void matcherBuilt(AdBlockMatcher* matcher);
+
+  private:
+    QVector<AdBlockRule*> m_rules;
+    QHash<const AdBlockSubscription*, QString> m_subscriptionTitles;
+};
+
+Q_DECLARE_METATYPE(AdBlockMatcher*)
+
 #endif // ADBLOCKMATCHER_H
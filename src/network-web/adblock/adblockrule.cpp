@@ -122,6 +122,55 @@ void AdBlockRule::setSubscription(AdBlockSubscription* subscription) {
   m_subscription = subscription;
 }
 
+void AdBlockRule::writeCache(QDataStream& stream) const {
+  stream << m_filter << qint32(m_type) << qint32(m_options) << qint32(m_exceptions) << m_matchString
+         << qint32(m_caseSensitivity) << m_isEnabled << m_isException << m_isInternalDisabled
+         << m_allowedDomains << m_blockedDomains << bool(m_regExp != 0);
+
+  if (m_regExp != 0) {
+    QStringList matcher_patterns;
+
+    foreach (const QStringMatcher& matcher, m_regExp->matchers) {
+      matcher_patterns.append(matcher.pattern());
+    }
+
+    stream << m_regExp->regExp.pattern() << matcher_patterns;
+  }
+}
+
+bool AdBlockRule::readCache(QDataStream& stream) {
+  qint32 type, options, exceptions, case_sensitivity;
+  bool has_regexp;
+
+  stream >> m_filter >> type >> options >> exceptions >> m_matchString
+  >> case_sensitivity >> m_isEnabled >> m_isException >> m_isInternalDisabled
+  >> m_allowedDomains >> m_blockedDomains >> has_regexp;
+
+  if (stream.status() != QDataStream::Ok || type < CssRule || type > Invalid) {
+    return false;
+  }
+
+  m_type = RuleType(type);
+  m_options = RuleOptions(QFlag(options));
+  m_exceptions = RuleOptions(QFlag(exceptions));
+  m_caseSensitivity = Qt::CaseSensitivity(case_sensitivity);
+
+  delete m_regExp;
+  m_regExp = 0;
+
+  if (has_regexp) {
+    QString pattern;
+    QStringList matcher_patterns;
+
+    stream >> pattern >> matcher_patterns;
+    m_regExp = new RegExp;
+    m_regExp->regExp = SimpleRegExp(pattern, m_caseSensitivity);
+    m_regExp->matchers = createStringMatchers(matcher_patterns);
+  }
+
+  return stream.status() == QDataStream::Ok;
+}
+
 QString AdBlockRule::filter() const {
   return m_filter;
 }
@@ -496,6 +545,9 @@ void AdBlockRule::parseFilter() {
   // we must modify parsedLine to comply with SimpleRegExp.
   if (parsedLine.contains(QL1C('*')) || parsedLine.contains(QL1C('^')) || parsedLine.contains(QL1C('|'))) {
     m_type = RegExpMatchRule;
+
+    // Keep original pattern, so that literal tokens can be extracted from it.
+    m_matchString = parsedLine;
     m_regExp = new RegExp;
     m_regExp->regExp = SimpleRegExp(createRegExpFromFilter(parsedLine), m_caseSensitivity);
     m_regExp->matchers = createStringMatchers(parseRegExpFilter(parsedLine));
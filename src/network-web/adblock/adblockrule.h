@@ -48,6 +48,7 @@
 #ifndef ADBLOCKRULE_H
 #define ADBLOCKRULE_H
 
+#include <QDataStream>
 #include <QObject>
 #include <QStringList>
 #include <QStringMatcher>
@@ -102,6 +103,11 @@ class AdBlockRule {
     bool matchStyleSheet(const QWebEngineUrlRequestInfo& request) const;
     bool matchObjectSubrequest(const QWebEngineUrlRequestInfo& request) const;
 
+    // Stores/restores already parsed rule, so that filter
+    // does not have to be parsed again.
+    void writeCache(QDataStream& stream) const;
+    bool readCache(QDataStream& stream);
+
   protected:
     bool matchDomain(const QString& pattern, const QString& domain) const;
     bool stringMatch(const QString& domain, const QString& encodedUrl) const;
@@ -177,7 +183,7 @@ class AdBlockRule {
     RegExp* m_regExp;
 
     friend class AdBlockMatcher;
-    friend class AdBlockSearchTree;
+    friend class AdBlockTokenIndex;
     friend class AdBlockSubscription;
 };
 
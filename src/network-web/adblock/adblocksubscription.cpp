@@ -52,10 +52,12 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/iofactory.h"
 #include "network-web/adblock/adblockmanager.h"
-#include "network-web/adblock/adblocksearchtree.h"
 #include "network-web/silentnetworkaccessmanager.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QNetworkReply>
 #include <QSaveFile>
@@ -76,6 +78,10 @@ void AdBlockSubscription::setFilePath(const QString& path) {
   m_filePath = path;
 }
 
+QString AdBlockSubscription::cacheFilePath() const {
+  return m_filePath + QL1S(ADBLOCK_CACHE_SUFFIX);
+}
+
 QUrl AdBlockSubscription::url() const {
   return m_url;
 }
@@ -84,7 +90,7 @@ void AdBlockSubscription::setUrl(const QUrl& url) {
   m_url = url;
 }
 
-void AdBlockSubscription::loadSubscription(const QStringList& disabledRules) {
+void AdBlockSubscription::loadSubscription(const QSet<QString>& disabled_rules) {
   QFile file(m_filePath);
 
   if (!file.exists()) {
@@ -98,31 +104,49 @@ void AdBlockSubscription::loadSubscription(const QStringList& disabledRules) {
     return;
   }
 
-  QTextStream textStream(&file);
+  // Precompiled rules are valid only for exactly the same list.
+  QByteArray checksum;
+  uchar* list_data = file.size() > 0 ? file.map(0, file.size()) : nullptr;
 
-  textStream.setCodec("UTF-8");
+  if (list_data != nullptr) {
+    checksum = QCryptographicHash::hash(QByteArray::fromRawData(reinterpret_cast<const char*>(list_data), int(file.size())),
+                                        QCryptographicHash::Sha1);
+    file.unmap(list_data);
+  }
+  else {
+    checksum = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+    file.seek(0);
+  }
 
-  // Header is on 3rd line.
-  textStream.readLine(1024);
-  textStream.readLine(1024);
-  QString header = textStream.readLine(1024);
+  if (m_title.isEmpty() || !loadCachedRules(checksum)) {
+    QTextStream textStream(&file);
 
-  if (!header.startsWith(QL1S("[Adblock")) || m_title.isEmpty()) {
-    qWarning("Invalid format of AdBlock file '%s'.", qPrintable(m_filePath));
-    QTimer::singleShot(0, this, SLOT(updateSubscription()));
-    return;
-  }
+    textStream.setCodec("UTF-8");
 
-  m_rules.clear();
+    // Header is on 3rd line.
+    textStream.readLine(1024);
+    textStream.readLine(1024);
+    QString header = textStream.readLine(1024);
 
-  while (!textStream.atEnd()) {
-    AdBlockRule* rule = new AdBlockRule(textStream.readLine(), this);
+    if (!header.startsWith(QL1S("[Adblock")) || m_title.isEmpty()) {
+      qWarning("Invalid format of AdBlock file '%s'.", qPrintable(m_filePath));
+      QTimer::singleShot(0, this, SLOT(updateSubscription()));
+      return;
+    }
 
-    if (disabledRules.contains(rule->filter())) {
-      rule->setEnabled(false);
+    m_rules.clear();
+
+    while (!textStream.atEnd()) {
+      m_rules.append(new AdBlockRule(textStream.readLine(), this));
     }
 
-    m_rules.append(rule);
+    saveCachedRules(checksum);
+  }
+
+  foreach (AdBlockRule* rule, m_rules) {
+    if (disabled_rules.contains(rule->filter())) {
+      rule->setEnabled(false);
+    }
   }
 
   // Initial update.
@@ -131,6 +155,84 @@ void AdBlockSubscription::loadSubscription(const QStringList& disabledRules) {
   }
 }
 
+bool AdBlockSubscription::loadCachedRules(const QByteArray& checksum) {
+  QElapsedTimer tmr;
+  QFile cache_file(cacheFilePath());
+
+  tmr.start();
+
+  if (!cache_file.open(QFile::ReadOnly) || cache_file.size() == 0) {
+    return false;
+  }
+
+  uchar* cache_data = cache_file.map(0, cache_file.size());
+
+  if (cache_data == nullptr) {
+    return false;
+  }
+
+  // Read directly from mapped memory, only rule strings themselves are copied.
+  QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(cache_data), int(cache_file.size())));
+  quint32 magic, version;
+  QByteArray cached_checksum;
+  qint32 count;
+
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream >> magic >> version >> cached_checksum >> count;
+
+  if (stream.status() != QDataStream::Ok || magic != ADBLOCK_CACHE_MAGIC || version != ADBLOCK_CACHE_VERSION ||
+      cached_checksum != checksum || count < 0) {
+    cache_file.unmap(cache_data);
+    return false;
+  }
+
+  QVector<AdBlockRule*> rules;
+
+  rules.reserve(count);
+
+  for (int i = 0; i < count; i++) {
+    AdBlockRule* rule = new AdBlockRule(QString(), this);
+
+    rules.append(rule);
+
+    if (!rule->readCache(stream)) {
+      qWarning("Precompiled AdBlock rules '%s' are corrupted, parsing list again.", qPrintable(cacheFilePath()));
+      qDeleteAll(rules);
+      cache_file.unmap(cache_data);
+      return false;
+    }
+  }
+
+  cache_file.unmap(cache_data);
+  m_rules = rules;
+
+  qDebug("Loaded %d precompiled AdBlock rules from '%s' in %lld ms.",
+         count, qPrintable(QDir::toNativeSeparators(cacheFilePath())), tmr.elapsed());
+  return true;
+}
+
+void AdBlockSubscription::saveCachedRules(const QByteArray& checksum) const {
+  QSaveFile cache_file(cacheFilePath());
+
+  if (!cache_file.open(QFile::WriteOnly)) {
+    qWarning("Unable to open file '%s' for writing precompiled AdBlock rules.", qPrintable(cacheFilePath()));
+    return;
+  }
+
+  QDataStream stream(&cache_file);
+
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << quint32(ADBLOCK_CACHE_MAGIC) << quint32(ADBLOCK_CACHE_VERSION) << checksum << qint32(m_rules.size());
+
+  foreach (const AdBlockRule* rule, m_rules) {
+    rule->writeCache(stream);
+  }
+
+  if (stream.status() != QDataStream::Ok || !cache_file.commit()) {
+    qWarning("Failed to save precompiled AdBlock rules to '%s'.", qPrintable(cacheFilePath()));
+  }
+}
+
 void AdBlockSubscription::saveSubscription() {}
 
 void AdBlockSubscription::updateSubscription() {
@@ -138,9 +240,7 @@ void AdBlockSubscription::updateSubscription() {
     return;
   }
 
-  SilentNetworkAccessManager* mgs = new SilentNetworkAccessManager(this);
-
-  m_reply = mgs->get(QNetworkRequest(m_url));
+  m_reply = SilentNetworkAccessManager::instance()->get(QNetworkRequest(m_url));
   connect(m_reply, &QNetworkReply::finished, this, &AdBlockSubscription::subscriptionDownloaded);
 }
 
@@ -156,7 +256,6 @@ void AdBlockSubscription::subscriptionDownloaded() {
     error = true;
   }
 
-  m_reply->manager()->deleteLater();
   m_reply->deleteLater();
   m_reply = 0;
 
@@ -264,7 +363,7 @@ AdBlockCustomList::AdBlockCustomList(QObject* parent)
   setFilePath(AdBlockManager::storedListsPath() + QDir::separator() + ADBLOCK_CUSTOMLIST_NAME);
 }
 
-void AdBlockCustomList::loadSubscription(const QStringList& disabledRules) {
+void AdBlockCustomList::loadSubscription(const QSet<QString>& disabled_rules) {
   // DuckDuckGo ad whitelist rules
   // They cannot be removed, but can be disabled.
   // Please consider not disabling them. Thanks!
@@ -298,7 +397,7 @@ void AdBlockCustomList::loadSubscription(const QStringList& disabledRules) {
   }
 
   file.close();
-  AdBlockSubscription::loadSubscription(disabledRules);
+  AdBlockSubscription::loadSubscription(disabled_rules);
 }
 
 void AdBlockCustomList::saveSubscription() {
@@ -48,11 +48,11 @@
 #ifndef ADBLOCKSUBSCRIPTION_H
 #define ADBLOCKSUBSCRIPTION_H
 
+#include <QSet>
 #include <QUrl>
 #include <QVector>
 
 #include "network-web/adblock/adblockrule.h"
-#include "network-web/adblock/adblocksearchtree.h"
 
 class QUrl;
 class QNetworkReply;
@@ -69,10 +69,13 @@ class AdBlockSubscription : public QObject {
     QString filePath() const;
     void setFilePath(const QString& path);
 
+    // Path of precompiled rules of this subscription.
+    QString cacheFilePath() const;
+
     QUrl url() const;
     void setUrl(const QUrl& url);
 
-    virtual void loadSubscription(const QStringList& disabledRules);
+    virtual void loadSubscription(const QSet<QString>& disabled_rules);
     virtual void saveSubscription();
     const AdBlockRule* rule(int offset) const;
 
@@ -99,6 +102,9 @@ class AdBlockSubscription : public QObject {
 
   protected:
     virtual bool saveDownloadedData(const QByteArray& data);
+
+    bool loadCachedRules(const QByteArray& checksum);
+    void saveCachedRules(const QByteArray& checksum) const;
     QNetworkReply* m_reply;
 
     QVector<AdBlockRule*> m_rules;
@@ -116,7 +122,7 @@ class AdBlockCustomList : public AdBlockSubscription {
   public:
     explicit AdBlockCustomList(QObject* parent = 0);
 
-    void loadSubscription(const QStringList& disabledRules);
+    void loadSubscription(const QSet<QString>& disabled_rules);
     void saveSubscription();
 
     bool canEditRules() const;
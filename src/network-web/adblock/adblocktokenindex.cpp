@@ -0,0 +1,237 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "network-web/adblock/adblocktokenindex.h"
+
+#include "definitions/definitions.h"
+#include "network-web/adblock/adblockrule.h"
+
+#include <QVarLengthArray>
+#include <QWebEngineUrlRequestInfo>
+
+#include <algorithm>
+
+AdBlockTokenIndex::AdBlockTokenIndex() {}
+
+AdBlockTokenIndex::~AdBlockTokenIndex() {}
+
+void AdBlockTokenIndex::clear() {
+  m_pendingRules.clear();
+  m_pendingTokens.clear();
+  m_bucketRules.clear();
+  m_buckets.clear();
+  m_untokenizedRules.clear();
+  m_regExpRules.clear();
+}
+
+void AdBlockTokenIndex::add(const AdBlockRule* rule) {
+  m_pendingRules.append(rule);
+  m_pendingTokens.append(ruleTokens(rule));
+}
+
+void AdBlockTokenIndex::build() {
+  QHash<uint, int> token_frequencies;
+
+  foreach (const QVector<uint>& tokens, m_pendingTokens) {
+    foreach (uint token, tokens) {
+      token_frequencies[token]++;
+    }
+  }
+
+  QHash<uint, QVector<const AdBlockRule*>> buckets;
+
+  for (int i = 0; i < m_pendingRules.size(); i++) {
+    const AdBlockRule* rule = m_pendingRules.at(i);
+    const QVector<uint>& tokens = m_pendingTokens.at(i);
+
+    if (tokens.isEmpty()) {
+      if (rule->m_type == AdBlockRule::RegExpMatchRule) {
+        m_regExpRules.append(rule);
+      }
+      else {
+        m_untokenizedRules.append(rule);
+      }
+
+      continue;
+    }
+
+    // Store the rule under its rarest token, so that buckets stay small.
+    uint rarest_token = tokens.first();
+    int rarest_frequency = token_frequencies.value(rarest_token);
+
+    foreach (uint token, tokens) {
+      const int frequency = token_frequencies.value(token);
+
+      if (frequency < rarest_frequency) {
+        rarest_token = token;
+        rarest_frequency = frequency;
+      }
+    }
+
+    buckets[rarest_token].append(rule);
+  }
+
+  // Flatten buckets into single array.
+  m_bucketRules.reserve(m_pendingRules.size() - m_untokenizedRules.size() - m_regExpRules.size());
+  m_buckets.reserve(buckets.size());
+
+  QHashIterator<uint, QVector<const AdBlockRule*>> i(buckets);
+
+  while (i.hasNext()) {
+    i.next();
+    m_buckets.insert(i.key(), qMakePair(m_bucketRules.size(), i.value().size()));
+    m_bucketRules += i.value();
+  }
+
+  qDebug("AdBlock token index built with %d tokenized, %d untokenized and %d regexp rules in %d buckets.",
+         m_bucketRules.size(), m_untokenizedRules.size(), m_regExpRules.size(), m_buckets.size());
+
+  m_pendingRules.clear();
+  m_pendingTokens.clear();
+}
+
+const AdBlockRule* AdBlockTokenIndex::find(const QWebEngineUrlRequestInfo& request, const QString& domain,
+                                           const QString& urlString) const {
+  const QChar* string = urlString.constData();
+  const int len = urlString.size();
+  QVarLengthArray<uint, 64> visited_tokens;
+  int i = 0;
+
+  while (i < len) {
+    if (!isTokenCharacter(string[i])) {
+      i++;
+      continue;
+    }
+
+    uint token = 0;
+
+    while (i < len && isTokenCharacter(string[i])) {
+      token = hashTokenCharacter(token, string[i++]);
+    }
+
+    if (std::find(visited_tokens.constBegin(), visited_tokens.constEnd(), token) != visited_tokens.constEnd()) {
+      continue;
+    }
+
+    visited_tokens.append(token);
+
+    const QHash<uint, QPair<int, int>>::const_iterator bucket = m_buckets.constFind(token);
+
+    if (bucket == m_buckets.constEnd()) {
+      continue;
+    }
+
+    const int last = bucket.value().first + bucket.value().second;
+
+    for (int j = bucket.value().first; j < last; j++) {
+      const AdBlockRule* rule = m_bucketRules.at(j);
+
+      if (rule->networkMatch(request, domain, urlString)) {
+        return rule;
+      }
+    }
+  }
+
+  foreach (const AdBlockRule* rule, m_untokenizedRules) {
+    if (rule->networkMatch(request, domain, urlString)) {
+      return rule;
+    }
+  }
+
+  foreach (const AdBlockRule* rule, m_regExpRules) {
+    if (rule->networkMatch(request, domain, urlString)) {
+      return rule;
+    }
+  }
+
+  return nullptr;
+}
+
+int AdBlockTokenIndex::count() const {
+  return m_bucketRules.size() + m_untokenizedRules.size() + m_regExpRules.size() + m_pendingRules.size();
+}
+
+QVector<uint> AdBlockTokenIndex::ruleTokens(const AdBlockRule* rule) {
+  const QString& pattern = rule->m_matchString;
+
+  if (pattern.isEmpty()) {
+    // Filters with raw regular expressions cannot be tokenized.
+    return QVector<uint>();
+  }
+
+  switch (rule->m_type) {
+    case AdBlockRule::StringContainsMatchRule:
+      return patternTokens(pattern, false, false, false);
+
+    case AdBlockRule::StringEndsMatchRule:
+      return patternTokens(pattern, false, true, false);
+
+    case AdBlockRule::DomainMatchRule:
+
+      // Domain is always matched from the start of some label
+      // to the end of the host.
+      return patternTokens(pattern, true, true, false);
+
+    case AdBlockRule::RegExpMatchRule: {
+      // Pattern is in AdBlock syntax, only anchors are relevant for us.
+      int start = 0;
+      int end = pattern.size();
+      bool left_boundary = false;
+      bool right_boundary = false;
+
+      if (pattern.startsWith(QL1C('|'))) {
+        left_boundary = true;
+        start = pattern.startsWith(QL1S("||")) ? 2 : 1;
+      }
+
+      if (end > start && pattern.endsWith(QL1C('|'))) {
+        right_boundary = true;
+        end--;
+      }
+
+      return patternTokens(pattern.mid(start, end - start), left_boundary, right_boundary, true);
+    }
+
+    default:
+      return QVector<uint>();
+  }
+}
+
+QVector<uint> AdBlockTokenIndex::patternTokens(const QString& pattern, bool left_boundary, bool right_boundary, bool wildcards) {
+  QVector<uint> tokens;
+  const int len = pattern.size();
+  bool boundary_before = left_boundary;
+  int i = 0;
+
+  while (i < len) {
+    const QChar character = pattern.at(i);
+
+    if (!isTokenCharacter(character)) {
+      // Wildcard can stand for anything, including token characters,
+      // everything else separates tokens in the URL too.
+      boundary_before = !(wildcards && character == QL1C('*'));
+      i++;
+      continue;
+    }
+
+    bool usable = true;
+    uint token = 0;
+
+    while (i < len && isTokenCharacter(pattern.at(i))) {
+      // We cannot guarantee how non-ASCII characters appear in encoded URL.
+      if (pattern.at(i).unicode() >= 0x80) {
+        usable = false;
+      }
+
+      token = hashTokenCharacter(token, pattern.at(i++));
+    }
+
+    const bool boundary_after = i == len ? right_boundary : !(wildcards && pattern.at(i) == QL1C('*'));
+
+    // Only tokens which are surely complete tokens in the URL can be used.
+    if (usable && boundary_before && boundary_after && !tokens.contains(token)) {
+      tokens.append(token);
+    }
+  }
+
+  return tokens;
+}
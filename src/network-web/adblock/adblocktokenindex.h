@@ -0,0 +1,68 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef ADBLOCKTOKENINDEX_H
+#define ADBLOCKTOKENINDEX_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class QWebEngineUrlRequestInfo;
+class AdBlockRule;
+
+// Indexes network rules by single literal token which must be present
+// in each matching URL. Each rule is stored under the rarest of its tokens,
+// so only rules from buckets of tokens found in the URL need to be checked.
+// Rules without any usable token are checked for each URL, rules
+// based on regular expressions are kept separately and checked last.
+class AdBlockTokenIndex {
+  public:
+    explicit AdBlockTokenIndex();
+    virtual ~AdBlockTokenIndex();
+
+    void clear();
+
+    // Adds rule to the index. Index must be built with
+    // build() before it can be used for matching.
+    void add(const AdBlockRule* rule);
+    void build();
+
+    const AdBlockRule* find(const QWebEngineUrlRequestInfo& request, const QString& domain, const QString& urlString) const;
+
+    int count() const;
+
+  private:
+    static QVector<uint> ruleTokens(const AdBlockRule* rule);
+    static QVector<uint> patternTokens(const QString& pattern, bool left_boundary, bool right_boundary, bool wildcards);
+
+    static inline bool isTokenCharacter(QChar character) {
+      const ushort code = character.unicode();
+
+      return (code >= 'a' && code <= 'z') || (code >= 'A' && code <= 'Z') ||
+             (code >= '0' && code <= '9') || code == '%' || code >= 0x80;
+    }
+
+    static inline uint hashTokenCharacter(uint hash, QChar character) {
+      ushort code = character.unicode();
+
+      if (code >= 'A' && code <= 'Z') {
+        code += 'a' - 'A';
+      }
+
+      return hash * 31 + code;
+    }
+
+    QVector<const AdBlockRule*> m_pendingRules;
+    QVector<QVector<uint>> m_pendingTokens;
+
+    // All indexed rules grouped by their tokens, each token points
+    // to continuous range (offset, count) of this array.
+    QVector<const AdBlockRule*> m_bucketRules;
+    QHash<uint, QPair<int, int>> m_buckets;
+
+    QVector<const AdBlockRule*> m_untokenizedRules;
+    QVector<const AdBlockRule*> m_regExpRules;
+};
+
+#endif // ADBLOCKTOKENINDEX_H
@@ -9,6 +9,10 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 
+#if !defined(QT_NO_SSL)
+#include <QSslConfiguration>
+#endif
+
 BaseNetworkAccessManager::BaseNetworkAccessManager(QObject* parent)
   : QNetworkAccessManager(parent) {
   connect(this, &BaseNetworkAccessManager::sslErrors, this, &BaseNetworkAccessManager::onSslErrors);
@@ -60,6 +64,20 @@ QNetworkReply* BaseNetworkAccessManager::createRequest(QNetworkAccessManager::Op
   // NOTE: https://en.wikipedia.org/wiki/HTTP_pipelining
   new_request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
 
+#if QT_VERSION >= 0x050800
+  // Multiplex requests to the same host over single connection where server supports it.
+  new_request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+
+#if !defined(QT_NO_SSL)
+  // Allow abbreviated TLS handshakes for new connections to already visited hosts.
+  QSslConfiguration ssl_configuration = new_request.sslConfiguration();
+
+  ssl_configuration.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+  ssl_configuration.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+  new_request.setSslConfiguration(ssl_configuration);
+#endif
+
   // Setup custom user-agent.
   new_request.setRawHeader(HTTP_HEADERS_USER_AGENT, QString(APP_USERAGENT).toLocal8Bit());
   return QNetworkAccessManager::createRequest(op, new_request, outgoingData);
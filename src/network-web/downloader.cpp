@@ -10,7 +10,7 @@
 #include <QTimer>
 
 Downloader::Downloader(QObject* parent)
-  : QObject(parent), m_activeReply(nullptr), m_downloadManager(new SilentNetworkAccessManager(this)),
+  : QObject(parent), m_activeReply(nullptr), m_downloadManager(SilentNetworkAccessManager::instance()),
   m_timer(new QTimer(this)), m_customHeaders(QHash<QByteArray, QByteArray>()), m_inputData(QByteArray()),
   m_inputMultipartData(nullptr), m_targetProtected(false), m_targetUsername(QString()), m_targetPassword(QString()),
   m_lastOutputData(QByteArray()), m_lastOutputMultipartData(QList<HttpResponse>()), m_lastOutputError(QNetworkReply::NoError),
@@ -20,7 +20,14 @@ Downloader::Downloader(QObject* parent)
   connect(m_timer, &QTimer::timeout, this, &Downloader::cancel);
 }
 
-Downloader::~Downloader() {}
+Downloader::~Downloader() {
+  // Network manager is shared, make sure that unfinished reply does not outlive us.
+  if (m_activeReply != nullptr) {
+    m_activeReply->disconnect(this);
+    m_activeReply->abort();
+    m_activeReply->deleteLater();
+  }
+}
 
 void Downloader::downloadFile(const QString& url, int timeout, bool protected_contents, const QString& username,
                               const QString& password) {
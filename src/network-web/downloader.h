@@ -82,7 +82,7 @@ class Downloader : public QObject {
   private:
     QNetworkReply* m_activeReply;
 
-    QScopedPointer<SilentNetworkAccessManager> m_downloadManager;
+    SilentNetworkAccessManager* m_downloadManager;
     QTimer* m_timer;
 
     QHash<QByteArray, QByteArray> m_customHeaders;
@@ -22,13 +22,20 @@
 #include <QMetaObject>
 #include <QMimeData>
 #include <QSettings>
+#include <QTimer>
 
 DownloadItem::DownloadItem(QNetworkReply* reply, QWidget* parent) : QWidget(parent),
-  m_ui(new Ui::DownloadItem), m_reply(reply),
-  m_bytesReceived(0), m_requestFileName(false), m_startedSaving(false), m_finishedDownloading(false),
-  m_gettingFileName(false), m_canceledFileSelect(false) {
+  m_ui(new Ui::DownloadItem), m_reply(reply), m_startOffset(0), m_bytesTotal(0), m_speedSampleBytes(0), m_speed(-1.0),
+  m_requestFileName(false), m_startedSaving(false), m_finishedDownloading(false),
+  m_gettingFileName(false), m_canceledFileSelect(false), m_running(false), m_failed(false),
+  m_background(false), m_maxSize(-1), m_sizeExceeded(false) {
   m_ui->setupUi(this);
   m_ui->m_btnTryAgain->hide();
+
+  if (reply != nullptr) {
+    m_request = reply->request();
+  }
+
   m_requestFileName = qApp->settings()->value(GROUP(Downloads), SETTING(Downloads::AlwaysPromptForFilename)).toBool();
 
   connect(m_ui->m_btnStopDownload, &QToolButton::clicked, this, &DownloadItem::stop);
@@ -49,24 +56,34 @@ void DownloadItem::init() {
 
   m_startedSaving = false;
   m_finishedDownloading = false;
+  m_running = true;
+  m_failed = false;
+  m_sizeExceeded = false;
   m_ui->m_btnOpenFile->setEnabled(false);
   m_ui->m_btnOpenFolder->setEnabled(false);
   m_url = m_reply->url();
-  m_reply->setParent(this);
-
-  connect(m_reply, &QNetworkReply::readyRead, this, &DownloadItem::downloadReadyRead);
-  connect(m_reply, static_cast<void (QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error), this, &DownloadItem::error);
-  connect(m_reply, &QNetworkReply::downloadProgress, this, &DownloadItem::downloadProgress);
+  m_segments.clear();
+  m_segments.append(Segment { m_reply, m_startOffset, m_startOffset, -1 });
+  connectReply(m_reply);
   connect(m_reply, &QNetworkReply::metaDataChanged, this, &DownloadItem::metaDataChanged);
-  connect(m_reply, &QNetworkReply::finished, this, &DownloadItem::finished);
 
   // Reset info.
   m_ui->m_lblInfoDownload->clear();
   m_ui->m_progressDownload->setValue(0);
-  getFileName();
+
+  if (m_startOffset > 0 || m_background) {
+    // Resumed download keeps its file.
+    updateInfoAndUrlLabel();
+  }
+  else {
+    getFileName();
+  }
 
   // Start timer for the download estimation.
   m_downloadTime.start();
+  m_speedSampleTime.start();
+  m_speedSampleBytes = m_startOffset;
+  m_speed = -1.0;
 
   if (m_reply->error() != QNetworkReply::NoError) {
     error(m_reply->error());
@@ -173,6 +190,117 @@ QString DownloadItem::saveFileName(const QString& directory) const {
   return name;
 }
 
+void DownloadItem::startDownload() {
+  // Continue after the last byte which is surely on disk. Without validator
+  // it is not possible to tell whether file on server is still the same.
+  m_startOffset = m_output.exists() && !m_validator.isEmpty() ? qMin(downloadedPrefix(), m_output.size()) : 0;
+
+  if (m_startOffset == 0 && m_output.exists()) {
+    m_output.remove();
+  }
+
+  releaseReplies();
+  m_ui->m_progressDownload->setVisible(true);
+  m_reply = qApp->downloadManager()->get(createRequest(m_startOffset));
+  init();
+}
+
+void DownloadItem::setQueued() {
+  m_ui->m_btnOpenFile->setEnabled(false);
+  m_ui->m_btnOpenFolder->setEnabled(false);
+  m_ui->m_progressDownload->setValue(0);
+  m_ui->m_lblInfoDownload->setText(tr("Waiting for other downloads to finish"));
+  updateInfoAndUrlLabel();
+}
+
+QNetworkRequest DownloadItem::createRequest(qint64 start, qint64 end) const {
+  QNetworkRequest request = DownloadManager::createRequest(m_request);
+
+  request.setUrl(m_url);
+
+  if (start > 0 || end >= 0) {
+    const QString range = end >= 0
+                          ? QString(QSL("bytes=%1-%2")).arg(QString::number(start), QString::number(end))
+                          : QString(QSL("bytes=%1-")).arg(QString::number(start));
+
+    request.setRawHeader(HTTP_HEADERS_RANGE, range.toLatin1());
+
+    // Make sure that server sends whole file if it was changed meanwhile.
+    if (!m_validator.isEmpty()) {
+      request.setRawHeader(HTTP_HEADERS_IF_RANGE, m_validator);
+    }
+  }
+
+  return request;
+}
+
+void DownloadItem::connectReply(QNetworkReply* reply) {
+  reply->setParent(this);
+
+  connect(reply, &QNetworkReply::readyRead, this, &DownloadItem::downloadReadyRead);
+  connect(reply, static_cast<void (QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error), this, &DownloadItem::error);
+  connect(reply, &QNetworkReply::finished, this, &DownloadItem::finished);
+}
+
+void DownloadItem::releaseReplies() {
+  foreach (const Segment& segment, m_segments) {
+    if (segment.m_reply != m_reply) {
+      segment.m_reply->disconnect(this);
+      segment.m_reply->abort();
+      segment.m_reply->deleteLater();
+    }
+  }
+
+  m_segments.clear();
+
+  if (m_reply != nullptr) {
+    m_reply->disconnect(this);
+    m_reply->deleteLater();
+    m_reply = nullptr;
+  }
+}
+
+void DownloadItem::splitIntoSegments() {
+  const int segment_count = int(qMin(qint64(qApp->downloadManager()->m_downloadSegments),
+                                     m_bytesTotal / DOWNLOAD_SEGMENT_MIN_SIZE));
+
+  if (segment_count < 2 || m_startOffset > 0 || m_segments.size() != 1 ||
+      m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200 ||
+      m_reply->rawHeader(HTTP_HEADERS_ACCEPT_RANGES) != QByteArray("bytes")) {
+    return;
+  }
+
+  const qint64 segment_size = m_bytesTotal / segment_count;
+
+  // Already running request downloads the first range, it is
+  // cancelled once it gets there.
+  m_segments[0].m_end = segment_size - 1;
+
+  for (int i = 1; i < segment_count; i++) {
+    const qint64 start = i * segment_size;
+    const qint64 end = i == segment_count - 1 ? m_bytesTotal - 1 : start + segment_size - 1;
+    QNetworkReply* reply = qApp->downloadManager()->get(createRequest(start, end));
+
+    connectReply(reply);
+    m_segments.append(Segment { reply, start, start, end });
+  }
+
+  qDebug("Downloading '%s' in %d segments.", qPrintable(m_url.toString()), segment_count);
+}
+
+void DownloadItem::cancelSegments() {
+  // Server does not respect ranges, continue with the first request only.
+  for (int i = m_segments.size() - 1; i > 0; i--) {
+    QNetworkReply* reply = m_segments.takeAt(i).m_reply;
+
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+  }
+
+  m_segments[0].m_end = -1;
+}
+
 void DownloadItem::stop() {
   setUpdatesEnabled(false);
   m_ui->m_btnStopDownload->setEnabled(false);
@@ -180,7 +308,18 @@ void DownloadItem::stop() {
   m_ui->m_btnTryAgain->setEnabled(true);
   m_ui->m_btnTryAgain->show();
   setUpdatesEnabled(true);
-  m_reply->abort();
+
+  if (m_reply == nullptr) {
+    // Download did not start yet.
+    qApp->downloadManager()->m_queuedDownloads.removeOne(this);
+    m_ui->m_lblInfoDownload->setText(tr("Download cancelled"));
+  }
+  else {
+    foreach (const Segment& segment, m_segments) {
+      segment.m_reply->abort();
+    }
+  }
+
   emit downloadFinished();
 }
 
@@ -214,32 +353,33 @@ void DownloadItem::tryAgain() {
   m_ui->m_btnStopDownload->setEnabled(true);
   m_ui->m_btnStopDownload->setVisible(true);
   m_ui->m_progressDownload->setVisible(true);
-  QNetworkReply* new_download = qApp->downloadManager()->networkManager()->get(QNetworkRequest(m_url));
-
-  if (m_reply) {
-    m_reply->deleteLater();
-  }
-
-  if (m_output.exists()) {
-    m_output.remove();
-  }
+  m_output.close();
 
-  m_reply = new_download;
-  init();
+  // Partially downloaded data are kept, download is resumed.
+  qApp->downloadManager()->startOrQueue(this);
   emit statusChanged();
 }
 
 void DownloadItem::downloadReadyRead() {
-  if (m_requestFileName && m_output.fileName().isEmpty()) {
+  if (m_reply == nullptr || (m_requestFileName && m_output.fileName().isEmpty())) {
     return;
   }
 
   if (!m_output.isOpen()) {
-    if (!m_requestFileName) {
+    if (!m_requestFileName && !m_background && m_startOffset == 0) {
       getFileName();
     }
 
-    if (!m_output.open(QIODevice::WriteOnly)) {
+    // Server might ignore requested range and send whole file.
+    const bool resumed = m_startOffset > 0 && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 206;
+
+    if (!resumed && m_startOffset > 0) {
+      qWarning("Server does not support resuming of '%s', download starts from beginning.", qPrintable(m_url.toString()));
+      m_startOffset = 0;
+      m_segments[0].m_start = m_segments[0].m_position = 0;
+    }
+
+    if (!m_output.open(resumed ? QIODevice::ReadWrite : QIODevice::WriteOnly)) {
       m_ui->m_lblInfoDownload->setText(tr("Error opening output file: %1").arg(m_output.errorString()));
       stop();
       emit statusChanged();
@@ -250,25 +390,138 @@ void DownloadItem::downloadReadyRead() {
     emit statusChanged();
   }
 
-  if (-1 == m_output.write(m_reply->readAll())) {
-    m_ui->m_lblInfoDownload->setText(tr("Error when saving file: %1").arg(m_output.errorString()));
-    m_ui->m_btnStopDownload->click();
+  readSegments();
+}
+
+void DownloadItem::readSegments() {
+  for (int i = 0; i < m_segments.size(); i++) {
+    Segment& segment = m_segments[i];
+
+    if (segment.m_end >= 0 && segment.m_position > segment.m_end) {
+      continue;
+    }
+
+    if (i > 0 && segment.m_position == segment.m_start && segment.m_reply->bytesAvailable() > 0 &&
+        segment.m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206) {
+      if (m_segments[0].m_position <= m_segments[0].m_end) {
+        qWarning("Server does not support segmented download of '%s'.", qPrintable(m_url.toString()));
+        cancelSegments();
+        break;
+      }
+      else {
+        // First request was already cancelled, give up and let user resume.
+        segment.m_reply->abort();
+        return;
+      }
+    }
+
+    while (segment.m_reply->bytesAvailable() > 0) {
+      qint64 wanted = segment.m_reply->bytesAvailable();
+
+      if (segment.m_end >= 0) {
+        wanted = qMin(wanted, segment.m_end - segment.m_position + 1);
+      }
+
+      wanted = qApp->downloadManager()->acquireBandwidth(wanted);
+
+      if (wanted <= 0) {
+        // Rest of data is read when bandwidth budget is refilled.
+        updateProgress();
+        return;
+      }
+
+      const QByteArray data = segment.m_reply->read(wanted);
+
+      if ((m_output.pos() != segment.m_position && !m_output.seek(segment.m_position)) || m_output.write(data) == -1) {
+        m_ui->m_lblInfoDownload->setText(tr("Error when saving file: %1").arg(m_output.errorString()));
+        m_ui->m_btnStopDownload->click();
+        return;
+      }
+
+      m_startedSaving = true;
+      segment.m_position += data.size();
+
+      if (segment.m_end >= 0 && segment.m_position > segment.m_end) {
+        if (!segment.m_reply->isFinished()) {
+          // Open-ended request got to the start of next segment.
+          segment.m_reply->disconnect(this);
+          segment.m_reply->abort();
+        }
+
+        break;
+      }
+    }
   }
-  else {
-    m_startedSaving = true;
 
-    if (m_finishedDownloading) {
-      finished();
+  updateProgress();
+
+  if (m_startedSaving && allDataWritten()) {
+    finished();
+  }
+}
+
+bool DownloadItem::allDataWritten() const {
+  foreach (const Segment& segment, m_segments) {
+    const bool range_done = segment.m_end >= 0 && segment.m_position > segment.m_end;
+    const bool reply_done = segment.m_reply->isFinished() && segment.m_reply->bytesAvailable() == 0;
+
+    if (!range_done && !reply_done) {
+      return false;
     }
   }
+
+  return true;
+}
+
+bool DownloadItem::allRepliesFinished() const {
+  foreach (const Segment& segment, m_segments) {
+    if (!segment.m_reply->isFinished()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+qint64 DownloadItem::downloadedPrefix() const {
+  qint64 prefix = m_startOffset;
+
+  foreach (const Segment& segment, m_segments) {
+    if (segment.m_start > prefix) {
+      break;
+    }
+
+    prefix = qMax(prefix, segment.m_position);
+
+    if (segment.m_end < 0 || segment.m_position <= segment.m_end) {
+      break;
+    }
+  }
+
+  return prefix;
 }
 
 void DownloadItem::error(QNetworkReply::NetworkError code) {
   Q_UNUSED(code)
 
-  m_ui->m_lblInfoDownload->setText(tr("Error: %1").arg(m_reply->errorString()));
+  if (m_failed) {
+    return;
+  }
+
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+
+  m_failed = true;
+  m_ui->m_lblInfoDownload->setText(tr("Error: %1").arg(reply != nullptr ? reply->errorString() : m_reply->errorString()));
   m_ui->m_btnTryAgain->setEnabled(true);
   m_ui->m_btnTryAgain->setVisible(true);
+
+  // Other segments are useless now.
+  foreach (const Segment& segment, m_segments) {
+    if (segment.m_reply != reply) {
+      segment.m_reply->abort();
+    }
+  }
+
   emit downloadFinished();
 }
 
@@ -277,14 +530,37 @@ void DownloadItem::metaDataChanged() {
 
   if (locationHeader.isValid()) {
     m_url = locationHeader.toUrl();
-    m_reply->deleteLater();
-    m_reply = qApp->downloadManager()->networkManager()->get(QNetworkRequest(m_url));
+    releaseReplies();
+    m_reply = qApp->downloadManager()->get(createRequest(m_startOffset));
     init();
     return;
   }
+
+  const qint64 content_length = m_reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+  const bool resumed = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 206;
+
+  m_bytesTotal = content_length > 0 ? content_length + (resumed ? m_startOffset : 0) : 0;
+
+  if (m_maxSize >= 0 && m_bytesTotal > m_maxSize) {
+    m_failed = true;
+    m_sizeExceeded = true;
+    m_ui->m_lblInfoDownload->setText(tr("File is bigger than %1, download cancelled").arg(DownloadManager::dataString(m_maxSize)));
+    stop();
+    return;
+  }
+
+  if (!resumed) {
+    m_validator = m_reply->rawHeader(HTTP_HEADERS_ETAG);
+
+    if (m_validator.isEmpty()) {
+      m_validator = m_reply->rawHeader(HTTP_HEADERS_LAST_MODIFIED);
+    }
+
+    splitIntoSegments();
+  }
 }
 
-void DownloadItem::downloadProgress(qint64 bytes_received, qint64 bytes_total) {
+void DownloadItem::updateProgress() {
   QTime now = QTime::currentTime();
 
   if (m_lastProgressTime.isValid() && m_lastProgressTime.msecsTo(now) < 25) {
@@ -292,7 +568,20 @@ void DownloadItem::downloadProgress(qint64 bytes_received, qint64 bytes_total) {
   }
 
   m_lastProgressTime = now;
-  m_bytesReceived = bytes_received;
+
+  const qint64 bytes_received = bytesReceived();
+  const int sample_time = m_speedSampleTime.elapsed();
+
+  // Throughput is smoothed, so that ETA does not jump around.
+  if (sample_time >= DOWNLOAD_SPEED_SAMPLE_INTERVAL) {
+    const double sample_speed = (bytes_received - m_speedSampleBytes) * 1000.0 / sample_time;
+
+    m_speed = m_speed < 0.0 ? sample_speed : 0.7 * m_speed + 0.3 * sample_speed;
+    m_speedSampleBytes = bytes_received;
+    m_speedSampleTime.restart();
+  }
+
+  const qint64 bytes_total = bytesTotal();
   qint64 currentValue = 0;
   qint64 totalValue = 0;
 
@@ -309,19 +598,27 @@ void DownloadItem::downloadProgress(qint64 bytes_received, qint64 bytes_total) {
 }
 
 qint64 DownloadItem::bytesTotal() const {
-  return m_reply->header(QNetworkRequest::ContentLengthHeader).toULongLong();
+  return m_bytesTotal;
 }
 
 qint64 DownloadItem::bytesReceived() const {
-  return m_bytesReceived;
+  qint64 bytes_received = m_startOffset;
+
+  foreach (const Segment& segment, m_segments) {
+    bytes_received += segment.m_position - segment.m_start;
+  }
+
+  return bytes_received;
 }
 
 double DownloadItem::remainingTime() const {
-  if (!downloading()) {
+  const double speed = currentSpeed();
+
+  if (!downloading() || speed <= 0.0) {
     return -1.0;
   }
 
-  double time_remaining = ((double)(bytesTotal() - bytesReceived())) / currentSpeed();
+  double time_remaining = ((double)(bytesTotal() - bytesReceived())) / speed;
 
   // When downloading the ETA should never be 0.
   if ((int) time_remaining == 0) {
@@ -335,17 +632,21 @@ double DownloadItem::currentSpeed() const {
   if (!downloading()) {
     return -1.0;
   }
+  else if (m_speed >= 0.0) {
+    return m_speed;
+  }
   else {
-    return m_bytesReceived * 1000.0 / m_downloadTime.elapsed();
+    return (bytesReceived() - m_startOffset) * 1000.0 / qMax(1, m_downloadTime.elapsed());
   }
 }
 
 void DownloadItem::updateDownloadInfoLabel() {
-  if (m_reply->error() != QNetworkReply::NoError) {
+  if (m_failed) {
     return;
   }
 
-  const qint64 bytes_total = m_reply->header(QNetworkRequest::ContentLengthHeader).toULongLong();
+  const qint64 bytes_total = bytesTotal();
+  const qint64 bytes_received = bytesReceived();
   bool running = !downloadedSuccessfully();
   double speed = currentSpeed();
   double time_remaining = remainingTime();
@@ -354,22 +655,22 @@ void DownloadItem::updateDownloadInfoLabel() {
   if (running) {
     QString remaining;
 
-    if (bytes_total != 0) {
+    if (bytes_total != 0 && time_remaining >= 0.0) {
       remaining = DownloadManager::timeString(time_remaining);
     }
 
-    info = QString(tr("%1 of %2 (%3 per second) - %4")).arg(DownloadManager::dataString(m_bytesReceived),
+    info = QString(tr("%1 of %2 (%3 per second) - %4")).arg(DownloadManager::dataString(bytes_received),
                                                             bytes_total == 0 ? QSL("?") : DownloadManager::dataString(bytes_total),
-                                                            DownloadManager::dataString((int)speed),
+                                                            DownloadManager::dataString(qMax(0, (int)speed)),
                                                             remaining);
   }
   else {
-    if (m_bytesReceived == bytes_total) {
+    if (bytes_received == bytes_total) {
       info = DownloadManager::dataString(m_output.size());
     }
     else {
-      info = tr("%1 of %2 - download completed").arg(DownloadManager::dataString(m_bytesReceived),
-                                                     DownloadManager::dataString(m_bytesReceived));
+      info = tr("%1 of %2 - download completed").arg(DownloadManager::dataString(bytes_received),
+                                                     DownloadManager::dataString(bytes_received));
     }
   }
 
@@ -384,10 +685,21 @@ bool DownloadItem::downloadedSuccessfully() const {
   return (m_ui->m_btnStopDownload->isHidden() && m_ui->m_btnTryAgain->isHidden());
 }
 
+bool DownloadItem::running() const {
+  return m_running;
+}
+
 void DownloadItem::finished() {
-  m_finishedDownloading = true;
+  m_finishedDownloading = allRepliesFinished();
+
+  if (!m_running || !(allDataWritten() || (m_failed && m_finishedDownloading))) {
+    return;
+  }
+
+  m_running = false;
 
   if (!m_startedSaving) {
+    emit downloadFinished();
     return;
   }
 
@@ -401,7 +713,7 @@ void DownloadItem::finished() {
   emit statusChanged();
   emit downloadFinished();
 
-  if (downloadedSuccessfully()) {
+  if (downloadedSuccessfully() && !m_background) {
     qApp->showGuiMessage(tr("Download finished"),
                          tr("File '%1' is downloaded.\nClick here to open parent directory.").arg(QDir::toNativeSeparators(
                                                                                                     m_output.fileName())),
@@ -421,7 +733,9 @@ void DownloadItem::updateInfoAndUrlLabel() {
 
 DownloadManager::DownloadManager(QWidget* parent) : TabContent(parent), m_ui(new Ui::DownloadManager),
   m_autoSaver(new AutoSaver(this)), m_model(new DownloadModel(this)),
-  m_networkManager(SilentNetworkAccessManager::instance()), m_iconProvider(nullptr), m_removePolicy(Never) {
+  m_networkManager(SilentNetworkAccessManager::instance()), m_iconProvider(nullptr), m_removePolicy(Never),
+  m_maxConcurrentDownloads(1), m_downloadSegments(1), m_bandwidthLimit(0), m_bandwidthTokens(0), m_bandwidthRound(0),
+  m_bandwidthTimer(new QTimer(this)) {
   m_ui->setupUi(this);
   m_ui->m_viewDownloads->setShowGrid(false);
   m_ui->m_viewDownloads->verticalHeader()->hide();
@@ -431,6 +745,9 @@ DownloadManager::DownloadManager(QWidget* parent) : TabContent(parent), m_ui(new
   m_ui->m_viewDownloads->setModel(m_model);
   setDownloadDirectory(qApp->settings()->value(GROUP(Downloads), SETTING(Downloads::TargetDirectory)).toString());
   connect(m_ui->m_btnCleanup, &QPushButton::clicked, this, &DownloadManager::cleanup);
+  connect(m_bandwidthTimer, &QTimer::timeout, this, &DownloadManager::refillBandwidth);
+  m_bandwidthTimer->setInterval(DOWNLOAD_BANDWIDTH_TICK);
+  loadSettings();
   load();
 }
 
@@ -444,7 +761,7 @@ int DownloadManager::activeDownloads() const {
   int count = 0;
 
   foreach (const DownloadItem* download, m_downloads) {
-    if (download->downloading()) {
+    if (download->running()) {
       count++;
     }
   }
@@ -472,8 +789,20 @@ int DownloadManager::downloadProgress() const {
 }
 
 void DownloadManager::download(const QNetworkRequest& request) {
-  if (!request.url().isEmpty()) {
-    handleUnsupportedContent(m_networkManager->get(request));
+  if (request.url().isEmpty()) {
+    return;
+  }
+
+  DownloadItem* item = new DownloadItem(0, this);
+
+  item->m_url = request.url();
+  item->m_request = request;
+  addItem(item);
+  startOrQueue(item);
+
+  if (!item->m_canceledFileSelect && qApp->settings()->value(GROUP(Downloads),
+                                                             SETTING(Downloads::ShowDownloadsWhenNewDownloadStarts)).toBool()) {
+    qApp->mainForm()->tabWidget()->showDownloadManager();
   }
 }
 
@@ -481,6 +810,42 @@ void DownloadManager::download(const QUrl& url) {
   download(QNetworkRequest(url));
 }
 
+void DownloadManager::downloadInBackground(const QUrl& url, const QString& file_name, qint64 max_size) {
+  DownloadItem* item = nullptr;
+
+  foreach (DownloadItem* download, m_downloads) {
+    if (download->m_output.fileName() == file_name) {
+      item = download;
+      break;
+    }
+  }
+
+  if (item == nullptr) {
+    item = new DownloadItem(0, this);
+    item->m_output.setFileName(file_name);
+    item->m_startOffset = QFileInfo(file_name).size();
+    addItem(item);
+  }
+  else if (item->running() || m_queuedDownloads.contains(item)) {
+    return;
+  }
+  else if (item->downloadedSuccessfully()) {
+    emit backgroundDownloadFinished(file_name, true, false);
+    return;
+  }
+
+  item->m_url = url;
+  item->m_background = true;
+  item->m_requestFileName = false;
+  item->m_maxSize = max_size;
+  item->m_ui->m_btnTryAgain->setEnabled(false);
+  item->m_ui->m_btnTryAgain->setVisible(false);
+  item->m_ui->m_btnStopDownload->setEnabled(true);
+  item->m_ui->m_btnStopDownload->setVisible(true);
+  item->m_ui->m_progressDownload->setVisible(true);
+  startOrQueue(item);
+}
+
 void DownloadManager::handleUnsupportedContent(QNetworkReply* reply) {
   if (reply == nullptr || reply->url().isEmpty()) {
     return;
@@ -528,12 +893,109 @@ QNetworkAccessManager* DownloadManager::networkManager() const {
   return m_networkManager;
 }
 
+QNetworkRequest DownloadManager::createRequest(const QNetworkRequest& original_request) {
+  QNetworkRequest request = original_request;
+
+  // Downloaded files are usually big and are kept anyway.
+  request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+  request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+  return request;
+}
+
+QNetworkReply* DownloadManager::get(const QNetworkRequest& request) {
+  QNetworkReply* reply = m_networkManager->get(request);
+
+  if (m_bandwidthLimit > 0) {
+    // Let TCP slow the sender down instead of buffering whole file.
+    reply->setReadBufferSize(qMax(qint64(DOWNLOAD_THROTTLED_BUFFER_SIZE), m_bandwidthLimit * DOWNLOAD_BANDWIDTH_TICK / 1000));
+  }
+
+  return reply;
+}
+
+qint64 DownloadManager::acquireBandwidth(qint64 wanted) {
+  if (m_bandwidthLimit <= 0) {
+    return wanted;
+  }
+
+  const qint64 granted = qMin(wanted, m_bandwidthTokens);
+
+  m_bandwidthTokens -= granted;
+  return granted;
+}
+
+void DownloadManager::refillBandwidth() {
+  // Bucket never holds more than one second worth of data.
+  m_bandwidthTokens = qMin(m_bandwidthLimit, m_bandwidthTokens + m_bandwidthLimit * DOWNLOAD_BANDWIDTH_TICK / 1000);
+
+  // Start with different download each time, so that bandwidth is shared evenly.
+  const int count = m_downloads.size();
+
+  if (count > 0) {
+    m_bandwidthRound = (m_bandwidthRound + 1) % count;
+
+    for (int i = 0; i < count && m_bandwidthTokens > 0; i++) {
+      DownloadItem* item = m_downloads.at((m_bandwidthRound + i) % count);
+
+      if (item->running()) {
+        item->downloadReadyRead();
+      }
+    }
+  }
+}
+
+void DownloadManager::loadSettings() {
+  m_maxConcurrentDownloads = qMax(1, qApp->settings()->value(GROUP(Downloads), SETTING(Downloads::MaxConcurrentDownloads)).toInt());
+  m_downloadSegments = qMax(1, qApp->settings()->value(GROUP(Downloads), SETTING(Downloads::DownloadSegments)).toInt());
+  m_bandwidthLimit = qint64(qApp->settings()->value(GROUP(Downloads), SETTING(Downloads::MaxDownloadSpeed)).toInt()) * 1024;
+  m_bandwidthTokens = m_bandwidthLimit * DOWNLOAD_BANDWIDTH_TICK / 1000;
+
+  if (m_bandwidthLimit > 0) {
+    m_bandwidthTimer->start();
+  }
+  else {
+    m_bandwidthTimer->stop();
+
+    // Throttled downloads might have unread data.
+    foreach (DownloadItem* item, m_downloads) {
+      if (item->running()) {
+        item->downloadReadyRead();
+      }
+    }
+  }
+
+  startQueuedDownloads();
+}
+
+void DownloadManager::startOrQueue(DownloadItem* item) {
+  if (m_queuedDownloads.isEmpty() && activeDownloads() < m_maxConcurrentDownloads) {
+    item->startDownload();
+  }
+  else if (!m_queuedDownloads.contains(item)) {
+    m_queuedDownloads.append(item);
+    item->setQueued();
+  }
+}
+
+void DownloadManager::startQueuedDownloads() {
+  while (!m_queuedDownloads.isEmpty() && activeDownloads() < m_maxConcurrentDownloads) {
+    m_queuedDownloads.takeFirst()->startDownload();
+  }
+}
+
 int DownloadManager::totalDownloads() const {
   return m_downloads.size();
 }
 
 void DownloadManager::itemFinished() {
+  DownloadItem* item = qobject_cast<DownloadItem*>(sender());
+
+  startQueuedDownloads();
   emit downloadFinished();
+
+  if (item != nullptr && item->m_background && !item->running()) {
+    emit backgroundDownloadFinished(item->m_output.fileName(), item->downloadedSuccessfully(), item->m_sizeExceeded);
+  }
 }
 
 void DownloadManager::updateRow() {
@@ -617,6 +1079,8 @@ void DownloadManager::save() const {
     settings->setValue(GROUP(Downloads), QString(Downloads::ItemUrl).arg(i), m_downloads[i]->m_url);
     settings->setValue(GROUP(Downloads), QString(Downloads::ItemLocation).arg(i), QFileInfo(m_downloads[i]->m_output).filePath());
     settings->setValue(GROUP(Downloads), QString(Downloads::ItemDone).arg(i), m_downloads[i]->downloadedSuccessfully());
+    settings->setValue(GROUP(Downloads), QString(Downloads::ItemOffset).arg(i), m_downloads[i]->downloadedPrefix());
+    settings->setValue(GROUP(Downloads), QString(Downloads::ItemValidator).arg(i), QString::fromLatin1(m_downloads[i]->m_validator));
   }
 
   // Remove all redundant saved download items.
@@ -626,6 +1090,8 @@ void DownloadManager::save() const {
     settings->remove(GROUP(Downloads), key);
     settings->remove(GROUP(Downloads), QString(Downloads::ItemLocation).arg(i));
     settings->remove(GROUP(Downloads), QString(Downloads::ItemDone).arg(i));
+    settings->remove(GROUP(Downloads), QString(Downloads::ItemOffset).arg(i));
+    settings->remove(GROUP(Downloads), QString(Downloads::ItemValidator).arg(i));
     i++;
   }
 }
@@ -642,12 +1108,16 @@ void DownloadManager::load() {
     QUrl url = settings->value(GROUP(Downloads), QString(Downloads::ItemUrl).arg(i)).toUrl();
     QString file_name = settings->value(GROUP(Downloads), QString(Downloads::ItemLocation).arg(i)).toString();
     bool done = settings->value(GROUP(Downloads), QString(Downloads::ItemDone).arg(i), true).toBool();
+    qint64 offset = settings->value(GROUP(Downloads), QString(Downloads::ItemOffset).arg(i), -1).toLongLong();
+    QString validator = settings->value(GROUP(Downloads), QString(Downloads::ItemValidator).arg(i)).toString();
 
     if (!url.isEmpty() && !file_name.isEmpty()) {
       DownloadItem* item = new DownloadItem(0, this);
 
       item->m_output.setFileName(file_name);
       item->m_url = url;
+      item->m_validator = validator.toLatin1();
+      item->m_startOffset = offset < 0 ? QFileInfo(file_name).size() : offset;
       item->updateInfoAndUrlLabel();
       item->m_ui->m_btnStopDownload->setVisible(false);
       item->m_ui->m_btnStopDownload->setEnabled(false);
@@ -11,11 +11,13 @@
 #include <QDateTime>
 #include <QFile>
 #include <QNetworkReply>
+#include <QVector>
 
 class AutoSaver;
 class DownloadModel;
 class QFileIconProvider;
 class QMimeData;
+class QTimer;
 
 class DownloadItem : public QWidget {
   Q_OBJECT
@@ -33,6 +35,9 @@ class DownloadItem : public QWidget {
     bool downloading() const;
     bool downloadedSuccessfully() const;
 
+    // True if any network transfer of this item is in progress.
+    bool running() const;
+
     qint64 bytesTotal() const;
     qint64 bytesReceived() const;
     double remainingTime() const;
@@ -46,7 +51,6 @@ class DownloadItem : public QWidget {
 
     void downloadReadyRead();
     void error(QNetworkReply::NetworkError code);
-    void downloadProgress(qint64 bytes_received, qint64 bytes_total);
     void metaDataChanged();
     void finished();
 
@@ -56,24 +60,69 @@ class DownloadItem : public QWidget {
     void downloadFinished();
 
   private:
+
+    // Byte range of the file downloaded via its own connection.
+    // Downloads which are not split have single open-ended segment.
+    struct Segment {
+      QNetworkReply* m_reply;
+      qint64 m_start;
+      qint64 m_position;
+      qint64 m_end;
+    };
+
     void updateInfoAndUrlLabel();
     void getFileName();
     void init();
     void updateDownloadInfoLabel();
+    void updateProgress();
     QString saveFileName(const QString& directory) const;
 
+    // Starts (or resumes) the download, called by download manager
+    // once there is free download slot.
+    void startDownload();
+    void setQueued();
+
+    QNetworkRequest createRequest(qint64 start, qint64 end = -1) const;
+    void connectReply(QNetworkReply* reply);
+    void releaseReplies();
+    void splitIntoSegments();
+    void cancelSegments();
+    void readSegments();
+    bool allDataWritten() const;
+    bool allRepliesFinished() const;
+
+    // Number of bytes from the start of file which are surely downloaded.
+    qint64 downloadedPrefix() const;
+
     Ui::DownloadItem* m_ui;
     QUrl m_url;
+
+    // Request which started the download, its headers and
+    // attributes are used by all requests of the download.
+    QNetworkRequest m_request;
     QFile m_output;
     QNetworkReply* m_reply;
-    qint64 m_bytesReceived;
+    QVector<Segment> m_segments;
+    QByteArray m_validator;
+    qint64 m_startOffset;
+    qint64 m_bytesTotal;
     QTime m_downloadTime;
     QTime m_lastProgressTime;
+    QTime m_speedSampleTime;
+    qint64 m_speedSampleBytes;
+    double m_speed;
     bool m_requestFileName;
     bool m_startedSaving;
     bool m_finishedDownloading;
     bool m_gettingFileName;
     bool m_canceledFileSelect;
+    bool m_running;
+    bool m_failed;
+
+    // Background downloads have fixed target file and do not bother user.
+    bool m_background;
+    qint64 m_maxSize;
+    bool m_sizeExceeded;
 };
 
 #if defined(USE_WEBENGINE)
@@ -84,6 +133,7 @@ class DownloadManager : public TabContent {
   Q_OBJECT
   Q_PROPERTY(RemovePolicy removePolicy READ removePolicy WRITE setRemovePolicy NOTIFY removePolicyChanged)
 
+  friend class DownloadItem;
   friend class DownloadModel;
 
   public:
@@ -106,6 +156,17 @@ class DownloadManager : public TabContent {
 
     QNetworkAccessManager* networkManager() const;
 
+    // Creates request for downloading based on given request. Downloads
+    // bypass network disk cache.
+    static QNetworkRequest createRequest(const QNetworkRequest& request);
+
+    // Starts download of given request respecting current bandwidth limit.
+    QNetworkReply* get(const QNetworkRequest& request);
+
+    // Token bucket shared by all downloads. Returns how many of wanted bytes
+    // can be read right now and takes them from the bucket.
+    qint64 acquireBandwidth(qint64 wanted);
+
     int totalDownloads() const;
     int activeDownloads() const;
     int downloadProgress() const;
@@ -120,8 +181,16 @@ class DownloadManager : public TabContent {
     static QString dataString(qint64 size);
 
   public slots:
+
+    // Reloads limits of concurrent downloads, bandwidth and segments.
+    void loadSettings();
+
     void download(const QNetworkRequest& request);
     void download(const QUrl& url);
+
+    // Downloads URL into given file without any user interaction. Partially
+    // downloaded file is resumed. Files bigger than max_size are not downloaded.
+    void downloadInBackground(const QUrl& url, const QString& file_name, qint64 max_size = -1);
     void handleUnsupportedContent(QNetworkReply* reply);
     void cleanup();
 
@@ -133,15 +202,22 @@ class DownloadManager : public TabContent {
     void updateRow();
     void itemProgress();
     void itemFinished();
+    void refillBandwidth();
 
   signals:
     void removePolicyChanged();
     void downloadProgressed(int progress, const QString& description);
     void downloadFinished();
+    void backgroundDownloadFinished(const QString& file_name, bool successfully, bool size_exceeded);
 
   private:
     void addItem(DownloadItem* item);
 
+    // Starts download right away or puts it to the queue if there
+    // are too many running downloads.
+    void startOrQueue(DownloadItem* item);
+    void startQueuedDownloads();
+
     QScopedPointer<Ui::DownloadManager> m_ui;
     AutoSaver* m_autoSaver;
     DownloadModel* m_model;
@@ -149,8 +225,18 @@ class DownloadManager : public TabContent {
 
     QScopedPointer<QFileIconProvider> m_iconProvider;
     QList<DownloadItem*> m_downloads;
+    QList<DownloadItem*> m_queuedDownloads;
     RemovePolicy m_removePolicy;
     QString m_downloadDirectory;
+
+    int m_maxConcurrentDownloads;
+    int m_downloadSegments;
+
+    // Bandwidth limit in bytes per second, zero means no limit.
+    qint64 m_bandwidthLimit;
+    qint64 m_bandwidthTokens;
+    int m_bandwidthRound;
+    QTimer* m_bandwidthTimer;
 };
 
 class DownloadModel : public QAbstractListModel {
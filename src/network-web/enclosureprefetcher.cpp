@@ -0,0 +1,234 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "network-web/enclosureprefetcher.h"
+
+#include "core/message.h"
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/databasequeries.h"
+#include "network-web/downloadmanager.h"
+#include "services/abstract/feed.h"
+#include "services/abstract/serviceroot.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTimer>
+
+EnclosurePolicy::EnclosurePolicy() : m_enabled(false), m_mimeTypes(QStringList()), m_maxSize(0), m_keepLast(0) {}
+
+bool EnclosurePolicy::matches(const Enclosure& enclosure) const {
+  if (m_mimeTypes.isEmpty()) {
+    return true;
+  }
+
+  foreach (const QString& mime_type, m_mimeTypes) {
+    if (QRegExp(mime_type.trimmed(), Qt::CaseInsensitive, QRegExp::Wildcard).exactMatch(enclosure.m_mimeType)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+EnclosureFile::EnclosureFile() : m_accountId(0), m_state(Pending) {}
+
+EnclosurePrefetcher::EnclosurePrefetcher(QObject* parent) : QObject(parent) {
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+
+  foreach (const EnclosureFile& file, DatabaseQueries::getEnclosureFiles(database)) {
+    if (file.m_state == EnclosureFile::Downloaded && QFile::exists(file.m_fileName)) {
+      m_localFiles.insert(file.m_url, file.m_fileName);
+    }
+  }
+
+  QTimer::singleShot(ENCLOSURE_PREFETCH_RESUME_DELAY, this, &EnclosurePrefetcher::resumePendingDownloads);
+}
+
+EnclosurePrefetcher::~EnclosurePrefetcher() {
+  qDebug("Destroying EnclosurePrefetcher instance.");
+}
+
+QString EnclosurePrefetcher::localFile(const QString& url) const {
+  return m_localFiles.value(url);
+}
+
+void EnclosurePrefetcher::prefetch(Feed* feed, const QList<Message>& messages) {
+  const int account_id = feed->getParentServiceRoot()->accountId();
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  const EnclosurePolicy policy = DatabaseQueries::getEnclosurePolicy(database, feed->customId(), account_id);
+
+  if (!policy.m_enabled) {
+    return;
+  }
+
+  // Newest messages go first, so that only newest files are downloaded
+  // when there is a limit.
+  QList<Message> sorted_messages = messages;
+  QList<EnclosureFile> files;
+  QSet<QString> urls;
+
+  std::sort(sorted_messages.begin(), sorted_messages.end(), [](const Message& lhs, const Message& rhs) {
+    return lhs.m_created > rhs.m_created;
+  });
+
+  foreach (const Message& message, sorted_messages) {
+    foreach (const Enclosure& enclosure, message.m_enclosures) {
+      if (!enclosure.m_url.startsWith(QSL("http")) || urls.contains(enclosure.m_url) || !policy.matches(enclosure)) {
+        continue;
+      }
+
+      EnclosureFile file;
+
+      file.m_accountId = account_id;
+      file.m_feedId = feed->customId();
+      file.m_url = enclosure.m_url;
+      file.m_fileName = targetFileName(feed, enclosure.m_url);
+      file.m_created = message.m_created;
+      files.append(file);
+      urls.insert(enclosure.m_url);
+    }
+  }
+
+  if (policy.m_keepLast > 0) {
+    files = files.mid(0, policy.m_keepLast);
+  }
+
+  foreach (const EnclosureFile& file, files) {
+    bool ok;
+    const EnclosureFile stored_file = DatabaseQueries::getEnclosureFile(database, file.m_url, account_id, &ok);
+
+    if (!ok) {
+      continue;
+    }
+    else if (stored_file.m_url.isEmpty()) {
+      if (DatabaseQueries::addEnclosureFile(database, file)) {
+        download(file, policy);
+      }
+    }
+    else if (stored_file.m_state == EnclosureFile::Pending) {
+      // Download failed or was interrupted, try again.
+      download(stored_file, policy);
+    }
+  }
+
+  prune(account_id, feed->customId(), policy.m_keepLast);
+}
+
+void EnclosurePrefetcher::resumePendingDownloads() {
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  QHash<QString, EnclosurePolicy> policies;
+  QHash<int, QStringList> orphaned_files;
+
+  foreach (const EnclosureFile& file, DatabaseQueries::getEnclosureFiles(database)) {
+    if (file.m_state != EnclosureFile::Pending) {
+      continue;
+    }
+
+    const QString policy_key = QString::number(file.m_accountId) + QL1C('-') + file.m_feedId;
+
+    if (!policies.contains(policy_key)) {
+      policies.insert(policy_key, DatabaseQueries::getEnclosurePolicy(database, file.m_feedId, file.m_accountId));
+    }
+
+    if (policies[policy_key].m_enabled) {
+      download(file, policies[policy_key]);
+    }
+    else {
+      // User does not want enclosures of this feed anymore.
+      QFile::remove(file.m_fileName);
+      orphaned_files[file.m_accountId].append(file.m_fileName);
+    }
+  }
+
+  for (auto i = orphaned_files.constBegin(); i != orphaned_files.constEnd(); i++) {
+    DatabaseQueries::setEnclosureFilesState(database, i.key(), i.value(), EnclosureFile::Rejected);
+  }
+
+  qDebug("Resumed %d pending enclosure downloads.", m_downloads.size());
+}
+
+void EnclosurePrefetcher::onDownloadFinished(const QString& file_name, bool successfully, bool size_exceeded) {
+  if (!m_downloads.contains(file_name) || (!successfully && !size_exceeded)) {
+    // Failed downloads stay pending and are resumed later.
+    return;
+  }
+
+  const EnclosureFile file = m_downloads.take(file_name);
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+
+  if (successfully) {
+    qDebug("Enclosure '%s' was downloaded to '%s'.", qPrintable(file.m_url), qPrintable(file_name));
+    DatabaseQueries::setEnclosureFilesState(database, file.m_accountId, QStringList() << file_name, EnclosureFile::Downloaded);
+    m_localFiles.insert(file.m_url, file_name);
+    prune(file.m_accountId, file.m_feedId,
+          DatabaseQueries::getEnclosurePolicy(database, file.m_feedId, file.m_accountId).m_keepLast);
+  }
+  else {
+    qDebug("Enclosure '%s' is too big, it is not downloaded.", qPrintable(file.m_url));
+    QFile::remove(file_name);
+    DatabaseQueries::setEnclosureFilesState(database, file.m_accountId, QStringList() << file_name, EnclosureFile::Rejected);
+  }
+}
+
+QString EnclosurePrefetcher::targetFileName(const Feed* feed, const QString& url) const {
+  QString feed_directory = feed->title();
+  QString file_name = QFileInfo(QUrl(url).path()).fileName();
+
+  feed_directory.replace(QRegularExpression(QSL("[\\\\/:*?\"<>|]")), QSL("_"));
+
+  if (file_name.isEmpty()) {
+    file_name = QSL("enclosure");
+  }
+
+  // Hash of URL keeps names of different files with same name unique.
+  return qApp->downloadManager()->downloadDirectory() + ENCLOSURE_PREFETCH_SUBDIRECTORY + QDir::separator() +
+         feed_directory.simplified() + QDir::separator() +
+         QString::fromLatin1(QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex().left(8)) +
+         QL1C('-') + file_name;
+}
+
+void EnclosurePrefetcher::download(const EnclosureFile& file, const EnclosurePolicy& policy) {
+  DownloadManager* manager = qApp->downloadManager();
+
+  if (!QDir().mkpath(QFileInfo(file.m_fileName).absolutePath())) {
+    qWarning("Cannot create directory for enclosure '%s'.", qPrintable(file.m_fileName));
+    return;
+  }
+
+  connect(manager, &DownloadManager::backgroundDownloadFinished, this, &EnclosurePrefetcher::onDownloadFinished,
+          Qt::UniqueConnection);
+  m_downloads.insert(file.m_fileName, file);
+  manager->downloadInBackground(QUrl(file.m_url), file.m_fileName, policy.m_maxSize > 0 ? qint64(policy.m_maxSize) * 1048576 : -1);
+}
+
+void EnclosurePrefetcher::prune(int account_id, const QString& feed_custom_id, int keep_last) {
+  if (keep_last <= 0) {
+    return;
+  }
+
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  QStringList obsolete_files;
+  int kept_files = 0;
+
+  foreach (const EnclosureFile& file, DatabaseQueries::getEnclosureFilesForFeed(database, feed_custom_id, account_id)) {
+    if (file.m_state != EnclosureFile::Downloaded) {
+      continue;
+    }
+    else if (kept_files < keep_last) {
+      kept_files++;
+    }
+    else if (QFile::remove(file.m_fileName) || !QFile::exists(file.m_fileName)) {
+      m_localFiles.remove(file.m_url);
+      obsolete_files.append(file.m_fileName);
+    }
+  }
+
+  if (!obsolete_files.isEmpty()) {
+    qDebug("Removing %d old enclosures of feed '%s'.", obsolete_files.size(), qPrintable(feed_custom_id));
+    DatabaseQueries::setEnclosureFilesState(database, account_id, obsolete_files, EnclosureFile::Pruned);
+  }
+}
@@ -0,0 +1,93 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef ENCLOSUREPREFETCHER_H
+#define ENCLOSUREPREFETCHER_H
+
+#include <QObject>
+
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+
+class Feed;
+class Message;
+struct Enclosure;
+
+// Per-feed rules for automatic download of enclosures.
+struct EnclosurePolicy {
+  public:
+    explicit EnclosurePolicy();
+
+    bool matches(const Enclosure& enclosure) const;
+
+    bool m_enabled;
+
+    // Wildcard patterns like "audio/*", empty list matches all enclosures.
+    QStringList m_mimeTypes;
+
+    // Maximal size of one file in MB, zero means no limit.
+    int m_maxSize;
+
+    // Number of newest files kept for the feed, zero keeps all.
+    int m_keepLast;
+};
+
+// Enclosure which was (or is being) downloaded for offline use.
+struct EnclosureFile {
+  public:
+    enum State {
+      Pending = 0,
+      Downloaded = 1,
+      Rejected = 2,
+      Pruned = 3
+    };
+
+    explicit EnclosureFile();
+
+    int m_accountId;
+    QString m_feedId;
+    QString m_url;
+    QString m_fileName;
+    State m_state;
+    QDateTime m_created;
+};
+
+// Downloads enclosures of new messages through download manager
+// according to policies of their feeds and prunes old files.
+class EnclosurePrefetcher : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit EnclosurePrefetcher(QObject* parent = nullptr);
+    virtual ~EnclosurePrefetcher();
+
+    // Returns local copy of enclosure with given URL or
+    // empty string if it was not downloaded.
+    QString localFile(const QString& url) const;
+
+  public slots:
+
+    // Enqueues matching enclosures of given messages of the feed.
+    void prefetch(Feed* feed, const QList<Message>& messages);
+
+    // Restarts downloads which failed or were interrupted by application exit.
+    void resumePendingDownloads();
+
+  private slots:
+    void onDownloadFinished(const QString& file_name, bool successfully, bool size_exceeded);
+
+  private:
+    QString targetFileName(const Feed* feed, const QString& url) const;
+    void download(const EnclosureFile& file, const EnclosurePolicy& policy);
+
+    // Removes files which are over the limit of given feed.
+    void prune(int account_id, const QString& feed_custom_id, int keep_last);
+
+    // Maps URLs of downloaded enclosures to local files.
+    QHash<QString, QString> m_localFiles;
+
+    // Downloads started by this instance, keyed by target file.
+    QHash<QString, EnclosureFile> m_downloads;
+};
+
+#endif // ENCLOSUREPREFETCHER_H
@@ -0,0 +1,100 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "network-web/imageprefetcher.h"
+
+#include "core/message.h"
+#include "definitions/definitions.h"
+#include "network-web/networkdiskcache.h"
+#include "network-web/silentnetworkaccessmanager.h"
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+ImagePrefetcher::ImagePrefetcher(QObject* parent)
+  : QObject(parent), m_network(new SilentNetworkAccessManager(this)), m_runningDownloads(0), m_downloadedImages(0),
+  m_skippedImages(0) {
+  m_network->setCache(new NetworkDiskCache(m_network));
+}
+
+ImagePrefetcher::~ImagePrefetcher() {
+  qDebug("Destroying ImagePrefetcher instance.");
+}
+
+QList<QUrl> ImagePrefetcher::imageUrls(const Message& message) {
+  QList<QUrl> urls;
+
+  foreach (const Enclosure& enclosure, message.m_enclosures) {
+    if (enclosure.m_mimeType.startsWith(QSL("image/"))) {
+      urls.append(QUrl(enclosure.m_url));
+    }
+  }
+
+  // Images of contents were extracted when message was processed.
+  for (int i = 0; i < message.m_imageUrls.size() && urls.size() < IMAGE_PREFETCH_MAX_PER_MESSAGE; i++) {
+    const QUrl url = QUrl(message.m_url).resolved(QUrl(message.m_imageUrls.at(i)));
+
+    if (url.scheme().startsWith(QSL("http"))) {
+      urls.append(url);
+    }
+  }
+
+  return urls;
+}
+
+void ImagePrefetcher::prefetch(const QList<QUrl>& urls) {
+  foreach (const QUrl& url, urls) {
+    if (m_queue.size() >= IMAGE_PREFETCH_MAX_QUEUE) {
+      break;
+    }
+
+    if (url.isValid() && !m_queuedUrls.contains(url)) {
+      m_queuedUrls.insert(url);
+      m_queue.append(url);
+    }
+  }
+
+  startDownloads();
+}
+
+void ImagePrefetcher::onImageDownloaded() {
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+
+  m_runningDownloads--;
+
+  if (reply->error() == QNetworkReply::NoError) {
+    m_downloadedImages++;
+  }
+
+  reply->deleteLater();
+  startDownloads();
+}
+
+void ImagePrefetcher::startDownloads() {
+  m_network->updateSettings();
+
+  while (m_runningDownloads < IMAGE_PREFETCH_PARALLEL && !m_queue.isEmpty()) {
+    const QUrl url = m_queue.takeFirst();
+
+    if (NetworkDiskCache::isCached(url)) {
+      m_skippedImages++;
+      continue;
+    }
+
+    QNetworkRequest request(url);
+
+    request.setPriority(QNetworkRequest::LowPriority);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, true);
+
+    QNetworkReply* reply = m_network->get(request);
+
+    connect(reply, &QNetworkReply::finished, this, &ImagePrefetcher::onImageDownloaded);
+    m_runningDownloads++;
+  }
+
+  if (m_runningDownloads == 0 && m_queue.isEmpty() && !m_queuedUrls.isEmpty()) {
+    qDebug("Image prefetching finished, %d images downloaded, %d already cached. Network cache hits: %d, misses: %d.",
+           m_downloadedImages, m_skippedImages, NetworkDiskCache::hits(), NetworkDiskCache::misses());
+    m_queuedUrls.clear();
+  }
+}
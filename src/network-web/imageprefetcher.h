@@ -0,0 +1,50 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef IMAGEPREFETCHER_H
+#define IMAGEPREFETCHER_H
+
+#include <QObject>
+
+#include <QList>
+#include <QSet>
+#include <QUrl>
+
+class Message;
+class SilentNetworkAccessManager;
+
+// Downloads images referenced by new messages into network disk
+// cache in the background, so that they are available even offline.
+// Only few low-priority downloads run at a time.
+class ImagePrefetcher : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit ImagePrefetcher(QObject* parent = nullptr);
+    virtual ~ImagePrefetcher();
+
+    // Returns URLs of images referenced by message contents
+    // and of image enclosures.
+    static QList<QUrl> imageUrls(const Message& message);
+
+  public slots:
+
+    // Enqueues given images, already cached ones are skipped.
+    void prefetch(const QList<QUrl>& urls);
+
+  private slots:
+    void onImageDownloaded();
+
+  private:
+    void startDownloads();
+
+    // Only this manager stores responses to disk cache, responses of
+    // feeds and service APIs might contain private data.
+    SilentNetworkAccessManager* m_network;
+    QList<QUrl> m_queue;
+    QSet<QUrl> m_queuedUrls;
+    int m_runningDownloads;
+    int m_downloadedImages;
+    int m_skippedImages;
+};
+
+#endif // IMAGEPREFETCHER_H
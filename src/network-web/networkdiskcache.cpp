@@ -0,0 +1,144 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "network-web/networkdiskcache.h"
+
+#include "miscellaneous/application.h"
+
+#include <QDir>
+#include <QNetworkDiskCache>
+
+QMutex NetworkDiskCache::s_mutex(QMutex::Recursive);
+QSet<QUrl> NetworkDiskCache::s_refreshedUrls;
+QAtomicInt NetworkDiskCache::s_hits(0);
+QAtomicInt NetworkDiskCache::s_misses(0);
+
+NetworkDiskCache::NetworkDiskCache(QObject* parent) : QAbstractNetworkCache(parent) {}
+
+NetworkDiskCache::~NetworkDiskCache() {}
+
+QNetworkCacheMetaData NetworkDiskCache::metaData(const QUrl& url) {
+  QMutexLocker locker(&s_mutex);
+  const QNetworkCacheMetaData meta_data = sharedCache()->metaData(url);
+
+  if (meta_data.isValid()) {
+    s_hits.ref();
+  }
+  else {
+    s_misses.ref();
+  }
+
+  return meta_data;
+}
+
+void NetworkDiskCache::updateMetaData(const QNetworkCacheMetaData& meta_data) {
+  QMutexLocker locker(&s_mutex);
+
+  sharedCache()->updateMetaData(meta_data);
+}
+
+QIODevice* NetworkDiskCache::data(const QUrl& url) {
+  QMutexLocker locker(&s_mutex);
+  QNetworkDiskCache* cache = sharedCache();
+
+  refreshEntry(cache, url);
+  return cache->data(url);
+}
+
+bool NetworkDiskCache::remove(const QUrl& url) {
+  QMutexLocker locker(&s_mutex);
+
+  return sharedCache()->remove(url);
+}
+
+qint64 NetworkDiskCache::cacheSize() const {
+  QMutexLocker locker(&s_mutex);
+
+  return sharedCache()->cacheSize();
+}
+
+QIODevice* NetworkDiskCache::prepare(const QNetworkCacheMetaData& meta_data) {
+  QMutexLocker locker(&s_mutex);
+
+  return sharedCache()->prepare(meta_data);
+}
+
+void NetworkDiskCache::insert(QIODevice* device) {
+  QMutexLocker locker(&s_mutex);
+
+  sharedCache()->insert(device);
+}
+
+void NetworkDiskCache::clear() {
+  QMutexLocker locker(&s_mutex);
+
+  s_refreshedUrls.clear();
+  sharedCache()->clear();
+}
+
+bool NetworkDiskCache::isCached(const QUrl& url) {
+  QMutexLocker locker(&s_mutex);
+
+  return sharedCache()->metaData(url).isValid();
+}
+
+QByteArray NetworkDiskCache::cachedData(const QUrl& url) {
+  QMutexLocker locker(&s_mutex);
+  QNetworkDiskCache* cache = sharedCache();
+
+  refreshEntry(cache, url);
+  QIODevice* device = cache->data(url);
+
+  if (device == nullptr) {
+    s_misses.ref();
+    return QByteArray();
+  }
+  else {
+    const QByteArray data = device->readAll();
+
+    s_hits.ref();
+    delete device;
+    return data;
+  }
+}
+
+int NetworkDiskCache::hits() {
+  return s_hits.load();
+}
+
+int NetworkDiskCache::misses() {
+  return s_misses.load();
+}
+
+QNetworkDiskCache* NetworkDiskCache::sharedCache() {
+  // NOTE: Caller holds the mutex.
+  static QNetworkDiskCache* cache = nullptr;
+
+  if (cache == nullptr) {
+    cache = new QNetworkDiskCache();
+    cache->setCacheDirectory(qApp->userDataFolder() + QDir::separator() + NETWORK_CACHE_SUBDIRECTORY);
+    cache->setMaximumCacheSize(NETWORK_CACHE_MAX_SIZE);
+
+    qDebug("Using network disk cache in '%s'.", qPrintable(QDir::toNativeSeparators(cache->cacheDirectory())));
+  }
+
+  return cache;
+}
+
+void NetworkDiskCache::refreshEntry(QNetworkDiskCache* cache, const QUrl& url) {
+  if (s_refreshedUrls.contains(url)) {
+    return;
+  }
+
+  const QNetworkCacheMetaData meta_data = cache->metaData(url);
+
+  if (meta_data.isValid()) {
+    if (s_refreshedUrls.size() >= NETWORK_CACHE_MAX_REFRESHED) {
+      // Forgetting refreshed entries only means they are rewritten once more.
+      s_refreshedUrls.clear();
+    }
+
+    // Rewriting the entry makes it the newest one, so it is evicted last.
+    s_refreshedUrls.insert(url);
+    cache->updateMetaData(meta_data);
+  }
+}
@@ -0,0 +1,62 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef NETWORKDISKCACHE_H
+#define NETWORKDISKCACHE_H
+
+#include <QAbstractNetworkCache>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSet>
+#include <QUrl>
+
+class QNetworkDiskCache;
+
+// Size-bounded on-disk HTTP cache shared by network managers of images.
+//
+// Each network manager takes ownership of its cache object, so every
+// manager gets its own instance of this class. All instances forward
+// to one application-wide QNetworkDiskCache, guarded by a mutex.
+//
+// QNetworkDiskCache evicts oldest entries first, so each entry is
+// rewritten on its first hit in a session to keep the eviction
+// order close to least-recently-used.
+class NetworkDiskCache : public QAbstractNetworkCache {
+  Q_OBJECT
+
+  public:
+    explicit NetworkDiskCache(QObject* parent = nullptr);
+    virtual ~NetworkDiskCache();
+
+    QNetworkCacheMetaData metaData(const QUrl& url);
+    void updateMetaData(const QNetworkCacheMetaData& meta_data);
+    QIODevice* data(const QUrl& url);
+    bool remove(const QUrl& url);
+    qint64 cacheSize() const;
+    QIODevice* prepare(const QNetworkCacheMetaData& meta_data);
+    void insert(QIODevice* device);
+
+    // Returns true if there is cached response for given URL.
+    static bool isCached(const QUrl& url);
+
+    // Returns cached body for given URL or empty array.
+    static QByteArray cachedData(const QUrl& url);
+
+    // Number of cache lookups which were (not) served from cache.
+    static int hits();
+    static int misses();
+
+  public slots:
+    void clear();
+
+  private:
+    static QNetworkDiskCache* sharedCache();
+    static void refreshEntry(QNetworkDiskCache* cache, const QUrl& url);
+
+    static QMutex s_mutex;
+    static QSet<QUrl> s_refreshedUrls;
+    static QAtomicInt s_hits;
+    static QAtomicInt s_misses;
+};
+
+#endif // NETWORKDISKCACHE_H
@@ -6,13 +6,27 @@
 
 #include <QAuthenticator>
 #include <QNetworkReply>
+#include <QThreadStorage>
 
-Q_GLOBAL_STATIC(SilentNetworkAccessManager, qz_silent_acmanager)
+QAtomicInt SilentNetworkAccessManager::s_settingsRevision(0);
+QAtomicInt SilentNetworkAccessManager::s_openedConnections(0);
+QAtomicInt SilentNetworkAccessManager::s_secureRequests(0);
+QAtomicInt SilentNetworkAccessManager::s_http2Requests(0);
+
+// QNetworkAccessManager cannot be used across threads,
+// so each thread gets its own instance which lives as long as the thread.
+static QThreadStorage<SilentNetworkAccessManager*> s_threadManagers;
 
 SilentNetworkAccessManager::SilentNetworkAccessManager(QObject* parent)
-  : BaseNetworkAccessManager(parent) {
+  : BaseNetworkAccessManager(parent), m_settingsRevision(s_settingsRevision.load()) {
   connect(this, &SilentNetworkAccessManager::authenticationRequired,
           this, &SilentNetworkAccessManager::onAuthenticationRequired, Qt::DirectConnection);
+
+#if !defined(QT_NO_SSL)
+  connect(this, &SilentNetworkAccessManager::encrypted, this, &SilentNetworkAccessManager::onEncrypted);
+#endif
+
+  connect(this, &SilentNetworkAccessManager::finished, this, &SilentNetworkAccessManager::onFinished);
 }
 
 SilentNetworkAccessManager::~SilentNetworkAccessManager() {
@@ -20,7 +34,58 @@ SilentNetworkAccessManager::~SilentNetworkAccessManager() {
 }
 
 SilentNetworkAccessManager* SilentNetworkAccessManager::instance() {
-  return qz_silent_acmanager();
+  if (!s_threadManagers.hasLocalData()) {
+    s_threadManagers.setLocalData(new SilentNetworkAccessManager());
+  }
+
+  SilentNetworkAccessManager* manager = s_threadManagers.localData();
+
+  manager->updateSettings();
+  return manager;
+}
+
+void SilentNetworkAccessManager::updateSettings() {
+  if (m_settingsRevision != s_settingsRevision.load()) {
+    // Settings were changed since this instance loaded them.
+    BaseNetworkAccessManager::loadSettings();
+    m_settingsRevision = s_settingsRevision.load();
+  }
+}
+
+int SilentNetworkAccessManager::openedConnections() {
+  return s_openedConnections.load();
+}
+
+int SilentNetworkAccessManager::reusedConnections() {
+  return qMax(0, s_secureRequests.load() - s_openedConnections.load());
+}
+
+int SilentNetworkAccessManager::http2Requests() {
+  return s_http2Requests.load();
+}
+
+void SilentNetworkAccessManager::loadSettings() {
+  m_settingsRevision = s_settingsRevision.fetchAndAddOrdered(1) + 1;
+  BaseNetworkAccessManager::loadSettings();
+}
+
+void SilentNetworkAccessManager::onEncrypted(QNetworkReply* reply) {
+  Q_UNUSED(reply)
+
+  // Emitted only when new connection finishes its TLS handshake.
+  s_openedConnections.ref();
+}
+
+void SilentNetworkAccessManager::onFinished(QNetworkReply* reply) {
+  if (reply->attribute(QNetworkRequest::ConnectionEncryptedAttribute).toBool()) {
+    s_secureRequests.ref();
+  }
+
+#if QT_VERSION >= 0x050900
+  if (reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool()) {
+    s_http2Requests.ref();
+  }
+#endif
 }
 
 void SilentNetworkAccessManager::onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator) {
@@ -5,10 +5,15 @@
 
 #include "network-web/basenetworkaccessmanager.h"
 
+#include <QAtomicInt>
 #include <QPointer>
 
 // Network manager used for more communication for feeds.
 // This network manager does not provide any GUI interaction options.
+//
+// There is one long-lived instance per thread, shared by all downloaders
+// of that thread, so that established connections, DNS lookups, TLS sessions
+// and authentication are reused between requests.
 class SilentNetworkAccessManager : public BaseNetworkAccessManager {
   Q_OBJECT
 
@@ -18,13 +23,41 @@ class SilentNetworkAccessManager : public BaseNetworkAccessManager {
     explicit SilentNetworkAccessManager(QObject* parent = 0);
     virtual ~SilentNetworkAccessManager();
 
-    // Returns pointer to global silent network manager
+    // Returns pointer to silent network manager of calling thread.
     static SilentNetworkAccessManager* instance();
 
+    // Number of TLS connections established so far by all instances.
+    static int openedConnections();
+
+    // Number of TLS requests which were served via already established connection.
+    static int reusedConnections();
+
+    // Number of requests served via HTTP/2.
+    static int http2Requests();
+
+    // Reloads settings if they were changed since this instance loaded them.
+    void updateSettings();
+
   public slots:
 
+    // Reloads settings of this instance and marks settings
+    // of instances in other threads as outdated.
+    void loadSettings();
+
     // This cannot do any GUI stuff.
     void onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator);
+
+  private slots:
+    void onEncrypted(QNetworkReply* reply);
+    void onFinished(QNetworkReply* reply);
+
+  private:
+    int m_settingsRevision;
+
+    static QAtomicInt s_settingsRevision;
+    static QAtomicInt s_openedConnections;
+    static QAtomicInt s_secureRequests;
+    static QAtomicInt s_http2Requests;
 };
 
 #endif // SILENTNETWORKACCESSMANAGER_H
@@ -2,137 +2,268 @@
 
 #include "services/abstract/cacheforserviceroot.h"
 
+#include "definitions/definitions.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/databasequeries.h"
 #include "miscellaneous/mutex.h"
 
 #include <QDir>
-#include <QSet>
+#include <QMap>
+#include <QMutexLocker>
 
 CacheForServiceRoot::CacheForServiceRoot() : m_cacheSaveMutex(new Mutex(QMutex::NonRecursive, nullptr)),
-  m_cachedStatesRead(QMap<RootItem::ReadStatus, QStringList>()),
-  m_cachedStatesImportant(QMap<RootItem::Importance, QList<Message>>()) {}
+  m_cacheAccountId(NO_PARENT_CATEGORY), m_cachedStatesRead(QHash<QString, RootItem::ReadStatus>()),
+  m_cachedStatesImportant(QHash<QString, Message>()), m_cacheFailedAttempts(0), m_cacheNextAttempt(QDateTime()),
+  m_cacheSending(0) {}
 
 CacheForServiceRoot::~CacheForServiceRoot() {
   m_cacheSaveMutex->deleteLater();
 }
 
 void CacheForServiceRoot::addMessageStatesToCache(const QList<Message>& ids_of_messages, RootItem::Importance importance) {
+  if (ids_of_messages.isEmpty()) {
+    return;
+  }
+
   m_cacheSaveMutex->lock();
 
-  QList<Message>& list_act = m_cachedStatesImportant[importance];
-  QList<Message>& list_other = m_cachedStatesImportant[importance == RootItem::Important ? RootItem::NotImportant : RootItem::Important];
+  // Store changes, they will be sent to server later. Newer state
+  // of message overwrites the older one.
+  foreach (Message message, ids_of_messages) {
+    message.m_isImportant = importance == RootItem::Important;
+    m_cachedStatesImportant.insert(message.m_customId, message);
+  }
 
-  // Store changes, they will be sent to server later.
-  list_act.append(ids_of_messages);
-  QSet<Message> set_act = list_act.toSet();
-  QSet<Message> set_other = list_other.toSet();
+  if (m_cacheAccountId > 0) {
+    QSqlDatabase database = qApp->database()->connection(QSL("CacheForServiceRoot"), DatabaseFactory::FromSettings);
 
-  // Now, we want to remove all IDS from list_other, which are contained in list.
-  set_other -= set_act;
-  list_act.clear();
-  list_act.append(set_act.toList());
-  list_other.clear();
-  list_other.append(set_other.toList());
+    DatabaseQueries::storeMessageStatesToOutbox(database, m_cacheAccountId, ids_of_messages, importance);
+  }
 
   m_cacheSaveMutex->unlock();
 }
 
 void CacheForServiceRoot::addMessageStatesToCache(const QStringList& ids_of_messages, RootItem::ReadStatus read) {
+  if (ids_of_messages.isEmpty()) {
+    return;
+  }
+
   m_cacheSaveMutex->lock();
 
-  QStringList& list_act = m_cachedStatesRead[read];
-  QStringList& list_other = m_cachedStatesRead[read == RootItem::Read ? RootItem::Unread : RootItem::Read];
+  // Store changes, they will be sent to server later. Newer state
+  // of message overwrites the older one.
+  foreach (const QString& custom_id, ids_of_messages) {
+    m_cachedStatesRead.insert(custom_id, read);
+  }
 
-  // Store changes, they will be sent to server later.
-  list_act.append(ids_of_messages);
-  QSet<QString> set_act = list_act.toSet();
-  QSet<QString> set_other = list_other.toSet();
+  if (m_cacheAccountId > 0) {
+    QSqlDatabase database = qApp->database()->connection(QSL("CacheForServiceRoot"), DatabaseFactory::FromSettings);
 
-  // Now, we want to remove all IDS from list_other, which are contained in list.
-  set_other -= set_act;
-  list_act.clear();
-  list_act.append(set_act.toList());
-  list_other.clear();
-  list_other.append(set_other.toList());
+    DatabaseQueries::storeMessageStatesToOutbox(database, m_cacheAccountId, ids_of_messages, read);
+  }
 
   m_cacheSaveMutex->unlock();
 }
 
-void CacheForServiceRoot::saveCacheToFile(int acc_id) {
+void CacheForServiceRoot::loadCacheFromDatabase(int acc_id) {
   m_cacheSaveMutex->lock();
+  clearCache();
+  m_cacheAccountId = acc_id;
 
-  // Save to file.
-  const QString file_cache = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.dat";
+  QSqlDatabase database = qApp->database()->connection(QSL("CacheForServiceRoot"), DatabaseFactory::FromSettings);
+
+  DatabaseQueries::getMessageStatesOutbox(database, acc_id, m_cachedStatesRead, m_cachedStatesImportant);
+  m_cacheSaveMutex->unlock();
+
+  loadCacheFromFile(acc_id);
+  qDebug("Loaded %d cached message states of account %d.",
+         m_cachedStatesRead.size() + m_cachedStatesImportant.size(), acc_id);
+}
+
+bool CacheForServiceRoot::hasCachedStatesToSend() const {
+  m_cacheSaveMutex->lock();
+
+  const bool result = !isEmpty() && (!m_cacheNextAttempt.isValid() ||
+                                     m_cacheNextAttempt <= QDateTime::currentDateTimeUtc());
+
+  m_cacheSaveMutex->unlock();
+  return result;
+}
+
+bool CacheForServiceRoot::isSendingCachedData() const {
+  return m_cacheSending.load() != 0;
+}
 
-  if (isEmpty()) {
-    QFile::remove(file_cache);
+void CacheForServiceRoot::setSendingCachedData(bool sending) {
+  m_cacheSending.store(sending ? 1 : 0);
+}
+
+void CacheForServiceRoot::saveAllCachedData(bool ignore_retry_delay) {
+  // Only one batch of states is sent at a time.
+  QMutexLocker send_locker(&m_cacheSendMutex);
+
+  m_cacheSaveMutex->lock();
+
+  if (isEmpty() || (!ignore_retry_delay && m_cacheNextAttempt.isValid() &&
+                    m_cacheNextAttempt > QDateTime::currentDateTimeUtc())) {
+    m_cacheSaveMutex->unlock();
+    return;
   }
-  else {
-    QFile file(file_cache);
 
-    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-      QDataStream stream(&file);
+  // Make copy of changes, states changed while sending are kept.
+  QMap<RootItem::ReadStatus, QStringList> states_read;
+  QMap<RootItem::Importance, QList<Message>> states_important;
+
+  for (auto i = m_cachedStatesRead.constBegin(); i != m_cachedStatesRead.constEnd(); i++) {
+    states_read[i.value()].append(i.key());
+  }
+
+  for (auto i = m_cachedStatesImportant.constBegin(); i != m_cachedStatesImportant.constEnd(); i++) {
+    states_important[i.value().m_isImportant ? RootItem::Important : RootItem::NotImportant].append(i.value());
+  }
 
-      stream << m_cachedStatesImportant << m_cachedStatesRead;
-      file.flush();
-      file.close();
+  m_cacheSaveMutex->unlock();
+
+  const int batch_size = qMax(1, cachedStatesBatchSize());
+  int sent_states = 0;
+  int batches = 0;
+  bool failed = false;
+
+  for (auto i = states_read.constBegin(); i != states_read.constEnd() && !failed; i++) {
+    for (int j = 0; j < i.value().size() && !failed; j += batch_size) {
+      const QStringList batch = i.value().mid(j, batch_size);
+
+      batches++;
+
+      if (sendReadStates(batch, i.key())) {
+        acknowledgeReadStates(batch, i.key());
+        sent_states += batch.size();
+      }
+      else {
+        failed = true;
+      }
     }
+  }
+
+  for (auto i = states_important.constBegin(); i != states_important.constEnd() && !failed; i++) {
+    for (int j = 0; j < i.value().size() && !failed; j += batch_size) {
+      const QList<Message> batch = i.value().mid(j, batch_size);
+
+      batches++;
 
-    clearCache();
+      if (sendImportantStates(batch, i.key())) {
+        acknowledgeImportantStates(batch, i.key());
+        sent_states += batch.size();
+      }
+      else {
+        failed = true;
+      }
+    }
+  }
+
+  m_cacheSaveMutex->lock();
+
+  if (failed) {
+    const int delay = qMin(CACHED_STATES_RETRY_DELAY << qMin(m_cacheFailedAttempts, 10), CACHED_STATES_MAX_RETRY_DELAY);
+
+    m_cacheFailedAttempts++;
+    m_cacheNextAttempt = QDateTime::currentDateTimeUtc().addSecs(delay);
+    qWarning("Sending of cached message states of account %d failed, trying again in %d seconds.",
+             m_cacheAccountId, delay);
+  }
+  else {
+    m_cacheFailedAttempts = 0;
+    m_cacheNextAttempt = QDateTime();
   }
 
   m_cacheSaveMutex->unlock();
+  qDebug("Sent %d cached message states of account %d in %d requests.", sent_states, m_cacheAccountId, batches);
 }
 
-void CacheForServiceRoot::clearCache() {
-  m_cachedStatesRead.clear();
-  m_cachedStatesImportant.clear();
-}
+void CacheForServiceRoot::acknowledgeReadStates(const QStringList& custom_ids, RootItem::ReadStatus read) {
+  QStringList acknowledged_ids;
 
-void CacheForServiceRoot::loadCacheFromFile(int acc_id) {
   m_cacheSaveMutex->lock();
-  clearCache();
 
-  // Load from file.
-  const QString file_cache = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.dat";
-  QFile file(file_cache);
+  foreach (const QString& custom_id, custom_ids) {
+    auto state = m_cachedStatesRead.find(custom_id);
 
-  if (file.exists()) {
-    if (file.open(QIODevice::ReadOnly)) {
-      QDataStream stream(&file);
-
-      stream >> m_cachedStatesImportant >> m_cachedStatesRead;
-      file.flush();
-      file.close();
+    // State changed again while being sent, it is sent again next time.
+    if (state != m_cachedStatesRead.end() && state.value() == read) {
+      m_cachedStatesRead.erase(state);
+      acknowledged_ids.append(custom_id);
     }
+  }
 
-    file.remove();
+  if (m_cacheAccountId > 0) {
+    QSqlDatabase database = qApp->database()->connection(QSL("CacheForServiceRoot"), DatabaseFactory::FromSettings);
+
+    DatabaseQueries::removeMessageStatesFromOutbox(database, m_cacheAccountId, acknowledged_ids, read);
   }
 
   m_cacheSaveMutex->unlock();
 }
 
-QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> CacheForServiceRoot::takeMessageCache() {
+void CacheForServiceRoot::acknowledgeImportantStates(const QList<Message>& messages, RootItem::Importance importance) {
+  QStringList acknowledged_ids;
+
   m_cacheSaveMutex->lock();
 
-  if (isEmpty()) {
-    // No cached changes.
-    m_cacheSaveMutex->unlock();
+  foreach (const Message& message, messages) {
+    auto state = m_cachedStatesImportant.find(message.m_customId);
 
-    return QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>>();
+    // State changed again while being sent, it is sent again next time.
+    if (state != m_cachedStatesImportant.end() && state.value().m_isImportant == (importance == RootItem::Important)) {
+      m_cachedStatesImportant.erase(state);
+      acknowledged_ids.append(message.m_customId);
+    }
   }
 
-  // Make copy of changes.
-  QMap<RootItem::ReadStatus, QStringList> cached_data_read = m_cachedStatesRead;
-  cached_data_read.detach();
+  if (m_cacheAccountId > 0) {
+    QSqlDatabase database = qApp->database()->connection(QSL("CacheForServiceRoot"), DatabaseFactory::FromSettings);
 
-  QMap<RootItem::Importance, QList<Message>> cached_data_imp = m_cachedStatesImportant;
-  cached_data_imp.detach();
+    DatabaseQueries::removeMessageStatesFromOutbox(database, m_cacheAccountId, acknowledged_ids, importance);
+  }
 
-  clearCache();
   m_cacheSaveMutex->unlock();
+}
+
+void CacheForServiceRoot::clearCache() {
+  m_cachedStatesRead.clear();
+  m_cachedStatesImportant.clear();
+  m_cacheFailedAttempts = 0;
+  m_cacheNextAttempt = QDateTime();
+}
+
+void CacheForServiceRoot::loadCacheFromFile(int acc_id) {
+  const QString file_cache = qApp->userDataFolder() + QDir::separator() + QString::number(acc_id) + "-cached-msgs.dat";
+  QFile file(file_cache);
+
+  if (!file.exists()) {
+    return;
+  }
+
+  QMap<RootItem::ReadStatus, QStringList> cached_states_read;
+  QMap<RootItem::Importance, QList<Message>> cached_states_important;
+
+  if (file.open(QIODevice::ReadOnly)) {
+    QDataStream stream(&file);
+
+    stream >> cached_states_important >> cached_states_read;
+    file.close();
+  }
+
+  // Outbox in database is empty right after upgrade, states
+  // from file are just stored there.
+  for (auto i = cached_states_read.constBegin(); i != cached_states_read.constEnd(); i++) {
+    addMessageStatesToCache(i.value(), i.key());
+  }
+
+  for (auto i = cached_states_important.constBegin(); i != cached_states_important.constEnd(); i++) {
+    addMessageStatesToCache(i.value(), i.key());
+  }
 
-  return QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>>(cached_data_read, cached_data_imp);
+  file.remove();
 }
 
 bool CacheForServiceRoot::isEmpty() const {
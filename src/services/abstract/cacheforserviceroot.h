@@ -5,12 +5,17 @@
 
 #include "services/abstract/serviceroot.h"
 
-#include <QMap>
-#include <QPair>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
 #include <QStringList>
 
 class Mutex;
 
+// Outbox of message states changed locally which are to be sent to server.
+// Only last state of each message is kept and all states are journaled
+// in database, so they are not lost when application crashes.
 class CacheForServiceRoot {
   public:
     explicit CacheForServiceRoot();
@@ -19,24 +24,54 @@ class CacheForServiceRoot {
     void addMessageStatesToCache(const QList<Message>& ids_of_messages, RootItem::Importance importance);
     void addMessageStatesToCache(const QStringList& ids_of_messages, RootItem::ReadStatus read);
 
-    // Persistently saves/loads cached changes to/from file.
-    // NOTE: The whole cache is cleared after save is done and before load is done.
-    void saveCacheToFile(int acc_id);
-    void loadCacheFromFile(int acc_id);
+    // Loads states which were not confirmed by server yet.
+    // NOTE: The whole cache is cleared before load is done.
+    void loadCacheFromDatabase(int acc_id);
+
+    // Returns true if there are some states and they can be sent now.
+    bool hasCachedStatesToSend() const;
+
+    // Sends states to server in batches. States are removed from outbox only
+    // after server confirms them, failed states are retried later with
+    // increasing delay unless the delay is ignored.
+    void saveAllCachedData(bool ignore_retry_delay = false);
 
-    virtual void saveAllCachedData(bool async = true) = 0;
+    // Marks account as being used by background sending of states,
+    // such account cannot be edited or removed meanwhile.
+    // NOTE: These are thread-safe.
+    bool isSendingCachedData() const;
+    void setSendingCachedData(bool sending);
 
   protected:
-    QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> takeMessageCache();
 
-    Mutex* m_cacheSaveMutex;
+    // Maximal number of messages which can be sent to server in one request.
+    virtual int cachedStatesBatchSize() const = 0;
 
-    QMap<RootItem::ReadStatus, QStringList> m_cachedStatesRead;
-    QMap<RootItem::Importance, QList<Message>> m_cachedStatesImportant;
+    // Sends one batch of states, returns true if server accepted it.
+    virtual bool sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read) = 0;
+    virtual bool sendImportantStates(const QList<Message>& messages, RootItem::Importance importance) = 0;
 
   private:
     bool isEmpty() const;
     void clearCache();
+
+    // Moves states saved by older versions to database.
+    void loadCacheFromFile(int acc_id);
+
+    void acknowledgeReadStates(const QStringList& custom_ids, RootItem::ReadStatus read);
+    void acknowledgeImportantStates(const QList<Message>& messages, RootItem::Importance importance);
+
+    Mutex* m_cacheSaveMutex;
+    QMutex m_cacheSendMutex;
+    int m_cacheAccountId;
+
+    // States keyed by custom ID of messages, "m_isImportant" of message holds its state.
+    QHash<QString, RootItem::ReadStatus> m_cachedStatesRead;
+    QHash<QString, Message> m_cachedStatesImportant;
+
+    int m_cacheFailedAttempts;
+    QDateTime m_cacheNextAttempt;
+    QAtomicInt m_cacheSending;
 };
 
 #endif // CACHEFORSERVICEROOT_H
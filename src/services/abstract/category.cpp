@@ -66,20 +66,18 @@ void Category::updateCounts(bool including_total_count) {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
   bool ok;
 
-  QMap<QString, QPair<int, int>> counts = DatabaseQueries::getMessageCountsForCategory(database,
-                                                                                       customId(),
-                                                                                       getParentServiceRoot()->accountId(),
-                                                                                       including_total_count,
-                                                                                       &ok);
+  // Counts of all feeds of account are obtained in one go, which is
+  // cheaper than querying feeds of each nested category.
+  const AccountMessageCounts counts = DatabaseQueries::getMessageCountsForAccount(database, getParentServiceRoot()->accountId(), &ok);
 
   if (ok) {
     foreach (Feed* feed, feeds) {
-      if (counts.contains(feed->customId())) {
-        feed->setCountOfUnreadMessages(counts.value(feed->customId()).first);
+      const QPair<int, int> feed_counts = counts.m_feeds.value(feed->customId(), QPair<int, int>(0, 0));
 
-        if (including_total_count) {
-          feed->setCountOfAllMessages(counts.value(feed->customId()).second);
-        }
+      feed->setCountOfUnreadMessages(feed_counts.first);
+
+      if (including_total_count) {
+        feed->setCountOfAllMessages(feed_counts.second);
       }
     }
   }
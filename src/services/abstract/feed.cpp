@@ -2,6 +2,9 @@
 
 #include "services/abstract/feed.h"
 
+#include "core/feedsmodel.h"
+#include "core/messagecontentprocessor.h"
+#include "core/messagecountsservice.h"
 #include "definitions/definitions.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasequeries.h"
@@ -13,6 +16,7 @@
 #include "services/abstract/recyclebin.h"
 #include "services/abstract/serviceroot.h"
 
+#include <QElapsedTimer>
 #include <QThread>
 
 Feed::Feed(RootItem* parent)
@@ -97,8 +101,15 @@ int Feed::countOfUnreadMessages() const {
   return m_unreadCount;
 }
 
+bool Feed::hasNewMessages() const {
+  return status() == NewMessages;
+}
+
 void Feed::setCountOfAllMessages(int count_all_messages) {
-  m_totalCount = count_all_messages;
+  if (m_totalCount != count_all_messages) {
+    m_totalCount = count_all_messages;
+    invalidateCounts();
+  }
 }
 
 void Feed::setCountOfUnreadMessages(int count_unread_messages) {
@@ -106,7 +117,10 @@ void Feed::setCountOfUnreadMessages(int count_unread_messages) {
     setStatus(Normal);
   }
 
-  m_unreadCount = count_unread_messages;
+  if (m_unreadCount != count_unread_messages) {
+    m_unreadCount = count_unread_messages;
+    invalidateCounts();
+  }
 }
 
 void Feed::setAutoUpdateInitialInterval(int auto_update_interval) {
@@ -137,7 +151,10 @@ Feed::Status Feed::status() const {
 }
 
 void Feed::setStatus(const Feed::Status& status) {
-  m_status = status;
+  if (m_status != status) {
+    m_status = status;
+    invalidateCounts();
+  }
 }
 
 QString Feed::url() const {
@@ -153,13 +170,17 @@ void Feed::updateCounts(bool including_total_count) {
   QSqlDatabase database = is_main_thread ?
                           qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
                           qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
-  int account_id = getParentServiceRoot()->accountId();
+  bool ok;
+  const QPair<int, int> counts = DatabaseQueries::getMessageCountsForFeed(database, customId(),
+                                                                          getParentServiceRoot()->accountId(), &ok);
 
-  if (including_total_count) {
-    setCountOfAllMessages(DatabaseQueries::getMessageCountsForFeed(database, customId(), account_id, true));
-  }
+  if (ok) {
+    if (including_total_count) {
+      setCountOfAllMessages(counts.second);
+    }
 
-  setCountOfUnreadMessages(DatabaseQueries::getMessageCountsForFeed(database, customId(), account_id, false));
+    setCountOfUnreadMessages(counts.first);
+  }
 }
 
 void Feed::run() {
@@ -175,21 +196,24 @@ void Feed::run() {
                      << customId() << " URL: " << url() << " title: " << title() << " in thread: \'"
                      << QThread::currentThreadId() << "\'.";
 
+  QElapsedTimer normalization_timer;
+
+  normalization_timer.start();
+
   // Now, do some general operations on messages (tweak encoding etc.).
   for (int i = 0; i < msgs.size(); i++) {
     // Also, make sure that HTML encoding, encoding of special characters, etc., is fixed.
-    msgs[i].m_contents = QUrl::fromPercentEncoding(msgs[i].m_contents.toUtf8());
-    msgs[i].m_author = msgs[i].m_author.toUtf8();
+    msgs[i].m_contents = TextFactory::decodePercentEncoding(msgs[i].m_contents);
 
     // Sanitize title. Remove newlines etc.
-    msgs[i].m_title = QUrl::fromPercentEncoding(msgs[i].m_title.toUtf8())
+    msgs[i].m_title = TextFactory::normalizeTitle(msgs[i].m_title);
+  }
 
-                      // Replace all continuous white space.
-                      .replace(QRegExp(QSL("[\\s]{2,}")), QSL(" "))
+  qDebug("Normalization of %d messages took %lld ms.", msgs.size(), normalization_timer.elapsed());
 
-                      // Remove all newlines and leading white space.
-                      .remove(QRegExp(QSL("([\\n\\r])|(^\\s)")));
-  }
+  // Sanitize contents and extract data needed by message views, so
+  // that this work is done here in worker thread and only once.
+  MessageContentProcessor::processMessages(msgs);
 
   emit messagesObtained(msgs, error_during_obtaining);
 }
@@ -236,12 +260,10 @@ int Feed::updateMessages(const QList<Message>& messages, bool error_during_obtai
 
   if (ok) {
     setStatus(updated_messages > 0 ? NewMessages : Normal);
-    updateCounts(true);
 
-    if (getParentServiceRoot()->recycleBin() != nullptr && anything_updated) {
-      getParentServiceRoot()->recycleBin()->updateCounts(true);
-      items_to_update.append(getParentServiceRoot()->recycleBin());
-    }
+    // Counts of feeds and recycle bin of the account are updated
+    // together for all feeds updated in short succession.
+    qApp->feedReader()->feedsModel()->messageCounts()->requestCountsUpdate(getParentServiceRoot()->accountId());
   }
 
   if (error_during_obtaining) {
@@ -47,6 +47,7 @@ class Feed : public RootItem, public QRunnable {
 
     int countOfAllMessages() const;
     int countOfUnreadMessages() const;
+    bool hasNewMessages() const;
 
     void setCountOfAllMessages(int count_all_messages);
     void setCountOfUnreadMessages(int count_unread_messages);
@@ -7,6 +7,7 @@
 #include "gui/baselineedit.h"
 #include "gui/messagebox.h"
 #include "gui/systemtrayicon.h"
+#include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/textfactory.h"
 #include "network-web/networkfactory.h"
@@ -298,6 +299,31 @@ void FormFeedDetails::setEditableFeed(Feed* editable_feed) {
   m_ui->m_txtUrl->lineEdit()->setText(editable_feed->url());
   m_ui->m_cmbAutoUpdateType->setCurrentIndex(m_ui->m_cmbAutoUpdateType->findData(QVariant::fromValue((int) editable_feed->autoUpdateType())));
   m_ui->m_spinAutoUpdateInterval->setValue(editable_feed->autoUpdateInitialInterval());
+
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  const EnclosurePolicy policy = DatabaseQueries::getEnclosurePolicy(database, editable_feed->customId(), m_serviceRoot->accountId());
+
+  m_ui->m_gbPrefetchEnclosures->setChecked(policy.m_enabled);
+  m_ui->m_txtPrefetchMimeTypes->setText(policy.m_mimeTypes.join(QSL(", ")));
+  m_ui->m_spinPrefetchMaxSize->setValue(policy.m_maxSize);
+  m_ui->m_spinPrefetchKeepLast->setValue(policy.m_keepLast);
+}
+
+void FormFeedDetails::saveEnclosurePolicy(Feed* feed) {
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
+  EnclosurePolicy policy;
+
+  policy.m_enabled = m_ui->m_gbPrefetchEnclosures->isChecked();
+  policy.m_maxSize = m_ui->m_spinPrefetchMaxSize->value();
+  policy.m_keepLast = m_ui->m_spinPrefetchKeepLast->value();
+
+  foreach (const QString& mime_type, m_ui->m_txtPrefetchMimeTypes->text().split(QL1C(','), QString::SkipEmptyParts)) {
+    if (!mime_type.trimmed().isEmpty()) {
+      policy.m_mimeTypes.append(mime_type.trimmed());
+    }
+  }
+
+  DatabaseQueries::storeEnclosurePolicy(database, feed->customId(), m_serviceRoot->accountId(), policy);
 }
 
 void FormFeedDetails::initialize() {
@@ -382,6 +408,10 @@ void FormFeedDetails::initialize() {
   setTabOrder(m_ui->m_btnIcon, m_ui->m_gbAuthentication);
   setTabOrder(m_ui->m_gbAuthentication, m_ui->m_txtUsername->lineEdit());
   setTabOrder(m_ui->m_txtUsername->lineEdit(), m_ui->m_txtPassword->lineEdit());
+  setTabOrder(m_ui->m_txtPassword->lineEdit(), m_ui->m_gbPrefetchEnclosures);
+  setTabOrder(m_ui->m_gbPrefetchEnclosures, m_ui->m_txtPrefetchMimeTypes);
+  setTabOrder(m_ui->m_txtPrefetchMimeTypes, m_ui->m_spinPrefetchMaxSize);
+  setTabOrder(m_ui->m_spinPrefetchMaxSize, m_ui->m_spinPrefetchKeepLast);
   m_ui->m_txtUrl->lineEdit()->setFocus(Qt::TabFocusReason);
 }
 
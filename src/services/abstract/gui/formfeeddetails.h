@@ -61,6 +61,9 @@ class FormFeedDetails : public QDialog {
     // base implementation must be called first.
     void virtual setEditableFeed(Feed* editable_feed);
 
+    // Stores enclosure download policy from the dialog for given feed.
+    void saveEnclosurePolicy(Feed* feed);
+
     // Creates needed connections.
     void createConnections();
 
@@ -35,16 +35,35 @@ int RecycleBin::countOfAllMessages() const {
   return m_totalCount;
 }
 
+void RecycleBin::setCountOfUnreadMessages(int count_unread_messages) {
+  if (m_unreadCount != count_unread_messages) {
+    m_unreadCount = count_unread_messages;
+    invalidateCounts();
+  }
+}
+
+void RecycleBin::setCountOfAllMessages(int count_all_messages) {
+  if (m_totalCount != count_all_messages) {
+    m_totalCount = count_all_messages;
+    invalidateCounts();
+  }
+}
+
 void RecycleBin::updateCounts(bool update_total_count) {
   bool is_main_thread = QThread::currentThread() == qApp->thread();
   QSqlDatabase database = is_main_thread ?
                           qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
                           qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
 
-  m_unreadCount = DatabaseQueries::getMessageCountsForBin(database, getParentServiceRoot()->accountId(), false);
+  bool ok;
+  const QPair<int, int> counts = DatabaseQueries::getMessageCountsForBin(database, getParentServiceRoot()->accountId(), &ok);
+
+  if (ok) {
+    setCountOfUnreadMessages(counts.first);
 
-  if (update_total_count) {
-    m_totalCount = DatabaseQueries::getMessageCountsForBin(database, getParentServiceRoot()->accountId(), true);
+    if (update_total_count) {
+      setCountOfAllMessages(counts.second);
+    }
   }
 }
 
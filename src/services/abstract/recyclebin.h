@@ -22,6 +22,8 @@ class RecycleBin : public RootItem {
 
     int countOfUnreadMessages() const;
     int countOfAllMessages() const;
+    void setCountOfUnreadMessages(int count_unread_messages);
+    void setCountOfAllMessages(int count_all_messages);
 
     void updateCounts(bool update_total_count);
 
@@ -13,7 +13,8 @@
 RootItem::RootItem(RootItem* parent_item)
   : QObject(nullptr), m_kind(RootItemKind::Root), m_id(NO_PARENT_CATEGORY), m_customId(QSL("")),
   m_title(QString()), m_description(QString()), m_icon(QIcon()), m_creationDate(QDateTime()),
-  m_keepOnTop(false), m_childItems(QList<RootItem*>()), m_parentItem(parent_item) {}
+  m_keepOnTop(false), m_childItems(QList<RootItem*>()), m_parentItem(parent_item), m_countsDirty(1),
+  m_cachedUnreadCount(0), m_cachedTotalCount(0), m_cachedHasNewMessages(false), m_row(-1) {}
 
 RootItem::RootItem(const RootItem& other) : RootItem(nullptr) {
   setTitle(other.title());
@@ -104,7 +105,13 @@ void RootItem::updateCounts(bool including_total_count) {
 
 int RootItem::row() const {
   if (m_parentItem) {
-    return m_parentItem->m_childItems.indexOf(const_cast<RootItem*>(this));
+    // List is searched only if the item was assigned to the parent
+    // without being added to its children.
+    if (m_parentItem->m_childItems.value(m_row) != this) {
+      m_row = m_parentItem->m_childItems.indexOf(const_cast<RootItem*>(this));
+    }
+
+    return m_row;
   }
   else {
     // This item has no parent. Therefore, its row index is 0.
@@ -199,13 +206,59 @@ bool RootItem::performDragDropChange(RootItem* target_item) {
 }
 
 int RootItem::countOfAllMessages() const {
+  if (m_countsDirty.load() != 0) {
+    recalculateCounts();
+  }
+
+  return m_cachedTotalCount;
+}
+
+bool RootItem::hasNewMessages() const {
+  if (m_countsDirty.load() != 0) {
+    recalculateCounts();
+  }
+
+  return m_cachedHasNewMessages;
+}
+
+void RootItem::invalidateCounts() {
+  for (RootItem* item = this; item != nullptr; item = item->m_parentItem) {
+    item->m_countsDirty.store(1);
+  }
+}
+
+void RootItem::updateChildRows(int from_index) {
+  for (int i = from_index; i < m_childItems.size(); i++) {
+    m_childItems.at(i)->m_row = i;
+  }
+}
+
+void RootItem::invalidateItemIndexes() {
+  for (RootItem* item = this; item != nullptr; item = item->m_parentItem) {
+    if (item->kind() == RootItemKind::ServiceRoot) {
+      item->toServiceRoot()->invalidateSubTreeIndexes();
+      break;
+    }
+  }
+}
+
+void RootItem::recalculateCounts() const {
+  // Flag is reset before children are summed up, so that counts changed
+  // meanwhile by another thread are picked up next time.
+  m_countsDirty.store(0);
+  int unread_count = 0;
   int total_count = 0;
+  bool has_new_messages = false;
 
-  foreach (RootItem* child_item, m_childItems) {
+  foreach (const RootItem* child_item, m_childItems) {
+    unread_count += child_item->countOfUnreadMessages();
     total_count += child_item->countOfAllMessages();
+    has_new_messages |= child_item->hasNewMessages();
   }
 
-  return total_count;
+  m_cachedUnreadCount = unread_count;
+  m_cachedTotalCount = total_count;
+  m_cachedHasNewMessages = has_new_messages;
 }
 
 bool RootItem::isChildOf(const RootItem* root) const {
@@ -299,7 +352,19 @@ QHash<int, Category*> RootItem::getHashedSubTreeCategories() const {
   while (!traversable_items.isEmpty()) {
     RootItem* active_item = traversable_items.takeFirst();
 
-    if (active_item->kind() == RootItemKind::Category && !children.contains(active_item->id())) {
+    if (active_item->kind() == RootItemKind::ServiceRoot) {
+      // Service roots keep their items indexed.
+      const QHash<int, Category*> categories = active_item->toServiceRoot()->categoriesById();
+
+      for (auto i = categories.constBegin(); i != categories.constEnd(); i++) {
+        if (!children.contains(i.key())) {
+          children.insert(i.key(), i.value());
+        }
+      }
+
+      continue;
+    }
+    else if (active_item->kind() == RootItemKind::Category && !children.contains(active_item->id())) {
       children.insert(active_item->id(), active_item->toCategory());
     }
 
@@ -318,7 +383,19 @@ QHash<QString, Feed*> RootItem::getHashedSubTreeFeeds() const {
   while (!traversable_items.isEmpty()) {
     RootItem* active_item = traversable_items.takeFirst();
 
-    if (active_item->kind() == RootItemKind::Feed && !children.contains(active_item->customId())) {
+    if (active_item->kind() == RootItemKind::ServiceRoot) {
+      // Service roots keep their items indexed.
+      const QHash<QString, Feed*> feeds = active_item->toServiceRoot()->feedsByCustomId();
+
+      for (auto i = feeds.constBegin(); i != feeds.constEnd(); i++) {
+        if (!children.contains(i.key())) {
+          children.insert(i.key(), i.value());
+        }
+      }
+
+      continue;
+    }
+    else if (active_item->kind() == RootItemKind::Feed && !children.contains(active_item->customId())) {
       children.insert(active_item->customId(), active_item->toFeed());
     }
 
@@ -337,7 +414,12 @@ QList<Feed*> RootItem::getSubTreeFeeds() const {
   while (!traversable_items.isEmpty()) {
     RootItem* active_item = traversable_items.takeFirst();
 
-    if (active_item->kind() == RootItemKind::Feed) {
+    if (active_item->kind() == RootItemKind::ServiceRoot) {
+      // Service roots keep their items indexed.
+      children.append(active_item->toServiceRoot()->feeds());
+      continue;
+    }
+    else if (active_item->kind() == RootItemKind::Feed) {
       children.append(active_item->toFeed());
     }
 
@@ -383,7 +465,10 @@ int RootItem::id() const {
 }
 
 void RootItem::setId(int id) {
-  m_id = id;
+  if (m_id != id) {
+    m_id = id;
+    invalidateItemIndexes();
+  }
 }
 
 QString RootItem::title() const {
@@ -411,7 +496,12 @@ void RootItem::setDescription(const QString& description) {
 }
 
 bool RootItem::removeChild(RootItem* child) {
-  return m_childItems.removeOne(child);
+  if (child != nullptr && child->m_parentItem == this) {
+    return removeChild(child->row());
+  }
+  else {
+    return removeChild(m_childItems.indexOf(child));
+  }
 }
 
 QString RootItem::customId() const {
@@ -423,7 +513,10 @@ int RootItem::customNumericId() const {
 }
 
 void RootItem::setCustomId(const QString& custom_id) {
-  m_customId = custom_id;
+  if (m_customId != custom_id) {
+    m_customId = custom_id;
+    invalidateItemIndexes();
+  }
 }
 
 Category* RootItem::toCategory() const {
@@ -447,18 +540,19 @@ void RootItem::setKeepOnTop(bool keep_on_top) {
 }
 
 int RootItem::countOfUnreadMessages() const {
-  int total_count = 0;
-
-  foreach (RootItem* child_item, m_childItems) {
-    total_count += child_item->countOfUnreadMessages();
+  if (m_countsDirty.load() != 0) {
+    recalculateCounts();
   }
 
-  return total_count;
+  return m_cachedUnreadCount;
 }
 
 bool RootItem::removeChild(int index) {
   if (index >= 0 && index < m_childItems.size()) {
     m_childItems.removeAt(index);
+    updateChildRows(index);
+    invalidateCounts();
+    invalidateItemIndexes();
     return true;
   }
   else {
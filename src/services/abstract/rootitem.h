@@ -5,6 +5,7 @@
 
 #include "core/message.h"
 
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QFont>
 #include <QIcon>
@@ -102,8 +103,19 @@ class RootItem : public QObject {
 
     // Each item offers "counts" of messages.
     // Returns counts of messages of all child items summed up.
+    // NOTE: Sums are cached and recalculated only after
+    // some child or its counts changed.
     virtual int countOfUnreadMessages() const;
     virtual int countOfAllMessages() const;
+
+    // Returns true if any feed in the subtree obtained new messages
+    // during its last update. Result is cached as the counts are.
+    virtual bool hasNewMessages() const;
+
+    // Marks cached counts of this item and all its parents as outdated.
+    // NOTE: Call this whenever counts of leaf item change.
+    void invalidateCounts();
+
     inline RootItem* parent() const {
       return m_parentItem;
     }
@@ -124,6 +136,9 @@ class RootItem : public QObject {
       if (child != nullptr) {
         m_childItems.append(child);
         child->setParent(this);
+        child->m_row = m_childItems.size() - 1;
+        invalidateCounts();
+        invalidateItemIndexes();
       }
     }
 
@@ -136,10 +151,15 @@ class RootItem : public QObject {
     // NOTE: Children are NOT freed from the memory.
     inline void clearChildren() {
       m_childItems.clear();
+      invalidateCounts();
+      invalidateItemIndexes();
     }
 
     inline void setChildItems(const QList<RootItem*>& child_items) {
       m_childItems = child_items;
+      updateChildRows(0);
+      invalidateCounts();
+      invalidateItemIndexes();
     }
 
     // Removes particular child at given index.
@@ -207,6 +227,15 @@ class RootItem : public QObject {
     void setKeepOnTop(bool keep_on_top);
 
   private:
+    void recalculateCounts() const;
+
+    // Stores positions of children starting with given index.
+    void updateChildRows(int from_index);
+
+    // Tells service root of this item that items
+    // in its subtree were added, removed or changed their IDs.
+    void invalidateItemIndexes();
+
     RootItemKind::Kind m_kind;
     int m_id;
     QString m_customId;
@@ -218,6 +247,16 @@ class RootItem : public QObject {
 
     QList<RootItem*> m_childItems;
     RootItem* m_parentItem;
+
+    // Cached sums of counts of children.
+    mutable QAtomicInt m_countsDirty;
+    mutable int m_cachedUnreadCount;
+    mutable int m_cachedTotalCount;
+    mutable bool m_cachedHasNewMessages;
+
+    // Position of this item in its parent, it is updated
+    // whenever children of the parent are added or removed.
+    mutable int m_row;
 };
 
 QDataStream& operator<<(QDataStream& out, const RootItem::Importance& myObj);
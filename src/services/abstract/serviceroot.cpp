@@ -13,7 +13,11 @@
 #include "services/abstract/feed.h"
 #include "services/abstract/recyclebin.h"
 
-ServiceRoot::ServiceRoot(RootItem* parent) : RootItem(parent), m_recycleBin(new RecycleBin(this)), m_accountId(NO_PARENT_CATEGORY) {
+#include <QSet>
+#include <QThread>
+
+ServiceRoot::ServiceRoot(RootItem* parent) : RootItem(parent), m_recycleBin(new RecycleBin(this)), m_accountId(NO_PARENT_CATEGORY),
+  m_subTreeIndexesDirty(true) {
   setKind(RootItemKind::ServiceRoot);
   setCreationDate(QDateTime::currentDateTime());
 }
@@ -81,44 +85,56 @@ void ServiceRoot::start(bool freshly_activated) {
 void ServiceRoot::stop() {}
 
 void ServiceRoot::updateCounts(bool including_total_count) {
-  QList<Feed*> feeds;
-
-  foreach (RootItem* child, getSubTree()) {
-    if (child->kind() == RootItemKind::Feed) {
-      feeds.append(child->toFeed());
-    }
-    else if (child->kind() != RootItemKind::Category && child->kind() != RootItemKind::ServiceRoot) {
-      child->updateCounts(including_total_count);
-    }
-  }
+  bool is_main_thread = QThread::currentThread() == qApp->thread();
+  QSqlDatabase database = is_main_thread ?
+                          qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings) :
+                          qApp->database()->connection(QSL("feed_upd"), DatabaseFactory::FromSettings);
+  bool ok;
+  const AccountMessageCounts counts = DatabaseQueries::getMessageCountsForAccount(database, accountId(), &ok);
 
-  if (feeds.isEmpty()) {
-    return;
+  if (ok) {
+    applyMessageCounts(counts, including_total_count);
   }
+}
 
-  QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
-  bool ok;
+QList<RootItem*> ServiceRoot::applyMessageCounts(const AccountMessageCounts& counts, bool including_total_count) {
+  QList<RootItem*> changed_items;
+  RecycleBin* bin = recycleBin();
 
-  QMap<QString, QPair<int, int>> counts = DatabaseQueries::getMessageCountsForAccount(database, accountId(), including_total_count, &ok);
+  foreach (RootItem* child, getSubTree()) {
+    if (child->kind() == RootItemKind::Feed) {
+      Feed* feed = child->toFeed();
+      const QPair<int, int> feed_counts = counts.m_feeds.value(feed->customId(), QPair<int, int>(0, 0));
 
-  if (ok) {
-    foreach (Feed* feed, feeds) {
-      if (counts.contains(feed->customId())) {
-        feed->setCountOfUnreadMessages(counts.value(feed->customId()).first);
+      if (feed->countOfUnreadMessages() != feed_counts.first ||
+          (including_total_count && feed->countOfAllMessages() != feed_counts.second)) {
+        feed->setCountOfUnreadMessages(feed_counts.first);
 
         if (including_total_count) {
-          feed->setCountOfAllMessages(counts.value(feed->customId()).second);
+          feed->setCountOfAllMessages(feed_counts.second);
         }
+
+        changed_items.append(feed);
       }
-      else {
-        feed->setCountOfUnreadMessages(0);
+    }
+    else if (child == bin) {
+      if (bin->countOfUnreadMessages() != counts.m_recycleBin.first ||
+          (including_total_count && bin->countOfAllMessages() != counts.m_recycleBin.second)) {
+        bin->setCountOfUnreadMessages(counts.m_recycleBin.first);
 
         if (including_total_count) {
-          feed->setCountOfAllMessages(0);
+          bin->setCountOfAllMessages(counts.m_recycleBin.second);
         }
+
+        changed_items.append(bin);
       }
     }
+    else if (child->kind() != RootItemKind::Category && child->kind() != RootItemKind::ServiceRoot) {
+      child->updateCounts(including_total_count);
+    }
   }
+
+  return changed_items;
 }
 
 void ServiceRoot::completelyRemoveAllData() {
@@ -152,17 +168,16 @@ bool ServiceRoot::cleanFeeds(QList<Feed*> items, bool clean_read_only) {
     QList<RootItem*> itemss;
 
     foreach (Feed* feed, items) {
-      feed->updateCounts(true);
       itemss.append(feed);
     }
 
     RecycleBin* bin = recycleBin();
 
     if (bin != nullptr) {
-      bin->updateCounts(true);
       itemss.append(bin);
     }
 
+    updateCounts(true);
     itemChanged(itemss);
     requestReloadMessageList(true);
     return true;
@@ -172,17 +187,144 @@ bool ServiceRoot::cleanFeeds(QList<Feed*> items, bool clean_read_only) {
   }
 }
 
-void ServiceRoot::storeNewFeedTree(RootItem* root) {
+AccountTreeChanges ServiceRoot::compareWithNewFeedTree(RootItem* new_tree) const {
+  AccountTreeChanges changes;
+  QHash<QString, RootItem*> categories, feeds;
+  QSet<RootItem*> matched_items;
+
+  // Items of new tree are mapped to items which represent them in this account.
+  QHash<RootItem*, RootItem*> mapped_items;
+  const QList<RootItem*> items = getSubTree();
+
+  foreach (RootItem* item, items) {
+    if (item->kind() == RootItemKind::Category) {
+      categories.insert(item->customId(), item);
+    }
+    else if (item->kind() == RootItemKind::Feed) {
+      feeds.insert(item->customId(), item);
+    }
+  }
+
+  mapped_items.insert(new_tree, const_cast<ServiceRoot*>(this));
+
+  foreach (RootItem* new_item, new_tree->getSubTree()) {
+    RootItem* parent = mapped_items.value(new_item->parent());
+
+    if (parent == nullptr ||
+        (new_item->kind() != RootItemKind::Category && new_item->kind() != RootItemKind::Feed)) {
+      continue;
+    }
+
+    RootItem* item = (new_item->kind() == RootItemKind::Category ? categories : feeds).value(new_item->customId());
+
+    if (item == nullptr || matched_items.contains(item)) {
+      changes.m_insertedItems.append(new_item);
+      changes.m_parents.insert(new_item, parent);
+      mapped_items.insert(new_item, new_item);
+    }
+    else {
+      matched_items.insert(item);
+      mapped_items.insert(new_item, item);
+
+      if (item->parent() != parent || itemDataDiffers(item, new_item)) {
+        changes.m_updatedItems.append(QPair<RootItem*, RootItem*>(item, new_item));
+        changes.m_parents.insert(item, parent);
+      }
+    }
+  }
+
+  for (int i = items.size() - 1; i >= 0; i--) {
+    RootItem* item = items.at(i);
+
+    if ((item->kind() == RootItemKind::Category || item->kind() == RootItemKind::Feed) && !matched_items.contains(item)) {
+      changes.m_removedItems.append(item);
+    }
+  }
+
+  return changes;
+}
+
+bool ServiceRoot::storeFeedTreeChanges(const AccountTreeChanges& changes) {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DatabaseFactory::FromSettings);
 
-  if (DatabaseQueries::storeAccountTree(database, root, accountId())) {
-    RecycleBin* bin = recycleBin();
+  if (!DatabaseQueries::storeAccountTreeChanges(database, changes, accountId())) {
+    return false;
+  }
 
-    if (bin != nullptr && !childItems().contains(bin)) {
-      // As the last item, add recycle bin, which is needed.
-      appendChild(bin);
-      bin->updateCounts(true);
+  RecycleBin* bin = recycleBin();
+
+  if (bin != nullptr && !childItems().contains(bin)) {
+    // As the last item, add recycle bin, which is needed.
+    appendChild(bin);
+    bin->updateCounts(true);
+  }
+
+  return true;
+}
+
+QList<RootItem*> ServiceRoot::applyFeedTreeChanges(const AccountTreeChanges& changes) {
+  QSet<RootItem*> changed_items;
+
+  // Children of inserted items are inserted one by one or
+  // replaced by existing items.
+  foreach (RootItem* item, changes.m_insertedItems) {
+    item->clearChildren();
+  }
+
+  foreach (RootItem* item, changes.m_insertedItems) {
+    RootItem* parent = changes.m_parents.value(item);
+
+    item->setParent(nullptr);
+    requestItemReassignment(item, parent);
+    changed_items << item << parent;
+  }
+
+  for (const QPair<RootItem*, RootItem*>& update : changes.m_updatedItems) {
+    RootItem* item = update.first;
+    RootItem* parent = changes.m_parents.value(item);
+
+    item->setTitle(update.second->title());
+    item->setDescription(update.second->description());
+    item->setIcon(update.second->icon());
+    item->setKeepOnTop(update.second->keepOnTop());
+
+    if (item->kind() == RootItemKind::Feed) {
+      item->toFeed()->setUrl(update.second->toFeed()->url());
     }
+
+    if (item->parent() != parent) {
+      changed_items << item->parent() << parent;
+      requestItemReassignment(item, parent);
+    }
+
+    changed_items << item;
+  }
+
+  foreach (RootItem* item, changes.m_removedItems) {
+    changed_items.remove(item);
+    changed_items << item->parent();
+    requestItemRemoval(item);
+  }
+
+  changed_items.remove(nullptr);
+  changed_items << this;
+  return changed_items.toList();
+}
+
+bool ServiceRoot::itemDataDiffers(const RootItem* item, const RootItem* new_item) const {
+  if (item->title() != new_item->title() || item->description() != new_item->description() ||
+      item->keepOnTop() != new_item->keepOnTop()) {
+    return true;
+  }
+  else if (item->kind() == RootItemKind::Feed && item->toFeed()->url() != new_item->toFeed()->url()) {
+    return true;
+  }
+  else if (item->icon().isNull() != new_item->icon().isNull()) {
+    return true;
+  }
+  else {
+    return !new_item->icon().isNull() &&
+           qApp->icons()->toByteArray(item->icon()) != qApp->icons()->toByteArray(new_item->icon());
   }
 }
 
@@ -236,37 +378,6 @@ void ServiceRoot::addNewFeed(const QString& url) {
 
 void ServiceRoot::addNewCategory() {}
 
-QMap<QString, QVariant> ServiceRoot::storeCustomFeedsData() {
-  QMap<QString, QVariant> custom_data;
-
-  foreach (const Feed* feed, getSubTreeFeeds()) {
-    QVariantMap feed_custom_data;
-
-    feed_custom_data.insert(QSL("auto_update_interval"), feed->autoUpdateInitialInterval());
-    feed_custom_data.insert(QSL("auto_update_type"), feed->autoUpdateType());
-    custom_data.insert(feed->customId(), feed_custom_data);
-  }
-
-  return custom_data;
-}
-
-void ServiceRoot::restoreCustomFeedsData(const QMap<QString, QVariant>& data, const QHash<QString, Feed*>& feeds) {
-  QMapIterator<QString, QVariant> i(data);
-
-  while (i.hasNext()) {
-    i.next();
-    const QString custom_id = i.key();
-
-    if (feeds.contains(custom_id)) {
-      Feed* feed = feeds.value(custom_id);
-      QVariantMap feed_custom_data = i.value().toMap();
-
-      feed->setAutoUpdateInitialInterval(feed_custom_data.value(QSL("auto_update_interval")).toInt());
-      feed->setAutoUpdateType(static_cast<Feed::AutoUpdateType>(feed_custom_data.value(QSL("auto_update_type")).toInt()));
-    }
-  }
-}
-
 void ServiceRoot::setRecycleBin(RecycleBin* recycle_bin) {
   m_recycleBin = recycle_bin;
 }
@@ -279,47 +390,64 @@ void ServiceRoot::syncIn() {
   RootItem* new_tree = obtainNewTreeForSyncIn();
 
   if (new_tree != nullptr) {
-    // Purge old data from SQL and clean all model items.
-    requestItemExpandStateSave(this);
-    QMap<QString, QVariant> feed_custom_data = storeCustomFeedsData();
-    removeOldFeedTree(false);
-    cleanAllItems();
-    restoreCustomFeedsData(feed_custom_data, new_tree->getHashedSubTreeFeeds());
+    // Only differences between trees are stored, so that existing items
+    // keep their IDs, custom data and states in views.
+    const bool first_sync = feeds().isEmpty() && categoriesById().isEmpty();
+    const QList<RootItem*> new_items = new_tree->getSubTree();
+    const AccountTreeChanges changes = compareWithNewFeedTree(new_tree);
 
-    // Model is clean, now store new tree into DB and
-    // set primary IDs of the items.
-    storeNewFeedTree(new_tree);
+    qDebug("Sync-in of account %d: %d items inserted, %d updated, %d removed.", accountId(),
+           changes.m_insertedItems.size(), changes.m_updatedItems.size(), changes.m_removedItems.size());
 
-    // We have new feed, some feeds were maybe removed,
-    // so remove left over messages.
-    removeLeftOverMessages();
+    bool applied = false;
 
-    foreach (RootItem* top_level_item, new_tree->childItems()) {
-      top_level_item->setParent(nullptr);
-      requestItemReassignment(top_level_item, this);
+    if (changes.isEmpty()) {
+      // Nothing changed.
     }
+    else if (storeFeedTreeChanges(changes)) {
+      applied = true;
+      QList<RootItem*> changed_items = applyFeedTreeChanges(changes);
 
-    updateCounts(true);
-    new_tree->clearChildren();
-    new_tree->deleteLater();
-    QList<RootItem*> all_items = getSubTree();
-    itemChanged(all_items);
-    requestReloadMessageList(true);
+      // Some feeds were maybe removed, so remove left over messages.
+      if (!changes.m_removedItems.isEmpty()) {
+        removeLeftOverMessages();
+      }
 
-    // Now we must refresh expand states.
-    QList<RootItem*> items_to_expand;
+      updateCounts(true);
+      itemChanged(changed_items);
 
-    foreach (RootItem* item, all_items) {
-      if (qApp->settings()->value(GROUP(CategoriesExpandStates), item->hashCode(), item->childCount() > 0).toBool()) {
-        items_to_expand.append(item);
+      if (!changes.m_removedItems.isEmpty()) {
+        requestReloadMessageList(true);
+      }
+
+      // Now we must refresh expand states of new items.
+      QList<RootItem*> items_to_expand;
+
+      foreach (RootItem* item, changes.m_insertedItems) {
+        if (qApp->settings()->value(GROUP(CategoriesExpandStates), item->hashCode(), item->childCount() > 0).toBool()) {
+          items_to_expand.append(item);
+        }
+      }
+
+      if (first_sync) {
+        items_to_expand.prepend(this);
       }
-    }
 
-    if (!items_to_expand.contains(this)) {
-      items_to_expand.prepend(this);
+      requestItemExpand(items_to_expand, true);
+    }
+    else {
+      qCritical("Changes of feed tree of account %d cannot be stored.", accountId());
     }
 
-    requestItemExpand(items_to_expand, true);
+    // Items of new tree which were not inserted are not needed.
+    const QSet<RootItem*> inserted_items = applied ? changes.m_insertedItems.toSet() : QSet<RootItem*>();
+
+    foreach (RootItem* item, new_items) {
+      if (!inserted_items.contains(item)) {
+        item->clearChildren();
+        item->deleteLater();
+      }
+    }
   }
 
   setIcon(original_icon);
@@ -384,10 +512,16 @@ bool ServiceRoot::markFeedsReadUnread(QList<Feed*> items, RootItem::ReadStatus r
     QList<RootItem*> itemss;
 
     foreach (Feed* feed, items) {
-      feed->updateCounts(false);
       itemss.append(feed);
     }
 
+    if (items.size() == 1) {
+      items.first()->updateCounts(false);
+    }
+    else {
+      updateCounts(false);
+    }
+
     itemChanged(itemss);
     requestReloadMessageList(read == RootItem::Read);
     return true;
@@ -449,6 +583,61 @@ void ServiceRoot::setAccountId(int account_id) {
   m_accountId = account_id;
 }
 
+QList<Feed*> ServiceRoot::feeds() const {
+  rebuildSubTreeIndexes();
+  return m_feeds;
+}
+
+QHash<QString, Feed*> ServiceRoot::feedsByCustomId() const {
+  rebuildSubTreeIndexes();
+  return m_feedsByCustomId;
+}
+
+QHash<int, Category*> ServiceRoot::categoriesById() const {
+  rebuildSubTreeIndexes();
+  return m_categoriesById;
+}
+
+void ServiceRoot::invalidateSubTreeIndexes() {
+  m_subTreeIndexesDirty = true;
+}
+
+void ServiceRoot::rebuildSubTreeIndexes() const {
+  // Indexes are rebuilt lazily without locking.
+  Q_ASSERT(QThread::currentThread() == qApp->thread());
+
+  if (!m_subTreeIndexesDirty) {
+    return;
+  }
+
+  QList<RootItem*> traversable_items = childItems();
+
+  m_feeds.clear();
+  m_feedsByCustomId.clear();
+  m_categoriesById.clear();
+
+  // When IDs are not unique, first item in breadth-first
+  // order is indexed.
+  while (!traversable_items.isEmpty()) {
+    RootItem* active_item = traversable_items.takeFirst();
+
+    if (active_item->kind() == RootItemKind::Feed) {
+      m_feeds.append(active_item->toFeed());
+
+      if (!m_feedsByCustomId.contains(active_item->customId())) {
+        m_feedsByCustomId.insert(active_item->customId(), active_item->toFeed());
+      }
+    }
+    else if (active_item->kind() == RootItemKind::Category && !m_categoriesById.contains(active_item->id())) {
+      m_categoriesById.insert(active_item->id(), active_item->toCategory());
+    }
+
+    traversable_items.append(active_item->childItems());
+  }
+
+  m_subTreeIndexesDirty = false;
+}
+
 bool ServiceRoot::loadMessagesForItem(RootItem* item, MessagesModel* model) {
   if (item->kind() == RootItemKind::Bin) {
     model->setFilter(QString("Messages.is_deleted = 1 AND Messages.is_pdeleted = 0 AND Messages.account_id = %1")
@@ -460,7 +649,7 @@ bool ServiceRoot::loadMessagesForItem(RootItem* item, MessagesModel* model) {
     QString urls = textualFeedUrls(children).join(QSL(", "));
 
     model->setFilter(
-      QString("Feeds.custom_id IN (%1) AND Messages.is_deleted = 0 AND Messages.is_pdeleted = 0 AND Messages.account_id = %2").arg(
+      QString("Messages.feed IN (%1) AND Messages.is_deleted = 0 AND Messages.is_pdeleted = 0 AND Messages.account_id = %2").arg(
         filter_clause,
         QString::
         number(accountId())));
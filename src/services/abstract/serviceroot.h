@@ -7,8 +7,11 @@
 
 #include "core/message.h"
 
+#include <QHash>
 #include <QPair>
 
+class Category;
+class Feed;
 class FeedsModel;
 class RecycleBin;
 class QAction;
@@ -19,6 +22,34 @@ typedef QList<QPair<int, RootItem*>> Assignment;
 typedef QPair<int, RootItem*> AssignmentItem;
 typedef QPair<Message, RootItem::Importance> ImportanceChange;
 
+// Differences between feed tree of the account and new tree
+// obtained from server during sync-in, items are matched via their custom IDs.
+struct AccountTreeChanges {
+  // Items of new tree which are not in the account yet, parents go first.
+  QList<RootItem*> m_insertedItems;
+
+  // Existing items whose data or parent changed paired with their
+  // counterparts from new tree, parents go first.
+  QList<QPair<RootItem*, RootItem*>> m_updatedItems;
+
+  // Existing items which are not on server anymore, children go first.
+  QList<RootItem*> m_removedItems;
+
+  // Target parents of inserted and updated items.
+  QHash<RootItem*, RootItem*> m_parents;
+
+  bool isEmpty() const {
+    return m_insertedItems.isEmpty() && m_updatedItems.isEmpty() && m_removedItems.isEmpty();
+  }
+};
+
+// Counts of messages of the account, pairs hold counts of unread and all messages.
+struct AccountMessageCounts {
+  // Counts of undeleted messages keyed by custom IDs of feeds.
+  QHash<QString, QPair<int, int>> m_feeds;
+  QPair<int, int> m_recycleBin;
+};
+
 // THIS IS the root node of the service.
 // NOTE: The root usually contains some core functionality of the
 // service like service account username/password etc.
@@ -30,6 +61,11 @@ class ServiceRoot : public RootItem {
     virtual ~ServiceRoot();
 
     void updateCounts(bool including_total_count);
+
+    // Distributes counts to feeds and recycle bin of this account, all is done
+    // in one pass. Returns items whose counts changed.
+    QList<RootItem*> applyMessageCounts(const AccountMessageCounts& counts, bool including_total_count);
+
     bool deleteViaGui();
     bool markAsReadUnread(ReadStatus status);
 
@@ -73,6 +109,14 @@ class ServiceRoot : public RootItem {
     int accountId() const;
     void setAccountId(int account_id);
 
+    // Indexes of items of this account. They are rebuilt on first
+    // access after some item was added, removed or changed its ID.
+    // NOTE: Use these only from main thread.
+    QList<Feed*> feeds() const;
+    QHash<QString, Feed*> feedsByCustomId() const;
+    QHash<int, Category*> categoriesById() const;
+    void invalidateSubTreeIndexes();
+
     // Returns the UNIQUE code of the given service.
     // NOTE: Keep in sync with ServiceEntryRoot::code().
     virtual QString code() const = 0;
@@ -163,9 +207,16 @@ class ServiceRoot : public RootItem {
     // Removes all messages/categories/feeds which are
     // associated with this account.
     void removeOldFeedTree(bool including_messages);
-    void storeNewFeedTree(RootItem* root);
     void cleanAllItems();
 
+    // Finds out which items must be inserted, updated or removed
+    // to turn feed tree of this account into the new tree.
+    AccountTreeChanges compareWithNewFeedTree(RootItem* new_tree) const;
+
+    // Stores changes into DB and performs them with model items.
+    bool storeFeedTreeChanges(const AccountTreeChanges& changes);
+    QList<RootItem*> applyFeedTreeChanges(const AccountTreeChanges& changes);
+
     // Removes messages which do not belong to any
     // existing feed.
     //
@@ -192,12 +243,17 @@ class ServiceRoot : public RootItem {
     void itemRemovalRequested(RootItem* item);
 
   private:
-    virtual QMap<QString, QVariant> storeCustomFeedsData();
-    virtual void restoreCustomFeedsData(const QMap<QString, QVariant>& data, const QHash<QString, Feed*>& feeds);
+    bool itemDataDiffers(const RootItem* item, const RootItem* new_item) const;
+    void rebuildSubTreeIndexes() const;
 
   private:
     RecycleBin* m_recycleBin;
     int m_accountId;
+
+    mutable bool m_subTreeIndexesDirty;
+    mutable QList<Feed*> m_feeds;
+    mutable QHash<QString, Feed*> m_feedsByCustomId;
+    mutable QHash<int, Category*> m_categoriesById;
 };
 
 #endif // SERVICEROOT_H
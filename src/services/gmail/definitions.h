@@ -19,6 +19,9 @@
 #define GMAIL_MAX_BATCH_SIZE      999
 #define GMAIL_MIN_BATCH_SIZE      20
 
+// Maximal number of messages changed by one "batchModify" request.
+#define GMAIL_MAX_MODIFY_BATCH_SIZE   1000
+
 #define GMAIL_SYSTEM_LABEL_UNREAD   "UNREAD"
 #define GMAIL_SYSTEM_LABEL_INBOX    "INBOX"
 #define GMAIL_SYSTEM_LABEL_SENT     "SENT"
@@ -162,7 +162,7 @@ void GmailServiceRoot::start(bool freshly_activated) {
   Q_UNUSED(freshly_activated)
 
   loadFromDatabase();
-  loadCacheFromFile(accountId());
+  loadCacheFromDatabase(accountId());
 
   if (childCount() <= 1) {
     syncIn();
@@ -171,9 +171,7 @@ void GmailServiceRoot::start(bool freshly_activated) {
   m_network->oauth()->login();
 }
 
-void GmailServiceRoot::stop() {
-  saveCacheToFile(accountId());
-}
+void GmailServiceRoot::stop() {}
 
 QString GmailServiceRoot::code() const {
   return GmailEntryPoint().code();
@@ -186,40 +184,22 @@ QString GmailServiceRoot::additionalTooltip() const {
                                                network()->oauth()->tokensExpireIn().toString() : QSL("-"));
 }
 
-void GmailServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
-
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
-
-    if (!ids.isEmpty()) {
-      network()->markMessagesRead(key, ids, async);
-    }
-  }
-
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
-
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
-
-    QList<Message> messages = j.value();
+int GmailServiceRoot::cachedStatesBatchSize() const {
+  return GMAIL_MAX_MODIFY_BATCH_SIZE;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList custom_ids;
+bool GmailServiceRoot::sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read) {
+  return network()->markMessagesRead(read, custom_ids) == QNetworkReply::NoError;
+}
 
-      foreach (const Message& msg, messages) {
-        custom_ids.append(msg.m_customId);
-      }
+bool GmailServiceRoot::sendImportantStates(const QList<Message>& messages, RootItem::Importance importance) {
+  QStringList custom_ids;
 
-      network()->markMessagesStarred(key, custom_ids, async);
-    }
+  foreach (const Message& msg, messages) {
+    custom_ids.append(msg.m_customId);
   }
+
+  return network()->markMessagesStarred(importance, custom_ids) == QNetworkReply::NoError;
 }
 
 bool GmailServiceRoot::canBeDeleted() const {
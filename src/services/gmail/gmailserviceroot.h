@@ -35,14 +35,16 @@ class GmailServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     QString additionalTooltip() const;
 
-    void saveAllCachedData(bool async = true);
-
   public slots:
     void updateTitle();
 
   protected:
     RootItem* obtainNewTreeForSyncIn() const;
 
+    int cachedStatesBatchSize() const;
+    bool sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read);
+    bool sendImportantStates(const QList<Message>& messages, RootItem::Importance importance);
+
   private:
     void writeNewEmail();
     void loadFromDatabase();
@@ -157,11 +157,11 @@ QList<Message> GmailNetworkFactory::messages(const QString& stream_id, Feed::Sta
   return messages;
 }
 
-void GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids) {
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -170,7 +170,7 @@ void GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QS
   headers.append(QPair<QByteArray, QByteArray>(QString(HTTP_HEADERS_CONTENT_TYPE).toLocal8Bit(),
                                                QString(GMAIL_CONTENT_TYPE_JSON).toLocal8Bit()));
 
-  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QJsonObject param_obj;
   QJsonArray param_add, param_remove;
 
@@ -189,31 +189,22 @@ void GmailNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QS
 
   QJsonDocument param_doc(param_obj);
 
-  // We send this batch.
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
+  // We send this batch and wait for server to confirm it.
+  QByteArray output;
+
+  return NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
                                                  timeout,
                                                  param_doc.toJson(QJsonDocument::JsonFormat::Compact),
+                                                 output,
                                                  QNetworkAccessManager::Operation::PostOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
-
-    NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
-                                            timeout,
-                                            param_doc.toJson(QJsonDocument::JsonFormat::Compact),
-                                            output,
-                                            QNetworkAccessManager::Operation::PostOperation,
-                                            headers);
-  }
+                                                 headers).first;
 }
 
-void GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids) {
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -222,7 +213,7 @@ void GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, c
   headers.append(QPair<QByteArray, QByteArray>(QString(HTTP_HEADERS_CONTENT_TYPE).toLocal8Bit(),
                                                QString(GMAIL_CONTENT_TYPE_JSON).toLocal8Bit()));
 
-  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QJsonObject param_obj;
   QJsonArray param_add, param_remove;
 
@@ -241,24 +232,15 @@ void GmailNetworkFactory::markMessagesStarred(RootItem::Importance importance, c
 
   QJsonDocument param_doc(param_obj);
 
-  // We send this batch.
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
+  // We send this batch and wait for server to confirm it.
+  QByteArray output;
+
+  return NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
                                                  timeout,
                                                  param_doc.toJson(QJsonDocument::JsonFormat::Compact),
+                                                 output,
                                                  QNetworkAccessManager::Operation::PostOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
-
-    NetworkFactory::performNetworkOperation(GMAIL_API_BATCH_UPD_LABELS,
-                                            timeout,
-                                            param_doc.toJson(QJsonDocument::JsonFormat::Compact),
-                                            output,
-                                            QNetworkAccessManager::Operation::PostOperation,
-                                            headers);
-  }
+                                                 headers).first;
 }
 
 void GmailNetworkFactory::onTokensError(const QString& error, const QString& error_description) {
@@ -396,7 +378,7 @@ bool GmailNetworkFactory::obtainAndDecodeFullMessages(const QList<Message>& lite
 
   QList<QPair<QByteArray, QByteArray>> headers;
   QList<HttpResponse> output;
-  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
 
   headers.append(QPair<QByteArray, QByteArray>(QString(HTTP_HEADERS_AUTHORIZATION).toLocal8Bit(),
                                                bearer.toLocal8Bit()));
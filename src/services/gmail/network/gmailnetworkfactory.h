@@ -42,8 +42,10 @@ class GmailNetworkFactory : public QObject {
     Downloader* downloadAttachment(const QString& attachment_id);
 
     QList<Message> messages(const QString& stream_id, Feed::Status& error);
-    void markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async = true);
-    void markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async = true);
+
+    // Marks messages on server and waits for its reply.
+    QNetworkReply::NetworkError markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids);
+    QNetworkReply::NetworkError markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids);
 
   private slots:
     void onTokensError(const QString& error, const QString& error_description);
@@ -17,6 +17,9 @@
 #define INOREADER_MAX_BATCH_SIZE        999
 #define INOREADER_MIN_BATCH_SIZE        20
 
+// Maximal number of messages changed by one "edit-tag" request.
+#define INOREADER_MAX_EDIT_TAG_SIZE     200
+
 #define INOREADER_STATE_READING_LIST    "state/com.google/reading-list"
 #define INOREADER_STATE_READ            "state/com.google/read"
 #define INOREADER_STATE_IMPORTANT       "state/com.google/starred"
@@ -24,6 +24,7 @@
 #include "miscellaneous/iconfactory.h"
 #include "network-web/oauth2service.h"
 #include "services/abstract/recyclebin.h"
+#include "services/inoreader/definitions.h"
 #include "services/inoreader/gui/formeditinoreaderaccount.h"
 #include "services/inoreader/inoreaderentrypoint.h"
 #include "services/inoreader/network/inoreadernetworkfactory.h"
@@ -120,7 +121,7 @@ void InoreaderServiceRoot::start(bool freshly_activated) {
   Q_UNUSED(freshly_activated)
 
   loadFromDatabase();
-  loadCacheFromFile(accountId());
+  loadCacheFromDatabase(accountId());
 
   if (childCount() <= 1) {
     syncIn();
@@ -130,9 +131,7 @@ void InoreaderServiceRoot::start(bool freshly_activated) {
   }
 }
 
-void InoreaderServiceRoot::stop() {
-  saveCacheToFile(accountId());
-}
+void InoreaderServiceRoot::stop() {}
 
 QList<QAction*> InoreaderServiceRoot::serviceMenu() {
   if (m_serviceMenu.isEmpty()) {
@@ -166,40 +165,22 @@ void InoreaderServiceRoot::addNewFeed(const QString& url) {
 
 void InoreaderServiceRoot::addNewCategory() {}
 
-void InoreaderServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
-
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
-
-    if (!ids.isEmpty()) {
-      network()->markMessagesRead(key, ids, async);
-    }
-  }
-
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
-
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
-
-    QList<Message> messages = j.value();
+int InoreaderServiceRoot::cachedStatesBatchSize() const {
+  return INOREADER_MAX_EDIT_TAG_SIZE;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList custom_ids;
+bool InoreaderServiceRoot::sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read) {
+  return network()->markMessagesRead(read, custom_ids) == QNetworkReply::NoError;
+}
 
-      foreach (const Message& msg, messages) {
-        custom_ids.append(msg.m_customId);
-      }
+bool InoreaderServiceRoot::sendImportantStates(const QList<Message>& messages, RootItem::Importance importance) {
+  QStringList custom_ids;
 
-      network()->markMessagesStarred(key, custom_ids, async);
-    }
+  foreach (const Message& msg, messages) {
+    custom_ids.append(msg.m_customId);
   }
+
+  return network()->markMessagesStarred(importance, custom_ids) == QNetworkReply::NoError;
 }
 
 bool InoreaderServiceRoot::canBeDeleted() const {
@@ -51,13 +51,16 @@ class InoreaderServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     RootItem* obtainNewTreeForSyncIn() const;
 
-    void saveAllCachedData(bool async = true);
-
   public slots:
     void addNewFeed(const QString& url);
     void addNewCategory();
     void updateTitle();
 
+  protected:
+    int cachedStatesBatchSize() const;
+    bool sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read);
+    bool sendImportantStates(const QList<Message>& messages, RootItem::Importance importance);
+
   private:
     void loadFromDatabase();
     QList<QAction*> serviceMenu();
@@ -85,7 +85,7 @@ RootItem* InoreaderNetworkFactory::feedsCategories(bool obtain_icons) {
 
   // We need to quit event loop when the download finishes.
   connect(&downloader, &Downloader::completed, &loop, &QEventLoop::quit);
-  downloader.downloadFile(INOREADER_API_LIST_LABELS, qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt());
+  downloader.downloadFile(INOREADER_API_LIST_LABELS, qApp->settings()->snapshot().m_feedUpdateTimeout);
   loop.exec();
 
   if (downloader.lastOutputError() != QNetworkReply::NetworkError::NoError) {
@@ -123,7 +123,7 @@ QList<Message> InoreaderNetworkFactory::messages(const QString& stream_id, Feed:
 
   // We need to quit event loop when the download finishes.
   connect(&downloader, &Downloader::completed, &loop, &QEventLoop::quit);
-  downloader.downloadFile(target_url, qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt());
+  downloader.downloadFile(target_url, qApp->settings()->snapshot().m_feedUpdateTimeout);
   loop.exec();
 
   if (downloader.lastOutputError() != QNetworkReply::NetworkError::NoError) {
@@ -139,7 +139,7 @@ QList<Message> InoreaderNetworkFactory::messages(const QString& stream_id, Feed:
   }
 }
 
-void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids) {
   QString target_url = INOREADER_API_EDIT_TAG;
 
   if (status == RootItem::ReadStatus::Read) {
@@ -152,7 +152,7 @@ void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, cons
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -169,7 +169,7 @@ void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, cons
   }
 
   QStringList working_subset;
-  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
 
   working_subset.reserve(trimmed_ids.size() > 200 ? 200 : trimmed_ids.size());
 
@@ -182,32 +182,27 @@ void InoreaderNetworkFactory::markMessagesRead(RootItem::ReadStatus status, cons
 
     QString batch_final_url = target_url + working_subset.join(QL1C('&'));
 
-    // We send this batch.
-    if (async) {
-
-      NetworkFactory::performAsyncNetworkOperation(batch_final_url,
-                                                   timeout,
-                                                   QByteArray(),
-                                                   QNetworkAccessManager::Operation::GetOperation,
-                                                   headers);
-    }
-    else {
-      QByteArray output;
-
-      NetworkFactory::performNetworkOperation(batch_final_url,
-                                              timeout,
-                                              QByteArray(),
-                                              output,
-                                              QNetworkAccessManager::Operation::GetOperation,
-                                              headers);
+    // We send this batch and wait for server to confirm it.
+    QByteArray output;
+    NetworkResult result = NetworkFactory::performNetworkOperation(batch_final_url,
+                                                                   timeout,
+                                                                   QByteArray(),
+                                                                   output,
+                                                                   QNetworkAccessManager::Operation::GetOperation,
+                                                                   headers);
+
+    if (result.first != QNetworkReply::NoError) {
+      return result.first;
     }
 
     // Cleanup for next batch.
     working_subset.clear();
   }
+
+  return QNetworkReply::NoError;
 }
 
-void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importance, const QStringList& custom_ids) {
   QString target_url = INOREADER_API_EDIT_TAG;
 
   if (importance == RootItem::Importance::Important) {
@@ -220,7 +215,7 @@ void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importanc
   QString bearer = m_oauth2->bearer().toLocal8Bit();
 
   if (bearer.isEmpty()) {
-    return;
+    return QNetworkReply::AuthenticationRequiredError;
   }
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -237,7 +232,7 @@ void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importanc
   }
 
   QStringList working_subset;
-  int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
 
   working_subset.reserve(trimmed_ids.size() > 200 ? 200 : trimmed_ids.size());
 
@@ -250,29 +245,24 @@ void InoreaderNetworkFactory::markMessagesStarred(RootItem::Importance importanc
 
     QString batch_final_url = target_url + working_subset.join(QL1C('&'));
 
-    // We send this batch.
-    if (async) {
-
-      NetworkFactory::performAsyncNetworkOperation(batch_final_url,
-                                                   timeout,
-                                                   QByteArray(),
-                                                   QNetworkAccessManager::Operation::GetOperation,
-                                                   headers);
-    }
-    else {
-      QByteArray output;
-
-      NetworkFactory::performNetworkOperation(batch_final_url,
-                                              timeout,
-                                              QByteArray(),
-                                              output,
-                                              QNetworkAccessManager::Operation::GetOperation,
-                                              headers);
+    // We send this batch and wait for server to confirm it.
+    QByteArray output;
+    NetworkResult result = NetworkFactory::performNetworkOperation(batch_final_url,
+                                                                   timeout,
+                                                                   QByteArray(),
+                                                                   output,
+                                                                   QNetworkAccessManager::Operation::GetOperation,
+                                                                   headers);
+
+    if (result.first != QNetworkReply::NoError) {
+      return result.first;
     }
 
     // Cleanup for next batch.
     working_subset.clear();
   }
+
+  return QNetworkReply::NoError;
 }
 
 void InoreaderNetworkFactory::onTokensError(const QString& error, const QString& error_description) {
@@ -9,4 +9,7 @@
 #define OWNCLOUD_MIN_VERSION          "6.0.5"
 #define OWNCLOUD_UNLIMITED_BATCH_SIZE -1
 
+// Maximal number of messages changed by one request.
+#define OWNCLOUD_MAX_MARK_BATCH_SIZE  500
+
 #endif // OWNCLOUD_DEFINITIONS_H
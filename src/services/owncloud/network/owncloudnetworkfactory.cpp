@@ -89,8 +89,7 @@ OwnCloudUserResponse OwnCloudNetworkFactory::userInfo() {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_urlUser,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QByteArray(), result_raw,
                                                                         QNetworkAccessManager::GetOperation,
                                                                         headers);
@@ -112,8 +111,7 @@ OwnCloudStatusResponse OwnCloudNetworkFactory::status() {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_urlStatus,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QByteArray(), result_raw,
                                                                         QNetworkAccessManager::GetOperation,
                                                                         headers);
@@ -135,8 +133,7 @@ OwnCloudGetFeedsCategoriesResponse OwnCloudNetworkFactory::feedsCategories() {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_urlFolders,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QByteArray(), result_raw,
                                                                         QNetworkAccessManager::GetOperation,
                                                                         headers);
@@ -151,8 +148,7 @@ OwnCloudGetFeedsCategoriesResponse OwnCloudNetworkFactory::feedsCategories() {
 
   // Now, obtain feeds.
   network_reply = NetworkFactory::performNetworkOperation(m_urlFeeds,
-                                                          qApp->settings()->value(GROUP(Feeds),
-                                                                                  SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                          qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                           QByteArray(), result_raw,
                                                           QNetworkAccessManager::GetOperation,
                                                           headers);
@@ -178,8 +174,7 @@ bool OwnCloudNetworkFactory::deleteFeed(const QString& feed_id) {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(final_url,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QByteArray(), raw_output, QNetworkAccessManager::DeleteOperation,
                                                                         headers);
 
@@ -207,8 +202,7 @@ bool OwnCloudNetworkFactory::createFeed(const QString& url, int parent_id) {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_urlFeeds,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                                         result_raw,
                                                                         QNetworkAccessManager::PostOperation,
@@ -238,7 +232,7 @@ bool OwnCloudNetworkFactory::renameFeed(const QString& new_name, const QString&
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(
     final_url,
-    qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt(),
+    qApp->settings()->snapshot().m_feedUpdateTimeout,
     QJsonDocument(json).toJson(QJsonDocument::Compact),
     result_raw,
     QNetworkAccessManager::PutOperation,
@@ -270,8 +264,7 @@ OwnCloudGetMessagesResponse OwnCloudNetworkFactory::getMessages(int feed_id) {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(final_url,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QByteArray(), result_raw,
                                                                         QNetworkAccessManager::GetOperation,
                                                                         headers);
@@ -308,8 +301,7 @@ QNetworkReply::NetworkError OwnCloudNetworkFactory::triggerFeedUpdate(int feed_i
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_urlFeedsUpdate.arg(userId(),
                                                                                              QString::number(feed_id)),
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QByteArray(), raw_output,
                                                                         QNetworkAccessManager::GetOperation,
                                                                         headers);
@@ -321,7 +313,7 @@ QNetworkReply::NetworkError OwnCloudNetworkFactory::triggerFeedUpdate(int feed_i
   return (m_lastError = network_reply.first);
 }
 
-void OwnCloudNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async) {
+QNetworkReply::NetworkError OwnCloudNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids) {
   QJsonObject json;
   QJsonArray ids;
   QString final_url;
@@ -343,30 +335,24 @@ void OwnCloudNetworkFactory::markMessagesRead(RootItem::ReadStatus status, const
   headers << QPair<QByteArray, QByteArray>(HTTP_HEADERS_CONTENT_TYPE, OWNCLOUD_CONTENT_TYPE_JSON);
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(final_url,
-                                                 qApp->settings()->value(GROUP(Feeds),
-                                                                         SETTING(Feeds::UpdateTimeout)).toInt(),
-                                                 QJsonDocument(json).toJson(QJsonDocument::Compact),
-                                                 QNetworkAccessManager::PutOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
+  QByteArray output;
+  NetworkResult network_reply = NetworkFactory::performNetworkOperation(final_url,
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
+                                                                        QJsonDocument(json).toJson(QJsonDocument::Compact),
+                                                                        output,
+                                                                        QNetworkAccessManager::PutOperation,
+                                                                        headers);
 
-    NetworkFactory::performNetworkOperation(final_url,
-                                            qApp->settings()->value(GROUP(Feeds),
-                                                                    SETTING(Feeds::UpdateTimeout)).toInt(),
-                                            QJsonDocument(json).toJson(QJsonDocument::Compact),
-                                            output,
-                                            QNetworkAccessManager::PutOperation,
-                                            headers);
+  if (network_reply.first != QNetworkReply::NoError) {
+    qWarning("ownCloud: Marking messages failed with error %d.", network_reply.first);
   }
+
+  return network_reply.first;
 }
 
-void OwnCloudNetworkFactory::markMessagesStarred(RootItem::Importance importance,
-                                                 const QStringList& feed_ids,
-                                                 const QStringList& guid_hashes, bool async) {
+QNetworkReply::NetworkError OwnCloudNetworkFactory::markMessagesStarred(RootItem::Importance importance,
+                                                                        const QStringList& feed_ids,
+                                                                        const QStringList& guid_hashes) {
   QJsonObject json;
   QJsonArray ids;
   QString final_url;
@@ -392,25 +378,19 @@ void OwnCloudNetworkFactory::markMessagesStarred(RootItem::Importance importance
   headers << QPair<QByteArray, QByteArray>(HTTP_HEADERS_CONTENT_TYPE, OWNCLOUD_CONTENT_TYPE_JSON);
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
-  if (async) {
-    NetworkFactory::performAsyncNetworkOperation(final_url,
-                                                 qApp->settings()->value(GROUP(Feeds),
-                                                                         SETTING(Feeds::UpdateTimeout)).toInt(),
-                                                 QJsonDocument(json).toJson(QJsonDocument::Compact),
-                                                 QNetworkAccessManager::PutOperation,
-                                                 headers);
-  }
-  else {
-    QByteArray output;
+  QByteArray output;
+  NetworkResult network_reply = NetworkFactory::performNetworkOperation(final_url,
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
+                                                                        QJsonDocument(json).toJson(QJsonDocument::Compact),
+                                                                        output,
+                                                                        QNetworkAccessManager::PutOperation,
+                                                                        headers);
 
-    NetworkFactory::performNetworkOperation(final_url,
-                                            qApp->settings()->value(GROUP(Feeds),
-                                                                    SETTING(Feeds::UpdateTimeout)).toInt(),
-                                            QJsonDocument(json).toJson(QJsonDocument::Compact),
-                                            output,
-                                            QNetworkAccessManager::PutOperation,
-                                            headers);
+  if (network_reply.first != QNetworkReply::NoError) {
+    qWarning("ownCloud: Marking messages failed with error %d.", network_reply.first);
   }
+
+  return network_reply.first;
 }
 
 int OwnCloudNetworkFactory::batchSize() const {
@@ -113,9 +113,9 @@ class OwnCloudNetworkFactory {
 
     // Misc methods.
     QNetworkReply::NetworkError triggerFeedUpdate(int feed_id);
-    void markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids, bool async = true);
-    void markMessagesStarred(RootItem::Importance importance, const QStringList& feed_ids,
-                             const QStringList& guid_hashes, bool async = true);
+    QNetworkReply::NetworkError markMessagesRead(RootItem::ReadStatus status, const QStringList& custom_ids);
+    QNetworkReply::NetworkError markMessagesStarred(RootItem::Importance importance, const QStringList& feed_ids,
+                                                    const QStringList& guid_hashes);
 
     // Gets/sets the amount of messages to obtain during single feed update.
     int batchSize() const;
@@ -9,6 +9,7 @@
 #include "miscellaneous/mutex.h"
 #include "miscellaneous/textfactory.h"
 #include "services/abstract/recyclebin.h"
+#include "services/owncloud/definitions.h"
 #include "services/owncloud/gui/formeditowncloudaccount.h"
 #include "services/owncloud/gui/formowncloudfeeddetails.h"
 #include "services/owncloud/network/owncloudnetworkfactory.h"
@@ -71,16 +72,14 @@ QList<QAction*> OwnCloudServiceRoot::serviceMenu() {
 void OwnCloudServiceRoot::start(bool freshly_activated) {
   Q_UNUSED(freshly_activated)
   loadFromDatabase();
-  loadCacheFromFile(accountId());
+  loadCacheFromDatabase(accountId());
 
   if (childCount() <= 1) {
     syncIn();
   }
 }
 
-void OwnCloudServiceRoot::stop() {
-  saveCacheToFile(accountId());
-}
+void OwnCloudServiceRoot::stop() {}
 
 QString OwnCloudServiceRoot::code() const {
   return OwnCloudServiceEntryPoint().code();
@@ -90,41 +89,23 @@ OwnCloudNetworkFactory* OwnCloudServiceRoot::network() const {
   return m_network;
 }
 
-void OwnCloudServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
-
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
-
-    if (!ids.isEmpty()) {
-      network()->markMessagesRead(key, ids, async);
-    }
-  }
-
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
-
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
-
-    QList<Message> messages = j.value();
+int OwnCloudServiceRoot::cachedStatesBatchSize() const {
+  return OWNCLOUD_MAX_MARK_BATCH_SIZE;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList feed_ids, guid_hashes;
+bool OwnCloudServiceRoot::sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read) {
+  return network()->markMessagesRead(read, custom_ids) == QNetworkReply::NoError;
+}
 
-      foreach (const Message& msg, messages) {
-        feed_ids.append(msg.m_feedId);
-        guid_hashes.append(msg.m_customHash);
-      }
+bool OwnCloudServiceRoot::sendImportantStates(const QList<Message>& messages, RootItem::Importance importance) {
+  QStringList feed_ids, guid_hashes;
 
-      network()->markMessagesStarred(key, feed_ids, guid_hashes, async);
-    }
+  foreach (const Message& msg, messages) {
+    feed_ids.append(msg.m_feedId);
+    guid_hashes.append(msg.m_customHash);
   }
+
+  return network()->markMessagesStarred(importance, feed_ids, guid_hashes) == QNetworkReply::NoError;
 }
 
 void OwnCloudServiceRoot::updateTitle() {
@@ -34,12 +34,15 @@ class OwnCloudServiceRoot : public ServiceRoot, public CacheForServiceRoot {
     void updateTitle();
     void saveAccountDataToDatabase();
 
-    void saveAllCachedData(bool async = true);
-
   public slots:
     void addNewFeed(const QString& url);
     void addNewCategory();
 
+  protected:
+    int cachedStatesBatchSize() const;
+    bool sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read);
+    bool sendImportantStates(const QList<Message>& messages, RootItem::Importance importance);
+
   private:
     RootItem* obtainNewTreeForSyncIn() const;
 
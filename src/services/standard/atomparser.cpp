@@ -8,7 +8,7 @@
 
 #include "exceptions/applicationexception.h"
 
-AtomParser::AtomParser(const QString& data) : FeedParser(data) {
+AtomParser::AtomParser(const QByteArray& data) : FeedParser(data) {
   QString version = m_xml.documentElement().attribute(QSL("version"));
 
   if (version == QSL("0.3")) {
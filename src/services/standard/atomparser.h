@@ -12,7 +12,7 @@
 
 class AtomParser : public FeedParser {
   public:
-    explicit AtomParser(const QString& data);
+    explicit AtomParser(const QByteArray& data);
     virtual ~AtomParser();
 
   private:
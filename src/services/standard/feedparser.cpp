@@ -5,10 +5,9 @@
 #include "exceptions/applicationexception.h"
 
 #include <QDebug>
-#include <QRegularExpression>
 
-FeedParser::FeedParser(const QString& data) : m_xmlData(data) {
-  m_xml.setContent(m_xmlData, true);
+FeedParser::FeedParser(const QByteArray& data) {
+  m_xml.setContent(data, true);
 }
 
 FeedParser::~FeedParser() {}
@@ -32,7 +31,7 @@ QList<Message> FeedParser::messages() {
         new_message.m_author = feed_author;
       }
 
-      new_message.m_url = new_message.m_url.replace(QRegularExpression("[\\t\\n]"), QString());
+      new_message.m_url = new_message.m_url.remove(QL1C('\t')).remove(QL1C('\n'));
 
       messages.append(new_message);
     }
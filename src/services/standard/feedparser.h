@@ -10,7 +10,7 @@
 
 class FeedParser {
   public:
-    explicit FeedParser(const QString& data);
+    explicit FeedParser(const QByteArray& data);
     virtual ~FeedParser();
 
     virtual QList<Message> messages();
@@ -22,7 +22,6 @@ class FeedParser {
     virtual Message extractMessage(const QDomElement& msg_element, QDateTime current_time) const = 0;
 
   protected:
-    QString m_xmlData;
     QDomDocument m_xml;
 };
 
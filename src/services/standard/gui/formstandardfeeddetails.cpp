@@ -34,6 +34,7 @@ void FormStandardFeedDetails::apply() {
     // Add the feed.
     if (new_feed->addItself(parent)) {
       m_serviceRoot->requestItemReassignment(new_feed, parent);
+      saveEnclosurePolicy(new_feed);
       accept();
     }
     else {
@@ -51,6 +52,7 @@ void FormStandardFeedDetails::apply() {
 
     if (edited) {
       m_serviceRoot->requestItemReassignment(m_editableFeed, new_feed->parent());
+      saveEnclosurePolicy(m_editableFeed);
       accept();
     }
     else {
@@ -12,7 +12,7 @@ RdfParser::RdfParser() {}
 
 RdfParser::~RdfParser() {}
 
-QList<Message> RdfParser::parseXmlData(const QString& data) {
+QList<Message> RdfParser::parseXmlData(const QByteArray& data) {
   QList<Message> messages;
   QDomDocument xml_file;
   QDateTime current_time = QDateTime::currentDateTime();
@@ -12,7 +12,7 @@ class RdfParser {
     explicit RdfParser();
     virtual ~RdfParser();
 
-    QList<Message> parseXmlData(const QString& data);
+    QList<Message> parseXmlData(const QByteArray& data);
 };
 
 #endif // RDFPARSER_H
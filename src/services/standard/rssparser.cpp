@@ -10,7 +10,7 @@
 
 #include <QDomDocument>
 
-RssParser::RssParser(const QString& data) : FeedParser(data) {}
+RssParser::RssParser(const QByteArray& data) : FeedParser(data) {}
 
 RssParser::~RssParser() {}
 
@@ -11,7 +11,7 @@
 
 class RssParser : public FeedParser {
   public:
-    explicit RssParser(const QString& data);
+    explicit RssParser(const QByteArray& data);
     virtual ~RssParser();
 
   private:
@@ -145,8 +145,7 @@ QPair<StandardFeed*, QNetworkReply::NetworkError> StandardFeed::guessFeed(const
   headers << NetworkFactory::generateBasicAuthHeader(username, password);
 
   NetworkResult network_result = NetworkFactory::performNetworkOperation(url,
-                                                                         qApp->settings()->value(GROUP(Feeds),
-                                                                                                 SETTING(Feeds::UpdateTimeout)).toInt(),
+                                                                         qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                          QByteArray(),
                                                                          feed_contents,
                                                                          QNetworkAccessManager::GetOperation,
@@ -157,18 +156,7 @@ QPair<StandardFeed*, QNetworkReply::NetworkError> StandardFeed::guessFeed(const
   if (result.second == QNetworkReply::NoError || !feed_contents.isEmpty()) {
     // Feed XML was obtained, now we need to try to guess
     // its encoding before we can read further data.
-    QString xml_schema_encoding;
-    QString xml_contents_encoded;
-    QRegExp encoding_rexp(QSL("encoding=\"[^\"]\\S+\""));
-
-    if (encoding_rexp.indexIn(feed_contents) != -1 &&
-        !(xml_schema_encoding = encoding_rexp.cap(0)).isEmpty()) {
-      // Some "encoding" attribute was found get the encoding
-      // out of it.
-      encoding_rexp.setPattern(QSL("[^\"]\\S+[^\"]"));
-      encoding_rexp.indexIn(xml_schema_encoding, 9);
-      xml_schema_encoding = encoding_rexp.cap(0);
-    }
+    const QString xml_schema_encoding = detectEncoding(feed_contents, network_result.second.toString());
 
     if (result.first == nullptr) {
       result.first = new StandardFeed();
@@ -178,13 +166,12 @@ QPair<StandardFeed*, QNetworkReply::NetworkError> StandardFeed::guessFeed(const
 
     if (custom_codec != nullptr) {
       // Feed encoding was probably guessed.
-      xml_contents_encoded = custom_codec->toUnicode(feed_contents);
       result.first->setEncoding(xml_schema_encoding);
     }
     else {
       // Feed encoding probably not guessed, set it as
       // default.
-      xml_contents_encoded = feed_contents;
+      custom_codec = QTextCodec::codecForName(DEFAULT_FEED_ENCODING);
       result.first->setEncoding(DEFAULT_FEED_ENCODING);
     }
 
@@ -193,7 +180,7 @@ QPair<StandardFeed*, QNetworkReply::NetworkError> StandardFeed::guessFeed(const
     QString error_msg;
     int error_line, error_column;
 
-    if (!xml_document.setContent(xml_contents_encoded,
+    if (!xml_document.setContent(prepareFeedContents(feed_contents, custom_codec),
                                  &error_msg,
                                  &error_line,
                                  &error_column)) {
@@ -400,7 +387,7 @@ void StandardFeed::setEncoding(const QString& encoding) {
 
 QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
   QByteArray feed_contents;
-  int download_timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  int download_timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
 
   QList<QPair<QByteArray, QByteArray>> headers;
   headers << NetworkFactory::generateBasicAuthHeader(username(), password());
@@ -422,19 +409,20 @@ QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
     *error_during_obtaining = false;
   }
 
-  // Encode downloaded data for further parsing.
+  // Make sure that downloaded data are in encoding which XML parser can read directly.
   QTextCodec* codec = QTextCodec::codecForName(encoding().toLocal8Bit());
-  QString formatted_feed_contents;
 
   if (codec == nullptr) {
     // No suitable codec for this encoding was found.
     // Use non-converted data.
-    formatted_feed_contents = feed_contents;
-  }
-  else {
-    formatted_feed_contents = codec->toUnicode(feed_contents);
+    codec = QTextCodec::codecForName(DEFAULT_FEED_ENCODING);
   }
 
+  const QByteArray formatted_feed_contents = prepareFeedContents(feed_contents, codec);
+
+  // We do not need original data anymore.
+  feed_contents.clear();
+
   // Feed data are downloaded and encoded.
   // Parse data and obtain messages.
   QList<Message> messages;
@@ -459,6 +447,104 @@ QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
   return messages;
 }
 
+QString StandardFeed::detectEncoding(const QByteArray& data, const QString& content_type) {
+  // Byte order mark has the highest priority.
+  if (data.startsWith("\xEF\xBB\xBF")) {
+    return QSL("UTF-8");
+  }
+  else if (data.startsWith("\xFF\xFE")) {
+    return QSL("UTF-16LE");
+  }
+  else if (data.startsWith("\xFE\xFF")) {
+    return QSL("UTF-16BE");
+  }
+
+  // Then comes "encoding" attribute of XML declaration. The declaration
+  // must be placed at the very beginning of the document, so we do not
+  // need to scan the whole document.
+  if (data.startsWith("<?xml")) {
+    const int declaration_end = data.indexOf("?>");
+    int position = data.indexOf("encoding", 5);
+
+    if (position > 0 && (declaration_end < 0 || position < declaration_end)) {
+      position += 8;
+
+      while (position < data.size() && (data.at(position) == ' ' || data.at(position) == '=')) {
+        position++;
+      }
+
+      if (position < data.size() && (data.at(position) == '"' || data.at(position) == '\'')) {
+        const int value_end = data.indexOf(data.at(position), position + 1);
+
+        if (value_end > position + 1) {
+          return QString::fromLatin1(data.constData() + position + 1, value_end - position - 1);
+        }
+      }
+    }
+  }
+
+  // Lastly, check "charset" parameter of HTTP "Content-Type" header.
+  const int charset_index = content_type.indexOf(QL1S("charset="), 0, Qt::CaseInsensitive);
+
+  if (charset_index >= 0) {
+    QString charset = content_type.mid(charset_index + 8).section(QL1C(';'), 0, 0).trimmed();
+
+    charset.remove(QL1C('"'));
+    charset.remove(QL1C('\''));
+    return charset;
+  }
+
+  return QString();
+}
+
+QByteArray StandardFeed::prepareFeedContents(const QByteArray& data, QTextCodec* codec) {
+  // XML parser decodes data itself, it uses byte order mark or
+  // XML declaration and falls back to UTF-8.
+  QTextCodec* document_codec = QTextCodec::codecForName(detectEncoding(data).toLocal8Bit());
+
+  if (document_codec == nullptr) {
+    document_codec = QTextCodec::codecForName(DEFAULT_FEED_ENCODING);
+  }
+
+  if (document_codec == codec) {
+    // Parser will decode data correctly, no need to transcode them.
+    return data;
+  }
+
+  // Selected encoding differs from what the document says about itself,
+  // transcode data to UTF-8 chunk by chunk so that we never hold
+  // whole document in UTF-16 form.
+  const int chunk_size = FEED_TRANSCODING_CHUNK_SIZE;
+  QScopedPointer<QTextDecoder> decoder(codec->makeDecoder());
+  QByteArray output;
+
+  output.reserve(data.size());
+
+  for (int offset = 0; offset < data.size(); offset += chunk_size) {
+    QString chunk = decoder->toUnicode(data.constData() + offset, qMin(chunk_size, data.size() - offset));
+
+    if (offset == 0) {
+      // Original XML declaration does not describe transcoded data,
+      // drop it along with possible byte order mark.
+      if (chunk.startsWith(QChar(QChar::ByteOrderMark))) {
+        chunk.remove(0, 1);
+      }
+
+      if (chunk.startsWith(QL1S("<?xml"))) {
+        const int declaration_end = chunk.indexOf(QL1S("?>"));
+
+        if (declaration_end > 0) {
+          chunk.remove(0, declaration_end + 2);
+        }
+      }
+    }
+
+    output.append(chunk.toUtf8());
+  }
+
+  return output;
+}
+
 QNetworkReply::NetworkError StandardFeed::networkError() const {
   return m_networkError;
 }
@@ -13,6 +13,7 @@
 #include <QSqlRecord>
 
 class StandardServiceRoot;
+class QTextCodec;
 
 // Represents BASE class for feeds contained in FeedsModel.
 // NOTE: This class should be derived to create PARTICULAR feed types.
@@ -85,6 +86,16 @@ class StandardFeed : public Feed {
   private:
     QList<Message> obtainNewMessages(bool* error_during_obtaining);
 
+    // Sniffs encoding of feed data from byte order mark, XML declaration
+    // or "charset" parameter of HTTP content type, in that order.
+    // Returns empty string if encoding cannot be determined.
+    static QString detectEncoding(const QByteArray& data, const QString& content_type = QString());
+
+    // Returns feed data which can be handed directly to XML parser.
+    // Data are returned untouched if parser would decode them correctly
+    // on its own, otherwise they are transcoded from given codec to UTF-8.
+    static QByteArray prepareFeedContents(const QByteArray& data, QTextCodec* codec);
+
   private:
     bool m_passwordProtected;
     QString m_username;
@@ -15,6 +15,7 @@
 
 // Limitations
 #define TTRSS_MAX_MESSAGES      200
+#define TTRSS_MAX_UPDATED_IDS   500
 
 // General return status codes.
 #define TTRSS_API_STATUS_OK     0
@@ -20,6 +20,7 @@ FormTtRssFeedDetails::FormTtRssFeedDetails(ServiceRoot* service_root, QWidget* p
   m_ui->m_btnIcon->setEnabled(false);
   m_ui->m_txtTitle->setEnabled(false);
   m_ui->m_txtDescription->setEnabled(false);
+  m_ui->m_gbPrefetchEnclosures->setEnabled(false);
 }
 
 void FormTtRssFeedDetails::apply() {
@@ -32,6 +33,7 @@ void FormTtRssFeedDetails::apply() {
     new_feed_data->setAutoUpdateInitialInterval(m_ui->m_spinAutoUpdateInterval->value());
     qobject_cast<TtRssFeed*>(m_editableFeed)->editItself(new_feed_data);
     delete new_feed_data;
+    saveEnclosurePolicy(m_editableFeed);
   }
   else {
     RootItem* parent = static_cast<RootItem*>(m_ui->m_cmbParentCategory->itemData(
@@ -65,6 +67,7 @@ void FormTtRssFeedDetails::apply() {
 
 void FormTtRssFeedDetails::setEditableFeed(Feed* editable_feed) {
   m_ui->m_cmbAutoUpdateType->setEnabled(true);
+  m_ui->m_gbPrefetchEnclosures->setEnabled(true);
   FormFeedDetails::setEditableFeed(editable_feed);
 
   // Tiny Tiny RSS does not support editing of these features.
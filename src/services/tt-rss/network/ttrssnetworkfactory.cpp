@@ -87,9 +87,7 @@ TtRssLoginResponse TtRssNetworkFactory::login() {
   headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
   NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_fullUrl,
-                                                                        qApp->settings()->value(GROUP(Feeds),
-                                                                                                SETTING(
-                                                                                                  Feeds::UpdateTimeout)).toInt(),
+                                                                        qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                         QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                                         result_raw,
                                                                         QNetworkAccessManager::PostOperation,
@@ -121,9 +119,7 @@ TtRssResponse TtRssNetworkFactory::logout() {
     headers << NetworkFactory::generateBasicAuthHeader(m_authUsername, m_authPassword);
 
     NetworkResult network_reply = NetworkFactory::performNetworkOperation(m_fullUrl,
-                                                                          qApp->settings()->value(GROUP(Feeds),
-                                                                                                  SETTING(
-                                                                                                    Feeds::UpdateTimeout)).toInt(),
+                                                                          qApp->settings()->snapshot().m_feedUpdateTimeout,
                                                                           QJsonDocument(json).toJson(QJsonDocument::Compact),
                                                                           result_raw,
                                                                           QNetworkAccessManager::PostOperation,
@@ -153,7 +149,7 @@ TtRssGetFeedsCategoriesResponse TtRssNetworkFactory::getFeedsCategories() {
   json["op"] = QSL("getFeedTree");
   json["sid"] = m_sessionId;
   json["include_empty"] = true;
-  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  const int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QByteArray result_raw;
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -200,7 +196,7 @@ TtRssGetHeadlinesResponse TtRssNetworkFactory::getHeadlines(int feed_id, int lim
   json["show_content"] = show_content;
   json["include_attachments"] = include_attachments;
   json["sanitize"] = sanitize;
-  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  const int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QByteArray result_raw;
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -237,9 +233,7 @@ TtRssGetHeadlinesResponse TtRssNetworkFactory::getHeadlines(int feed_id, int lim
 
 TtRssUpdateArticleResponse TtRssNetworkFactory::updateArticles(const QStringList& ids,
                                                                UpdateArticle::OperatingField field,
-                                                               UpdateArticle::Mode mode, bool async) {
-  Q_UNUSED(async)
-
+                                                               UpdateArticle::Mode mode) {
   QJsonObject json;
 
   json["op"] = QSL("updateArticle");
@@ -247,7 +241,7 @@ TtRssUpdateArticleResponse TtRssNetworkFactory::updateArticles(const QStringList
   json["article_ids"] = ids.join(QSL(","));
   json["mode"] = (int) mode;
   json["field"] = (int) field;
-  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  const int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QByteArray result_raw;
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -295,7 +289,7 @@ TtRssSubscribeToFeedResponse TtRssNetworkFactory::subscribeToFeed(const QString&
     json["password"] = password;
   }
 
-  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  const int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QByteArray result_raw;
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -334,7 +328,7 @@ TtRssUnsubscribeFeedResponse TtRssNetworkFactory::unsubscribeFeed(int feed_id) {
   json["op"] = QSL("unsubscribeFeed");
   json["sid"] = m_sessionId;
   json["feed_id"] = feed_id;
-  const int timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  const int timeout = qApp->settings()->snapshot().m_feedUpdateTimeout;
   QByteArray result_raw;
 
   QList<QPair<QByteArray, QByteArray>> headers;
@@ -144,7 +144,7 @@ class TtRssNetworkFactory {
                                            bool sanitize);
 
     TtRssUpdateArticleResponse updateArticles(const QStringList& ids, UpdateArticle::OperatingField field,
-                                              UpdateArticle::Mode mode, bool async = true);
+                                              UpdateArticle::Mode mode);
 
     TtRssSubscribeToFeedResponse subscribeToFeed(const QString& url, int category_id, bool protectd = false,
                                                  const QString& username = QString(), const QString& password = QString());
@@ -34,7 +34,7 @@ TtRssServiceRoot::~TtRssServiceRoot() {
 void TtRssServiceRoot::start(bool freshly_activated) {
   Q_UNUSED(freshly_activated)
   loadFromDatabase();
-  loadCacheFromFile(accountId());
+  loadCacheFromDatabase(accountId());
 
   if (qApp->isFirstRun(QSL("3.1.1")) || (childCount() == 1 && child(0)->kind() == RootItemKind::Bin)) {
     syncIn();
@@ -42,8 +42,6 @@ void TtRssServiceRoot::start(bool freshly_activated) {
 }
 
 void TtRssServiceRoot::stop() {
-  saveCacheToFile(accountId());
-
   m_network->logout();
   qDebug("Stopping Tiny Tiny RSS account, logging out with result '%d'.", (int) m_network->lastError());
 }
@@ -109,42 +107,24 @@ bool TtRssServiceRoot::canBeDeleted() const {
   return true;
 }
 
-void TtRssServiceRoot::saveAllCachedData(bool async) {
-  QPair<QMap<RootItem::ReadStatus, QStringList>, QMap<RootItem::Importance, QList<Message>>> msgCache = takeMessageCache();
-  QMapIterator<RootItem::ReadStatus, QStringList> i(msgCache.first);
-
-  // Save the actual data read/unread.
-  while (i.hasNext()) {
-    i.next();
-    auto key = i.key();
-    QStringList ids = i.value();
-
-    if (!ids.isEmpty()) {
-      network()->updateArticles(ids,
-                                UpdateArticle::Unread,
-                                key == RootItem::Unread ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse,
-                                async);
-    }
-  }
-
-  QMapIterator<RootItem::Importance, QList<Message>> j(msgCache.second);
+int TtRssServiceRoot::cachedStatesBatchSize() const {
+  return TTRSS_MAX_UPDATED_IDS;
+}
 
-  // Save the actual data important/not important.
-  while (j.hasNext()) {
-    j.next();
-    auto key = j.key();
+bool TtRssServiceRoot::sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read) {
+  TtRssUpdateArticleResponse response = network()->updateArticles(custom_ids,
+                                                                  UpdateArticle::Unread,
+                                                                  read == RootItem::Unread ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse);
 
-    QList<Message> messages = j.value();
+  return network()->lastError() == QNetworkReply::NoError && response.status() == TTRSS_API_STATUS_OK;
+}
 
-    if (!messages.isEmpty()) {
-      QStringList ids = customIDsOfMessages(messages);
+bool TtRssServiceRoot::sendImportantStates(const QList<Message>& messages, RootItem::Importance importance) {
+  TtRssUpdateArticleResponse response = network()->updateArticles(customIDsOfMessages(messages),
+                                                                  UpdateArticle::Starred,
+                                                                  importance == RootItem::Important ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse);
 
-      network()->updateArticles(ids,
-                                UpdateArticle::Starred,
-                                key == RootItem::Important ? UpdateArticle::SetToTrue : UpdateArticle::SetToFalse,
-                                async);
-    }
-  }
+  return network()->lastError() == QNetworkReply::NoError && response.status() == TTRSS_API_STATUS_OK;
 }
 
 QList<QAction*> TtRssServiceRoot::serviceMenu() {
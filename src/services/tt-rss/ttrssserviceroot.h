@@ -32,8 +32,6 @@ class TtRssServiceRoot : public ServiceRoot, public CacheForServiceRoot {
 
     QString additionalTooltip() const;
 
-    void saveAllCachedData(bool async = true);
-
     // Access to network.
     TtRssNetworkFactory* network() const;
 
@@ -44,6 +42,11 @@ class TtRssServiceRoot : public ServiceRoot, public CacheForServiceRoot {
     void addNewFeed(const QString& url = QString());
     void addNewCategory();
 
+  protected:
+    int cachedStatesBatchSize() const;
+    bool sendReadStates(const QStringList& custom_ids, RootItem::ReadStatus read);
+    bool sendImportantStates(const QList<Message>& messages, RootItem::Importance importance);
+
   private:
     RootItem* obtainNewTreeForSyncIn() const;
 